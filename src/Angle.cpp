@@ -1,6 +1,9 @@
 #include "Angle.hpp"
 #include <boost/format.hpp>
 #include <base/Eigen.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
 
 namespace base {
 
@@ -22,6 +25,149 @@ Angle Angle::vectorToVector(const Vector3d& a, const Vector3d& b, const Vector3d
         return fromRad(-acos(cos));
 }
 
+namespace
+{
+    // Angle only holds its value in radians, so arrays of angles can be
+    // mapped as arrays of doubles
+    static_assert(sizeof(Angle) == sizeof(double), "Angle must only hold its value");
+
+    /** Branch-free normalization of a value to ]-PI, PI]
+     *
+     * The count of turns is rounded to nearest by adding and removing 1.5 *
+     * 2^52, which only relies on the IEEE rounding mode. PI is kept as-is,
+     * and -PI gives PI as in Angle::canonize. The conditionals compile to
+     * selects, so that loops over this function are vectorized.
+     */
+    inline double wrap(double rad)
+    {
+        const double two_pi = 2 * M_PI;
+        const double round_magic = 6755399441055744.0;
+        const double turns = (rad * (1 / two_pi) + round_magic) - round_magic;
+        double result = rad - turns * two_pi;
+        result = result <= -M_PI ? result + two_pi : result;
+        result = result > M_PI ? result - two_pi : result;
+        return result;
+    }
+
+    /** Magnitude above which wrap() loses precision against
+     * Angle::canonize, as the turn count gets large (and overflows the
+     * rounding trick above 2^51 turns). Larger values go through the scalar
+     * path
+     */
+    const double wrap_limit = 1e6;
+
+    /** The arrays are processed in blocks, each of which is only
+     * vectorized if all its values are within wrap_limit */
+    const size_t wrap_block = 64;
+
+    void normalize(const double* rad, double* result, size_t count)
+    {
+        for (size_t first = 0; first < count; first += wrap_block)
+        {
+            const size_t end = std::min(count, first + wrap_block);
+            bool in_range = true;
+            for (size_t i = first; i < end; ++i)
+                in_range &= std::abs(rad[i]) <= wrap_limit;
+
+            if (in_range)
+            {
+                for (size_t i = first; i < end; ++i)
+                    result[i] = wrap(rad[i]);
+            }
+            else
+            {
+                // canonize gives -PI when the fractional turn of huge values
+                // is lost, which is the same angle as PI
+                for (size_t i = first; i < end; ++i)
+                {
+                    const double normalized = Angle::normalizeRad(rad[i]);
+                    result[i] = normalized <= -M_PI ? M_PI : normalized;
+                }
+            }
+        }
+    }
+
+    void difference(const double* a, const double* b, double* result, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            result[i] = a[i] - b[i];
+        normalize(result, result, count);
+    }
+}
+
+void Angle::normalizeRad(Eigen::Ref<Eigen::ArrayXd> rad)
+{
+    normalize(rad.data(), rad.data(), rad.size());
+}
+
+void Angle::normalizeRad(std::vector<double>& rad)
+{
+    if (!rad.empty())
+        normalize(&rad.front(), &rad.front(), rad.size());
+}
+
+std::vector<Angle> Angle::fromRad(std::vector<double> const& rad)
+{
+    std::vector<Angle> result(rad.size());
+    if (!rad.empty())
+        normalize(&rad.front(), &result.front().rad, rad.size());
+    return result;
+}
+
+void Angle::difference(Eigen::Ref<const Eigen::ArrayXd> const& a,
+        Eigen::Ref<const Eigen::ArrayXd> const& b,
+        Eigen::Ref<Eigen::ArrayXd> result)
+{
+    if (a.size() != b.size() || a.size() != result.size())
+        throw std::invalid_argument("Angle::difference: arrays have different sizes");
+    base::difference(a.data(), b.data(), result.data(), a.size());
+}
+
+std::vector<Angle> Angle::difference(std::vector<Angle> const& a, std::vector<Angle> const& b)
+{
+    if (a.size() != b.size())
+        throw std::invalid_argument("Angle::difference: arrays have different sizes");
+    std::vector<Angle> result(a.size());
+    if (!a.empty())
+        base::difference(&a.front().rad, &b.front().rad, &result.front().rad, a.size());
+    return result;
+}
+
+Angle Angle::mean(Eigen::Ref<const Eigen::ArrayXd> const& rad)
+{
+    const double s = rad.sin().sum();
+    const double c = rad.cos().sum();
+    if (s == 0 && c == 0)
+        return Angle::unknown();
+    return Angle::fromRad(atan2(s, c));
+}
+
+Angle Angle::mean(std::vector<Angle> const& angles)
+{
+    if (angles.empty())
+        return Angle::unknown();
+    return mean(Eigen::Map<const Eigen::ArrayXd>(&angles.front().rad, angles.size()));
+}
+
+void Angle::unwrap(Eigen::Ref<Eigen::ArrayXd> rad)
+{
+    const Eigen::Index n = rad.size();
+    if (n < 2)
+        return;
+
+    // normalize all the steps at once, then integrate them
+    Eigen::ArrayXd steps(n - 1);
+    base::difference(rad.data() + 1, rad.data(), steps.data(), n - 1);
+    for (Eigen::Index i = 1; i < n; ++i)
+        rad[i] = rad[i - 1] + steps[i - 1];
+}
+
+void Angle::unwrap(std::vector<double>& rad)
+{
+    if (!rad.empty())
+        unwrap(Eigen::Map<Eigen::ArrayXd>(&rad.front(), rad.size()));
+}
+
 std::ostream& operator << (std::ostream& os, Angle angle)
 {
     os << angle.getRad() << boost::format("[%3.1fdeg]") % angle.getDeg();
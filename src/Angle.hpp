@@ -77,6 +77,56 @@ public:
         return Angle(rad).rad;
     }
 
+    /** Normalizes an array of angular values in place
+     *
+     * Same interval than normalizeRad (-PI excluded, PI included), but the
+     * computation is free of branches so that it is vectorized. Blocks that
+     * contain values beyond 1e6 rad fall back to the scalar normalization,
+     * to keep its precision.
+     */
+    static void normalizeRad( Eigen::Ref<Eigen::ArrayXd> rad );
+
+    /** @overload */
+    static void normalizeRad( std::vector<double>& rad );
+
+    /** Converts an array of angles in radians into Angle objects */
+    static std::vector<Angle> fromRad( std::vector<double> const& rad );
+
+    /** Computes the normalized differences a - b of two arrays of angles
+     *
+     * @param result the differences. It can be the same array than @a a or
+     *   @a b.
+     * @throw std::invalid_argument if the arrays have different sizes
+     */
+    static void difference( Eigen::Ref<const Eigen::ArrayXd> const& a,
+            Eigen::Ref<const Eigen::ArrayXd> const& b,
+            Eigen::Ref<Eigen::ArrayXd> result );
+
+    /** @overload */
+    static std::vector<Angle> difference( std::vector<Angle> const& a,
+            std::vector<Angle> const& b );
+
+    /** Computes the circular mean of a set of angles
+     *
+     * This is the direction of the sum of the unit vectors of the angles.
+     * Unknown if the set is empty or if this sum is zero.
+     */
+    static Angle mean( Eigen::Ref<const Eigen::ArrayXd> const& rad );
+
+    /** @overload */
+    static Angle mean( std::vector<Angle> const& angles );
+
+    /** Removes the discontinuities of a sequence of angles in place
+     *
+     * The first value is kept, and the following ones are changed by
+     * multiples of 2 PI so that the difference between consecutive values
+     * is normalized. The result is not normalized anymore.
+     */
+    static void unwrap( Eigen::Ref<Eigen::ArrayXd> rad );
+
+    /** @overload */
+    static void unwrap( std::vector<double>& rad );
+
     /** 
      * use this method to get an angle from radians.
      * @return representation of the given angle.
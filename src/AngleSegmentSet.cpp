@@ -0,0 +1,263 @@
+#include "AngleSegmentSet.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace base {
+
+namespace
+{
+    /**
+     * Intervals closer than this are merged, and narrower ones dropped. This
+     * is the same threshold than AngleSegment::getIntersections
+     * */
+    const double TOLERANCE = 1e-10;
+
+    bool compareStart(const AngleSegmentSet::Interval &a, const AngleSegmentSet::Interval &b)
+    {
+        return a.start < b.start;
+    }
+
+    /**
+     * Returns the interval of @a intervals that contains @a rad, or
+     * intervals.end() if there is none
+     * */
+    std::vector<AngleSegmentSet::Interval>::const_iterator findInterval(
+            const std::vector<AngleSegmentSet::Interval> &intervals, double rad)
+    {
+        std::vector<AngleSegmentSet::Interval>::const_iterator it =
+            std::upper_bound(intervals.begin(), intervals.end(),
+                    AngleSegmentSet::Interval(rad, rad), compareStart);
+        if (it == intervals.begin())
+            return intervals.end();
+        --it;
+        if (rad <= it->end)
+            return it;
+        return intervals.end();
+    }
+}
+
+AngleSegmentSet::AngleSegmentSet()
+{
+}
+
+AngleSegmentSet::AngleSegmentSet(const AngleSegment &segment)
+{
+    addSegment(segment, intervals);
+    std::sort(intervals.begin(), intervals.end(), compareStart);
+}
+
+AngleSegmentSet AngleSegmentSet::fromSegments(const std::vector<AngleSegment> &segments)
+{
+    std::vector<Interval> all;
+    all.reserve(segments.size() + 1);
+    for (size_t i = 0; i < segments.size(); ++i)
+        addSegment(segments[i], all);
+    std::sort(all.begin(), all.end(), compareStart);
+
+    AngleSegmentSet result;
+    result.intervals.reserve(all.size());
+    for (size_t i = 0; i < all.size(); ++i)
+        result.append(all[i]);
+    return result;
+}
+
+AngleSegmentSet AngleSegmentSet::full()
+{
+    AngleSegmentSet result;
+    result.intervals.push_back(Interval(-M_PI, M_PI));
+    return result;
+}
+
+void AngleSegmentSet::addSegment(const AngleSegment &segment, std::vector<Interval> &result)
+{
+    if (segment.width >= 2 * M_PI)
+    {
+        result.push_back(Interval(-M_PI, M_PI));
+        return;
+    }
+
+    const double start = segment.startRad;
+    const double end = start + segment.width;
+    if (end <= M_PI)
+    {
+        if (end - start > TOLERANCE)
+            result.push_back(Interval(start, end));
+    }
+    else
+    {
+        if (M_PI - start > TOLERANCE)
+            result.push_back(Interval(start, M_PI));
+        if (end - M_PI > TOLERANCE)
+            result.push_back(Interval(-M_PI, end - 2 * M_PI));
+    }
+}
+
+void AngleSegmentSet::append(const Interval &interval)
+{
+    if (!intervals.empty() && interval.start <= intervals.back().end + TOLERANCE)
+        intervals.back().end = std::max(intervals.back().end, interval.end);
+    else
+        intervals.push_back(interval);
+}
+
+void AngleSegmentSet::insert(const AngleSegment &segment)
+{
+    AngleSegmentSet result;
+    unite(*this, AngleSegmentSet(segment), result);
+    intervals.swap(result.intervals);
+}
+
+bool AngleSegmentSet::isInside(const Angle &angle) const
+{
+    const double rad = angle.getRad();
+    if (findInterval(intervals, rad) != intervals.end())
+        return true;
+    // PI and -PI are the same angle
+    return rad == M_PI && !intervals.empty() && intervals.front().start == -M_PI;
+}
+
+bool AngleSegmentSet::isInside(const AngleSegment &segment) const
+{
+    std::vector<Interval> parts;
+    addSegment(segment, parts);
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        std::vector<Interval>::const_iterator it = findInterval(intervals, parts[i].start);
+        if (it == intervals.end() || parts[i].end > it->end)
+            return false;
+    }
+    if (parts.empty())
+        return isInside(segment.getStart());
+    return true;
+}
+
+double AngleSegmentSet::getWidth() const
+{
+    double width = 0;
+    for (size_t i = 0; i < intervals.size(); ++i)
+        width += intervals[i].getWidth();
+    return width;
+}
+
+std::vector<AngleSegment> AngleSegmentSet::getSegments() const
+{
+    std::vector<AngleSegment> result;
+    if (intervals.empty())
+        return result;
+
+    size_t first = 0, last = intervals.size();
+    result.reserve(intervals.size());
+    if (intervals.size() > 1 && intervals.front().start == -M_PI && intervals.back().end == M_PI)
+    {
+        // the first and last intervals are the two halves of a segment
+        // crossing PI
+        result.push_back(AngleSegment(Angle::fromRad(intervals.back().start),
+                    intervals.back().getWidth() + intervals.front().getWidth()));
+        ++first;
+        --last;
+    }
+    for (size_t i = first; i < last; ++i)
+        result.push_back(AngleSegment(Angle::fromRad(intervals[i].start), intervals[i].getWidth()));
+    return result;
+}
+
+void AngleSegmentSet::unite(const AngleSegmentSet &a, const AngleSegmentSet &b, AngleSegmentSet &result)
+{
+    result.intervals.clear();
+    result.intervals.reserve(a.intervals.size() + b.intervals.size());
+
+    std::vector<Interval>::const_iterator ia = a.intervals.begin(), ib = b.intervals.begin();
+    while (ia != a.intervals.end() || ib != b.intervals.end())
+    {
+        if (ib == b.intervals.end() || (ia != a.intervals.end() && ia->start <= ib->start))
+            result.append(*ia++);
+        else
+            result.append(*ib++);
+    }
+}
+
+void AngleSegmentSet::intersect(const AngleSegmentSet &a, const AngleSegmentSet &b, AngleSegmentSet &result)
+{
+    result.intervals.clear();
+
+    std::vector<Interval>::const_iterator ia = a.intervals.begin(), ib = b.intervals.begin();
+    while (ia != a.intervals.end() && ib != b.intervals.end())
+    {
+        const double start = std::max(ia->start, ib->start);
+        const double end = std::min(ia->end, ib->end);
+        if (end - start > TOLERANCE)
+            result.intervals.push_back(Interval(start, end));
+
+        if (ia->end < ib->end)
+            ++ia;
+        else
+            ++ib;
+    }
+}
+
+void AngleSegmentSet::subtract(const AngleSegmentSet &a, const AngleSegmentSet &b, AngleSegmentSet &result)
+{
+    result.intervals.clear();
+
+    std::vector<Interval>::const_iterator ib = b.intervals.begin();
+    for (std::vector<Interval>::const_iterator ia = a.intervals.begin(); ia != a.intervals.end(); ++ia)
+    {
+        double start = ia->start;
+        // skip the intervals of b that end before this one
+        while (ib != b.intervals.end() && ib->end <= start)
+            ++ib;
+
+        std::vector<Interval>::const_iterator it = ib;
+        for (; it != b.intervals.end() && it->start < ia->end; ++it)
+        {
+            if (it->start - start > TOLERANCE)
+                result.intervals.push_back(Interval(start, it->start));
+            start = std::max(start, it->end);
+        }
+        if (ia->end - start > TOLERANCE)
+            result.intervals.push_back(Interval(start, ia->end));
+    }
+}
+
+AngleSegmentSet AngleSegmentSet::unite(const AngleSegmentSet &other) const
+{
+    AngleSegmentSet result;
+    unite(*this, other, result);
+    return result;
+}
+
+AngleSegmentSet AngleSegmentSet::intersect(const AngleSegmentSet &other) const
+{
+    AngleSegmentSet result;
+    intersect(*this, other, result);
+    return result;
+}
+
+AngleSegmentSet AngleSegmentSet::subtract(const AngleSegmentSet &other) const
+{
+    AngleSegmentSet result;
+    subtract(*this, other, result);
+    return result;
+}
+
+AngleSegmentSet AngleSegmentSet::complement() const
+{
+    AngleSegmentSet result;
+    subtract(full(), *this, result);
+    return result;
+}
+
+std::ostream& operator << (std::ostream& os, const AngleSegmentSet &set)
+{
+    os << "{";
+    for (AngleSegmentSet::const_iterator it = set.begin(); it != set.end(); ++it)
+    {
+        if (it != set.begin())
+            os << ", ";
+        os << "[" << it->start << ", " << it->end << "]";
+    }
+    os << "}";
+    return os;
+}
+
+} //end namespace base
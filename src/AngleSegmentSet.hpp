@@ -0,0 +1,191 @@
+#ifndef __BASE_ANGLE_SEGMENT_SET_HH__
+#define __BASE_ANGLE_SEGMENT_SET_HH__
+
+#include <vector>
+#include <iosfwd>
+#include <base/Angle.hpp>
+
+namespace base
+{
+
+/**
+ * A set of angles, represented as a union of AngleSegment.
+ *
+ * The segments are stored as sorted, disjoint intervals of the [-PI, PI]
+ * line. Segments that cross PI are split in two, so that the intervals never
+ * wrap around. This allows to test whether an angle is in the set with a
+ * binary search, and to compute unions, intersections and differences of sets
+ * in a single pass over the intervals.
+ *
+ * All intervals are closed. Intervals that are less than 1e-10 rad apart
+ * are merged, and narrower intervals are not kept: the set describes the
+ * angular coverage, not its exact boundaries.
+ * */
+class AngleSegmentSet
+{
+public:
+    /**
+     * Interval of the set, in radians, with -PI <= start < end <= PI
+     * */
+    struct Interval
+    {
+        double start;
+        double end;
+
+        Interval() : start(0), end(0) {}
+        Interval(double start, double end) : start(start), end(end) {}
+
+        double getWidth() const
+        {
+            return end - start;
+        }
+
+        bool operator==(const Interval &other) const
+        {
+            return start == other.start && end == other.end;
+        }
+    };
+
+    typedef std::vector<Interval>::const_iterator const_iterator;
+
+    /**
+     * Creates an empty set
+     * */
+    AngleSegmentSet();
+
+    /**
+     * Creates a set containing a single segment
+     * */
+    explicit AngleSegmentSet(const AngleSegment &segment);
+
+    /**
+     * Creates the union of the given segments, in O(n log n)
+     * */
+    static AngleSegmentSet fromSegments(const std::vector<AngleSegment> &segments);
+
+    /**
+     * Returns the set of all angles
+     * */
+    static AngleSegmentSet full();
+
+    /**
+     * Adds a segment to the set, in O(n)
+     * */
+    void insert(const AngleSegment &segment);
+
+    void clear()
+    {
+        intervals.clear();
+    }
+
+    bool empty() const
+    {
+        return intervals.empty();
+    }
+
+    /**
+     * Returns the number of intervals. A segment that crosses PI counts as
+     * two intervals.
+     * */
+    size_t size() const
+    {
+        return intervals.size();
+    }
+
+    /**
+     * Iteration over the intervals, sorted by start angle
+     * */
+    const_iterator begin() const
+    {
+        return intervals.begin();
+    }
+
+    const_iterator end() const
+    {
+        return intervals.end();
+    }
+
+    /**
+     * Tests if the given angle is inside the set, in O(log n)
+     * */
+    bool isInside(const Angle &angle) const;
+
+    /**
+     * Tests if the given segment is completely inside the set, in O(log n)
+     * */
+    bool isInside(const AngleSegment &segment) const;
+
+    /**
+     * Returns the sum of the widths of the intervals, in radians
+     * */
+    double getWidth() const;
+
+    /**
+     * Returns the set as segments. Unlike the intervals, the segments may
+     * cross PI, i.e. a segment that has been split is merged back.
+     * */
+    std::vector<AngleSegment> getSegments() const;
+
+    /**
+     * Computes the union of two sets in O(n)
+     *
+     * @param result the set the union is written to. Its storage is reused.
+     *   It must not be one of the inputs.
+     * */
+    static void unite(const AngleSegmentSet &a, const AngleSegmentSet &b, AngleSegmentSet &result);
+
+    /**
+     * Computes the intersection of two sets in O(n)
+     *
+     * @param result the set the intersection is written to. Its storage is
+     *   reused. It must not be one of the inputs.
+     * */
+    static void intersect(const AngleSegmentSet &a, const AngleSegmentSet &b, AngleSegmentSet &result);
+
+    /**
+     * Computes the angles of @a a that are not in @a b, in O(n)
+     *
+     * @param result the set the difference is written to. Its storage is
+     *   reused. It must not be one of the inputs.
+     * */
+    static void subtract(const AngleSegmentSet &a, const AngleSegmentSet &b, AngleSegmentSet &result);
+
+    AngleSegmentSet unite(const AngleSegmentSet &other) const;
+    AngleSegmentSet intersect(const AngleSegmentSet &other) const;
+    AngleSegmentSet subtract(const AngleSegmentSet &other) const;
+
+    /**
+     * Returns the set of the angles that are not in this set, in O(n)
+     * */
+    AngleSegmentSet complement() const;
+
+    bool operator==(const AngleSegmentSet &other) const
+    {
+        return intervals == other.intervals;
+    }
+
+    bool operator!=(const AngleSegmentSet &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    std::vector<Interval> intervals;
+
+    /**
+     * Appends an interval that does not start before the last one, merging
+     * it with the last one if they overlap
+     * */
+    void append(const Interval &interval);
+
+    /**
+     * Appends the intervals of a segment to the given list, unsorted
+     * */
+    static void addSegment(const AngleSegment &segment, std::vector<Interval> &result);
+};
+
+std::ostream& operator << (std::ostream& os, const AngleSegmentSet &set);
+
+}
+
+#endif
@@ -3,6 +3,9 @@
 
 #include <Eigen/Core>
 #include <Eigen/Geometry> 
+#include <vector>
+#include <type_traits>
+#include <base/Float.hpp>
 
 
 namespace base
@@ -38,21 +41,208 @@ namespace base
     // alias for backward compatibility
     typedef Affine3d					   Transform3d;
 
+    // Aligned counterparts of the typedefs above, for use in computations.
+    //
+    // The types above are meant for storage, i.e. as fields of the data
+    // structures. Their lack of alignment disables vectorization, which does
+    // matter for the 4x4 and 6x6 types and for the quaternion products. Code
+    // that does heavy math on them should convert once into these types,
+    // compute, and only convert the result back. Both directions are
+    // implicit copies; toAligned() makes the conversion explicit when the
+    // type is otherwise deduced.
+    //
+    // These types must not be used as fields of the data structures, and
+    // need aligned::vector (or Eigen::aligned_allocator) when stored in STL
+    // containers.
+    namespace aligned
+    {
+        typedef Eigen::Matrix<double, 2, 1>     Vector2d;
+        typedef Eigen::Matrix<double, 3, 1>     Vector3d;
+        typedef Eigen::Matrix<double, 4, 1>     Vector4d;
+        typedef Eigen::Matrix<double, 6, 1>     Vector6d;
+
+        typedef Eigen::Matrix<double, 2, 2>     Matrix2d;
+        typedef Eigen::Matrix<double, 3, 3>     Matrix3d;
+        typedef Eigen::Matrix<double, 4, 4>     Matrix4d;
+        typedef Eigen::Matrix<double, 6, 6>     Matrix6d;
+
+        typedef Eigen::Quaternion<double>                        Quaterniond;
+        typedef Eigen::Transform<double, 3, Eigen::Affine>       Affine3d;
+        typedef Eigen::Transform<double, 3, Eigen::Isometry>     Isometry3d;
+
+        /** std::vector with the allocator required by aligned Eigen types */
+        template<typename T>
+        using vector = std::vector<T, Eigen::aligned_allocator<T> >;
+    }
+
+    /** Converts a matrix or vector into its aligned counterpart */
+    template<typename _Derived>
+    static inline Eigen::Matrix<typename _Derived::Scalar,
+           _Derived::RowsAtCompileTime, _Derived::ColsAtCompileTime>
+    toAligned(const Eigen::MatrixBase<_Derived>& x)
+    {
+        return x;
+    }
+
+    /** Converts a quaternion into its aligned counterpart */
+    template<typename _Scalar, int _Options>
+    static inline Eigen::Quaternion<_Scalar>
+    toAligned(const Eigen::Quaternion<_Scalar, _Options>& q)
+    {
+        return Eigen::Quaternion<_Scalar>(q.coeffs());
+    }
+
+    /** Converts a transform into its aligned counterpart */
+    template<typename _Scalar, int _Mode, int _Options>
+    static inline Eigen::Transform<_Scalar, 3, _Mode>
+    toAligned(const Eigen::Transform<_Scalar, 3, _Mode, _Options>& t)
+    {
+        return Eigen::Transform<_Scalar, 3, _Mode>(t.matrix());
+    }
+
+    /** Returns the skew-symmetric matrix [v]x, i.e. [v]x * w = v.cross(w) */
+    static inline Eigen::Matrix3d skew(const Eigen::Vector3d& v)
+    {
+        Eigen::Matrix3d res;
+        res << 0, -v.z(), v.y(),
+            v.z(), 0, -v.x(),
+            -v.y(), v.x(), 0;
+        return res;
+    }
+
+    namespace detail
+    {
+        /**
+         * Calls op(data, size) on the contiguous parts of x, until op returns
+         * false. Matrices, maps and blocks with direct access are visited in
+         * place (one call per column for blocks), other expressions are
+         * evaluated first.
+         *
+         * Returns false if op did
+         */
+        template<typename _Derived,
+            bool _DirectAccess = (Eigen::internal::traits<_Derived>::Flags & Eigen::DirectAccessBit) != 0>
+        struct ContiguousVisitor
+        {
+            template<typename Op>
+            static bool run(const _Derived& x, Op& op)
+            {
+                typename _Derived::PlainObject plain = x;
+                return op(plain.data(), static_cast<size_t>(plain.size()));
+            }
+        };
+
+        template<typename _Derived>
+        struct ContiguousVisitor<_Derived, true>
+        {
+            template<typename Op>
+            static bool run(const _Derived& x, Op& op)
+            {
+                if (x.innerStride() != 1)
+                    return ContiguousVisitor<_Derived, false>::run(x, op);
+                if (x.outerSize() <= 1 || x.outerStride() == x.innerSize())
+                    return op(x.data(), static_cast<size_t>(x.size()));
+                for (Eigen::Index i = 0; i < x.outerSize(); ++i)
+                {
+                    if (!op(x.data() + i * x.outerStride(), static_cast<size_t>(x.innerSize())))
+                        return false;
+                }
+                return true;
+            }
+        };
+
+        template<FloatCheck Check, typename _Derived>
+        static inline bool anyInMatrix(const Eigen::MatrixBase<_Derived>& x)
+        {
+            typedef typename _Derived::Scalar Scalar;
+            bool found = false;
+            auto op = [&found](const Scalar* data, size_t size) {
+                found = detail::any<Scalar, Check>(data, size);
+                return !found;
+            };
+            ContiguousVisitor<_Derived>::run(x.derived(), op);
+            return found;
+        }
+
+        template<FloatCheck Check, typename _Derived>
+        static inline size_t countInMatrix(const Eigen::MatrixBase<_Derived>& x)
+        {
+            typedef typename _Derived::Scalar Scalar;
+            size_t result = 0;
+            auto op = [&result](const Scalar* data, size_t size) {
+                result += detail::count<Scalar, Check>(data, size);
+                return true;
+            };
+            ContiguousVisitor<_Derived>::run(x.derived(), op);
+            return result;
+        }
+
+        template<typename _Scalar>
+        struct HasBulkFloatChecks
+            : std::integral_constant<bool, std::is_same<_Scalar, float>::value || std::is_same<_Scalar, double>::value> {};
+
+        template<typename _Derived>
+        static inline bool isnotnan(const Eigen::MatrixBase<_Derived>& x, std::true_type)
+        {
+            return !anyInMatrix<CHECK_NAN>(x);
+        }
+
+        template<typename _Derived>
+        static inline bool isnotnan(const Eigen::MatrixBase<_Derived>& x, std::false_type)
+        {
+            return ((x.array() == x.array())).all();
+        }
+
+        template<typename _Derived>
+        static inline bool isfinite(const Eigen::MatrixBase<_Derived>& x, std::true_type)
+        {
+            return !anyInMatrix<CHECK_NON_FINITE>(x);
+        }
+
+        template<typename _Derived>
+        static inline bool isfinite(const Eigen::MatrixBase<_Derived>& x, std::false_type)
+        {
+            return isnotnan(x - x, std::false_type());
+        }
+    }
+
     /**
      * @brief Check if NaN values
+     *
+     * float and double matrices, maps and blocks are checked in place with
+     * the bulk bit-pattern checks of Float.hpp
      */
     template<typename _Derived>
     static inline bool isnotnan(const Eigen::MatrixBase<_Derived>& x)
     {
-        return ((x.array() == x.array())).all();
+        return detail::isnotnan(x, detail::HasBulkFloatChecks<typename _Derived::Scalar>());
     };
 
     template<typename _Derived>
     static inline bool isfinite(const Eigen::MatrixBase<_Derived>& x)
     {
-        return isnotnan(x - x);
+        return detail::isfinite(x, detail::HasBulkFloatChecks<typename _Derived::Scalar>());
     };
 
+    /**
+     * Returns the number of NaN coefficients of a float or double matrix
+     */
+    template<typename _Derived>
+    static inline size_t countNaN(const Eigen::MatrixBase<_Derived>& x)
+    {
+        return detail::countInMatrix<detail::CHECK_NAN>(x);
+    }
+
+    /**
+     * Returns the number of NaN or infinite coefficients of a float or double
+     * matrix
+     */
+    template<typename _Derived>
+    static inline size_t countNonFinite(const Eigen::MatrixBase<_Derived>& x)
+    {
+        return detail::countInMatrix<detail::CHECK_NON_FINITE>(x);
+    }
+
 }
 
 #endif
@@ -3,6 +3,9 @@
 
 #include <cmath>
 #include <limits>
+#include <cstring>
+#include <cstddef>
+#include <stdint.h>
 
 namespace base {
     template<typename T> T NaN() { return std::numeric_limits<T>::quiet_NaN(); }
@@ -13,6 +16,102 @@ namespace base {
     template<typename T> bool isUnknown(T value) { return std::isnan(value); }
     template<typename T> T infinity() { return std::numeric_limits<T>::infinity(); }
     template<typename T> bool isInfinity(T value) { return std::isinf(value); }
+
+    /**
+     * Bulk NaN and infinity checks over contiguous arrays of float or double
+     *
+     * They test the bit patterns (all ones exponent) instead of calling
+     * std::isnan on each value, which lets the compiler vectorize the loops.
+     * The any/all variants process the array in blocks and exit early after
+     * the first block that contains a match.
+     */
+    namespace detail
+    {
+        /** Bit layout of the IEEE 754 types */
+        template<typename T> struct FloatBits;
+        template<> struct FloatBits<float>
+        {
+            typedef uint32_t Bits;
+            static Bits exponent() { return 0x7f800000u; }
+            static Bits magnitude() { return 0x7fffffffu; }
+        };
+        template<> struct FloatBits<double>
+        {
+            typedef uint64_t Bits;
+            static Bits exponent() { return 0x7ff0000000000000ull; }
+            static Bits magnitude() { return 0x7fffffffffffffffull; }
+        };
+
+        /** The values matched by a bulk check */
+        enum FloatCheck { CHECK_NAN, CHECK_NON_FINITE };
+
+        static const size_t BLOCK_SIZE = 64;
+
+        template<typename T, FloatCheck Check>
+        inline unsigned test(const T* value)
+        {
+            typedef FloatBits<T> Layout;
+            typename Layout::Bits bits;
+            std::memcpy(&bits, value, sizeof(bits));
+            if (Check == CHECK_NAN)
+                return (bits & Layout::magnitude()) > Layout::exponent();
+            else
+                return (bits & Layout::exponent()) == Layout::exponent();
+        }
+
+        template<typename T, FloatCheck Check>
+        bool any(const T* data, size_t size)
+        {
+            size_t i = 0;
+            for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE)
+            {
+                unsigned found = 0;
+                for (size_t j = 0; j < BLOCK_SIZE; ++j)
+                    found |= test<T, Check>(data + i + j);
+                if (found)
+                    return true;
+            }
+            unsigned found = 0;
+            for (; i < size; ++i)
+                found |= test<T, Check>(data + i);
+            return found;
+        }
+
+        template<typename T, FloatCheck Check>
+        size_t count(const T* data, size_t size)
+        {
+            size_t result = 0;
+            for (size_t i = 0; i < size; ++i)
+                result += test<T, Check>(data + i);
+            return result;
+        }
+
+        template<typename T, FloatCheck Check>
+        size_t mask(const T* data, size_t size, bool* mask)
+        {
+            size_t result = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                unsigned found = test<T, Check>(data + i);
+                mask[i] = found;
+                result += found;
+            }
+            return result;
+        }
+    }
+
+    /** Tests if any of the @a size values starting at @a data is NaN */
+    template<typename T> bool anyNaN(const T* data, size_t size) { return detail::any<T, detail::CHECK_NAN>(data, size); }
+    /** Tests if none of the @a size values starting at @a data is NaN or infinite */
+    template<typename T> bool allFinite(const T* data, size_t size) { return !detail::any<T, detail::CHECK_NON_FINITE>(data, size); }
+    /** Returns the number of NaN values in the array */
+    template<typename T> size_t countNaN(const T* data, size_t size) { return detail::count<T, detail::CHECK_NAN>(data, size); }
+    /** Returns the number of NaN or infinite values in the array */
+    template<typename T> size_t countNonFinite(const T* data, size_t size) { return detail::count<T, detail::CHECK_NON_FINITE>(data, size); }
+    /** Sets mask[i] if data[i] is NaN, and returns the number of NaN values */
+    template<typename T> size_t maskNaN(const T* data, size_t size, bool* mask) { return detail::mask<T, detail::CHECK_NAN>(data, size, mask); }
+    /** Sets mask[i] if data[i] is NaN or infinite, and returns their number */
+    template<typename T> size_t maskNonFinite(const T* data, size_t size, bool* mask) { return detail::mask<T, detail::CHECK_NON_FINITE>(data, size, mask); }
 }
 
 #endif
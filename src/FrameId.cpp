@@ -0,0 +1,99 @@
+#include "FrameId.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace base {
+
+namespace
+{
+    /** Process-wide storage of the interned frame names
+     *
+     * Names are stored in a deque so that references returned by getName
+     * stay valid when new names are added
+     */
+    struct FrameRegistry
+    {
+        std::mutex lock;
+        std::deque<std::string> names;
+        std::unordered_map<std::string, FrameId::Handle> handles;
+
+        FrameRegistry()
+        {
+            names.push_back(std::string());
+            handles[std::string()] = 0;
+        }
+
+        static FrameRegistry& instance()
+        {
+            static FrameRegistry registry;
+            return registry;
+        }
+    };
+}
+
+std::string const& FrameId::getEmptyName()
+{
+    static const std::string empty;
+    return empty;
+}
+
+FrameId FrameId::intern(std::string const& name)
+{
+    FrameRegistry& registry = FrameRegistry::instance();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    std::unordered_map<std::string, Handle>::const_iterator it = registry.handles.find(name);
+    if (it != registry.handles.end())
+        return FrameId(it->second, &registry.names[it->second]);
+
+    Handle handle = registry.names.size();
+    registry.names.push_back(name);
+    registry.handles[name] = handle;
+    return FrameId(handle, &registry.names.back());
+}
+
+FrameId FrameId::fromName(std::string const& name)
+{
+    if (name.empty())
+        return FrameId();
+
+    // the registry never forgets a name, so the IDs resolved by a thread
+    // stay valid and can be looked up without locking
+    thread_local std::unordered_map<std::string, FrameId> resolved;
+    std::unordered_map<std::string, FrameId>::const_iterator it = resolved.find(name);
+    if (it != resolved.end())
+        return it->second;
+
+    FrameId id = intern(name);
+    resolved.insert(std::make_pair(name, id));
+    return id;
+}
+
+FrameId FrameId::find(std::string const& name)
+{
+    if (name.empty())
+        return FrameId();
+
+    FrameRegistry& registry = FrameRegistry::instance();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    std::unordered_map<std::string, Handle>::const_iterator it = registry.handles.find(name);
+    if (it != registry.handles.end())
+        return FrameId(it->second, &registry.names[it->second]);
+    return FrameId();
+}
+
+size_t FrameId::registrySize()
+{
+    FrameRegistry& registry = FrameRegistry::instance();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    return registry.names.size();
+}
+
+std::ostream& operator << (std::ostream& io, FrameId const& frame)
+{
+    io << frame.getName();
+    return io;
+}
+
+} //end namespace base
@@ -0,0 +1,138 @@
+#ifndef __BASE_FRAME_ID_HH__
+#define __BASE_FRAME_ID_HH__
+
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include <functional>
+
+namespace base
+{
+
+/**
+ * Interned reference frame name
+ *
+ * Frame names (e.g. RigidBodyState::sourceFrame or
+ * PoseWithCovariance::frame_id) are strings, which are expensive to copy and
+ * to compare. A FrameId is a small integer handle to a name stored once in a
+ * process-wide registry, so that copying and comparing two frame IDs is
+ * constant time. Code that handles many transforms (e.g. a transform graph)
+ * should convert the frame names once with FrameId::fromName and work on the
+ * handles afterwards.
+ *
+ * The string fields stay the interface representation: FrameId is not meant
+ * to be used in data types that are exchanged between processes, as the
+ * handle values are only valid within the process that created them.
+ *
+ * The registry never forgets a name, so handles stay valid for the whole
+ * lifetime of the process. Interning is thread-safe.
+ */
+class FrameId
+{
+public:
+    typedef uint32_t Handle;
+
+    /** Creates the ID of the unnamed frame (the empty string) */
+    FrameId() : handle(0), name(&getEmptyName()) {}
+
+    /** Interns @a name and returns its ID
+     *
+     * Each thread keeps the IDs it already resolved, so that this is a
+     * lookup in a thread-local hash map, without locking. The registry is
+     * only locked the first time a thread sees a given name.
+     */
+    static FrameId fromName(std::string const& name);
+
+    /** Returns the ID of @a name if it is already interned, and the unnamed
+     * frame otherwise. Unlike fromName, this never modifies the registry.
+     */
+    static FrameId find(std::string const& name);
+
+    /** Returns the name of the frame
+     *
+     * This does not access the registry. The returned reference stays valid
+     * for the lifetime of the process.
+     */
+    std::string const& getName() const { return *name; }
+
+    Handle getHandle() const { return handle; }
+
+    /** True if this is the ID of the unnamed frame */
+    bool empty() const { return handle == 0; }
+
+    bool operator==(FrameId const& other) const { return handle == other.handle; }
+    bool operator!=(FrameId const& other) const { return handle != other.handle; }
+
+    /** Orders the IDs by handle, i.e. by interning order
+     *
+     * This is not the lexicographic order of the names, but it is suitable
+     * to use FrameId as a key in ordered containers.
+     */
+    bool operator<(FrameId const& other) const { return handle < other.handle; }
+
+    /** Returns the count of names interned so far, including the empty name */
+    static size_t registrySize();
+
+private:
+    FrameId(Handle handle, std::string const* name) : handle(handle), name(name) {}
+    static FrameId intern(std::string const& name);
+    static std::string const& getEmptyName();
+
+    Handle handle;
+    /** The interned name, which the registry never moves */
+    std::string const* name;
+};
+
+/**
+ * Pair of interned frames, usable as the key of a transformation between two
+ * frames
+ */
+struct FramePair
+{
+    FrameId source;
+    FrameId target;
+
+    FramePair() {}
+    FramePair(FrameId const& source, FrameId const& target)
+        : source(source), target(target) {}
+
+    /** Returns the pair describing the inverse transformation */
+    FramePair inverse() const { return FramePair(target, source); }
+
+    bool operator==(FramePair const& other) const
+    { return source == other.source && target == other.target; }
+    bool operator!=(FramePair const& other) const
+    { return !(*this == other); }
+    bool operator<(FramePair const& other) const
+    {
+        return source < other.source ||
+            (source == other.source && target < other.target);
+    }
+
+    /** Returns a value suitable as a hash of this pair */
+    uint64_t hash() const
+    {
+        return (static_cast<uint64_t>(source.getHandle()) << 32) | target.getHandle();
+    }
+};
+
+std::ostream& operator << (std::ostream& io, FrameId const& frame);
+
+}
+
+namespace std
+{
+    template<> struct hash<base::FrameId>
+    {
+        size_t operator()(base::FrameId const& frame) const
+        { return frame.getHandle(); }
+    };
+
+    template<> struct hash<base::FramePair>
+    {
+        size_t operator()(base::FramePair const& pair) const
+        { return std::hash<uint64_t>()(pair.hash()); }
+    };
+}
+
+#endif
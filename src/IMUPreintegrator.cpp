@@ -0,0 +1,184 @@
+#include "IMUPreintegrator.hpp"
+
+#include <cmath>
+
+namespace base {
+
+PreintegratedIMU::PreintegratedIMU(base::Vector3d const& bias_gyro, base::Vector3d const& bias_acc)
+    : dt(0)
+    , delta_rotation(base::Quaterniond::Identity())
+    , delta_velocity(base::Vector3d::Zero())
+    , delta_position(base::Vector3d::Zero())
+    , cov(Covariance::Zero())
+    , bias_gyro(bias_gyro)
+    , bias_acc(bias_acc)
+    , d_rotation_d_bias_gyro(base::Matrix3d::Zero())
+    , d_velocity_d_bias_gyro(base::Matrix3d::Zero())
+    , d_velocity_d_bias_acc(base::Matrix3d::Zero())
+    , d_position_d_bias_gyro(base::Matrix3d::Zero())
+    , d_position_d_bias_acc(base::Matrix3d::Zero())
+{
+}
+
+PreintegratedIMU PreintegratedIMU::correct(base::Vector3d const& bias_gyro, base::Vector3d const& bias_acc) const
+{
+    const Eigen::Vector3d dbg = bias_gyro - this->bias_gyro;
+    const Eigen::Vector3d dba = bias_acc - this->bias_acc;
+
+    PreintegratedIMU result(*this);
+    Eigen::Quaterniond correction;
+    Eigen::Matrix3d unused;
+    IMUPreintegrator::expSO3(d_rotation_d_bias_gyro * dbg, correction, unused);
+    result.delta_rotation = (Eigen::Quaterniond(delta_rotation) * correction).normalized();
+    result.delta_velocity += d_velocity_d_bias_gyro * dbg + d_velocity_d_bias_acc * dba;
+    result.delta_position += d_position_d_bias_gyro * dbg + d_position_d_bias_acc * dba;
+    result.bias_gyro = bias_gyro;
+    result.bias_acc = bias_acc;
+    return result;
+}
+
+void PreintegratedIMU::predict(base::Quaterniond const& orientation_i, base::Vector3d const& velocity_i,
+                               base::Vector3d const& position_i, base::Vector3d const& gravity,
+                               base::Quaterniond& orientation_j, base::Vector3d& velocity_j,
+                               base::Vector3d& position_j) const
+{
+    const Eigen::Quaterniond q_i(orientation_i);
+    orientation_j = (q_i * Eigen::Quaterniond(delta_rotation)).normalized();
+    velocity_j = velocity_i + gravity * dt + q_i * delta_velocity;
+    position_j = position_i + velocity_i * dt + 0.5 * gravity * dt * dt + q_i * delta_position;
+}
+
+IMUPreintegrator::IMUPreintegrator(double gyro_noise_density, double acc_noise_density)
+    : gyro_variance(gyro_noise_density * gyro_noise_density)
+    , acc_variance(acc_noise_density * acc_noise_density)
+{
+}
+
+void IMUPreintegrator::reset()
+{
+    delta = PreintegratedIMU(delta.bias_gyro, delta.bias_acc);
+}
+
+void IMUPreintegrator::reset(base::Vector3d const& bias_gyro, base::Vector3d const& bias_acc)
+{
+    delta = PreintegratedIMU(bias_gyro, bias_acc);
+}
+
+void IMUPreintegrator::resetTime()
+{
+    last_time = base::Time();
+}
+
+void IMUPreintegrator::expSO3(Eigen::Vector3d const& phi, Eigen::Quaterniond& rotation,
+                              Eigen::Matrix3d& right_jacobian)
+{
+    const double theta2 = phi.squaredNorm();
+    const double theta = std::sqrt(theta2);
+    const Eigen::Matrix3d phi_x = skew(phi);
+
+    // a = (1 - cos t) / t^2 and b = (t - sin t) / t^3, with their Taylor
+    // expansion near zero
+    double a, b;
+    if (theta < 1e-4)
+    {
+        a = 0.5 - theta2 / 24.0;
+        b = 1.0 / 6.0 - theta2 / 120.0;
+        rotation.w() = 1.0 - theta2 / 8.0;
+        rotation.vec() = phi * (0.5 - theta2 / 48.0);
+    }
+    else
+    {
+        a = (1.0 - std::cos(theta)) / theta2;
+        b = (theta - std::sin(theta)) / (theta2 * theta);
+        rotation.w() = std::cos(theta / 2);
+        rotation.vec() = phi * (std::sin(theta / 2) / theta);
+    }
+    right_jacobian = Eigen::Matrix3d::Identity() - a * phi_x + b * phi_x * phi_x;
+}
+
+void IMUPreintegrator::integrate(base::Vector3d const& acc, base::Vector3d const& gyro, double dt)
+{
+    if (!(dt > 0))
+        return;
+
+    const Eigen::Vector3d a = acc - delta.bias_acc;
+    const Eigen::Vector3d w = gyro - delta.bias_gyro;
+    const double dt2 = dt * dt;
+
+    Eigen::Quaterniond step;
+    Eigen::Matrix3d Jr;
+    expSO3(w * dt, step, Jr);
+    const Eigen::Matrix3d step_R = step.toRotationMatrix();
+    const Eigen::Matrix3d R = Eigen::Quaterniond(delta.delta_rotation).toRotationMatrix();
+    const Eigen::Matrix3d R_a_x = R * skew(a);
+
+    // covariance, in [rotation velocity position] order
+    Eigen::Matrix<double, 9, 9> A = Eigen::Matrix<double, 9, 9>::Identity();
+    A.block<3,3>(0,0) = step_R.transpose();
+    A.block<3,3>(3,0) = -R_a_x * dt;
+    A.block<3,3>(6,0) = -0.5 * R_a_x * dt2;
+    A.block<3,3>(6,3) = Eigen::Matrix3d::Identity() * dt;
+
+    Eigen::Matrix<double, 9, 3> B_gyro = Eigen::Matrix<double, 9, 3>::Zero();
+    B_gyro.block<3,3>(0,0) = Jr * dt;
+    Eigen::Matrix<double, 9, 3> B_acc = Eigen::Matrix<double, 9, 3>::Zero();
+    B_acc.block<3,3>(3,0) = R * dt;
+    B_acc.block<3,3>(6,0) = 0.5 * R * dt2;
+
+    // the discrete noise of a white noise density is density^2 / dt
+    const Eigen::Matrix<double, 9, 9> cov(delta.cov);
+    delta.cov = A * cov * A.transpose()
+        + (gyro_variance / dt) * B_gyro * B_gyro.transpose()
+        + (acc_variance / dt) * B_acc * B_acc.transpose();
+
+    // bias Jacobians, which use the deltas before the step
+    const Eigen::Matrix3d dR_dbg(delta.d_rotation_d_bias_gyro);
+    const Eigen::Matrix3d dv_dbg(delta.d_velocity_d_bias_gyro);
+    const Eigen::Matrix3d dv_dba(delta.d_velocity_d_bias_acc);
+    delta.d_position_d_bias_acc += dv_dba * dt - 0.5 * R * dt2;
+    delta.d_position_d_bias_gyro += dv_dbg * dt - 0.5 * R_a_x * dR_dbg * dt2;
+    delta.d_velocity_d_bias_acc -= R * dt;
+    delta.d_velocity_d_bias_gyro -= R_a_x * dR_dbg * dt;
+    delta.d_rotation_d_bias_gyro = step_R.transpose() * dR_dbg - Jr * dt;
+
+    const Eigen::Vector3d Ra = R * a;
+    delta.delta_position += delta.delta_velocity * dt + 0.5 * Ra * dt2;
+    delta.delta_velocity += Ra * dt;
+    delta.delta_rotation = (Eigen::Quaterniond(delta.delta_rotation) * step).normalized();
+    delta.dt += dt;
+}
+
+bool IMUPreintegrator::update(samples::IMUSensors const& sample)
+{
+    if (last_time.isNull())
+    {
+        last_time = sample.time;
+        return false;
+    }
+    if (sample.time <= last_time)
+        return false;
+
+    integrate(sample.acc, sample.gyro, (sample.time - last_time).toSeconds());
+    last_time = sample.time;
+    return true;
+}
+
+void IMUPreintegrator::integrate(samples::IMUSensorsBatch const& batch)
+{
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        const base::Time time = batch.getTime(i);
+        if (last_time.isNull())
+        {
+            last_time = time;
+            continue;
+        }
+        if (time <= last_time)
+            continue;
+
+        integrate(batch.acc[i], batch.gyro[i], (time - last_time).toSeconds());
+        last_time = time;
+    }
+}
+
+} // namespaces
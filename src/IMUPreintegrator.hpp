@@ -0,0 +1,138 @@
+#ifndef __BASE_IMU_PREINTEGRATOR_HPP__
+#define __BASE_IMU_PREINTEGRATOR_HPP__
+
+#include <base/Eigen.hpp>
+#include <base/Time.hpp>
+#include <base/samples/IMUSensors.hpp>
+#include <base/samples/IMUSensorsBatch.hpp>
+
+namespace base {
+
+    /**
+     * Motion between two keyframes, as measured by an IMU
+     *
+     * The deltas are expressed in the body frame of the first keyframe i,
+     * and do not depend on its pose, velocity or on gravity:
+     *
+     * R_j = R_i * delta_rotation
+     * v_j = v_i + g * dt + R_i * delta_velocity
+     * p_j = p_i + v_i * dt + g * dt^2 / 2 + R_i * delta_position
+     *
+     * (see predict). The covariance uses the [rotation velocity position]
+     * ordering, the rotation error being a rotation vector on the right of
+     * delta_rotation.
+     *
+     * The bias Jacobians allow to correct the deltas for a change of the
+     * biases without integrating again (see correct).
+     */
+    struct PreintegratedIMU
+    {
+        typedef Eigen::Matrix<double, 9, 9, Eigen::DontAlign> Covariance;
+
+        /** Integration time, in seconds */
+        double dt;
+
+        base::Quaterniond delta_rotation;
+        base::Vector3d delta_velocity;
+        base::Vector3d delta_position;
+        Covariance cov;
+
+        /** Biases used during the integration */
+        base::Vector3d bias_gyro;
+        base::Vector3d bias_acc;
+
+        /** Jacobians of the deltas w.r.t. the biases */
+        base::Matrix3d d_rotation_d_bias_gyro;
+        base::Matrix3d d_velocity_d_bias_gyro;
+        base::Matrix3d d_velocity_d_bias_acc;
+        base::Matrix3d d_position_d_bias_gyro;
+        base::Matrix3d d_position_d_bias_acc;
+
+        /** Zero motion with the given biases */
+        explicit PreintegratedIMU(base::Vector3d const& bias_gyro = base::Vector3d::Zero(),
+                                  base::Vector3d const& bias_acc = base::Vector3d::Zero());
+
+        /** Returns the deltas corrected, to first order, for the given biases */
+        PreintegratedIMU correct(base::Vector3d const& bias_gyro, base::Vector3d const& bias_acc) const;
+
+        /** Computes the state at the second keyframe from the state at the
+         * first one
+         *
+         * @param gravity the gravity vector in the world frame, e.g.
+         *   (0, 0, -9.81)
+         */
+        void predict(base::Quaterniond const& orientation_i, base::Vector3d const& velocity_i,
+                     base::Vector3d const& position_i, base::Vector3d const& gravity,
+                     base::Quaterniond& orientation_j, base::Vector3d& velocity_j,
+                     base::Vector3d& position_j) const;
+    };
+
+    /**
+     * Accumulates IMU readings into a PreintegratedIMU
+     *
+     * This is the on-manifold preintegration of Forster et al. (2015):
+     * each step uses the closed-form SO(3) exponential of the gyro reading,
+     * and propagates the covariance and the bias Jacobians to first order.
+     * The readings are assumed constant over each step.
+     *
+     * For a keyframe-based estimator, call getDelta() when a keyframe is
+     * created, and reset() to start the next interval. When samples are fed
+     * with timestamps (update, integrate(IMUSensorsBatch)), the last
+     * timestamp is kept across resets, so no time is lost between
+     * intervals.
+     */
+    class IMUPreintegrator
+    {
+    public:
+        /**
+         * @param gyro_noise_density white noise of the gyros, in rad/s/sqrt(Hz)
+         * @param acc_noise_density white noise of the accelerometers, in m/s^2/sqrt(Hz)
+         */
+        IMUPreintegrator(double gyro_noise_density, double acc_noise_density);
+
+        /** Starts a new interval, keeping the biases and the last sample time */
+        void reset();
+
+        /** Starts a new interval with new biases */
+        void reset(base::Vector3d const& bias_gyro, base::Vector3d const& bias_acc);
+
+        /** Forgets the time of the last sample, i.e. the next timestamped
+         * sample only sets the time */
+        void resetTime();
+
+        /** Integrates a reading over @a dt seconds */
+        void integrate(base::Vector3d const& acc, base::Vector3d const& gyro, double dt);
+
+        /** Integrates a sample over the time elapsed since the previous one
+         *
+         * If no sample has been received yet, only the time is set. Samples
+         * that are not newer than the previous one are ignored.
+         *
+         * @return true if the sample has been integrated
+         */
+        bool update(samples::IMUSensors const& sample);
+
+        /** Integrates all samples of a batch, as update() would do */
+        void integrate(samples::IMUSensorsBatch const& batch);
+
+        /** Returns the motion since the last reset */
+        PreintegratedIMU const& getDelta() const { return delta; }
+
+        /** Returns the time of the last sample given to update() or
+         * integrate(IMUSensorsBatch) */
+        base::Time const& getTime() const { return last_time; }
+
+        /** Closed-form exponential of SO(3) and its right Jacobian */
+        static void expSO3(Eigen::Vector3d const& phi, Eigen::Quaterniond& rotation,
+                           Eigen::Matrix3d& right_jacobian);
+
+    private:
+        double gyro_variance;
+        double acc_variance;
+        PreintegratedIMU delta;
+        base::Time last_time;
+    };
+
+} // namespaces
+
+#endif
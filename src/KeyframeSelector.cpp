@@ -0,0 +1,172 @@
+#include "KeyframeSelector.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace base {
+
+KeyframeSelector::KeyframeSelector(const PoseUpdateThreshold& threshold)
+    : threshold(threshold), revisit_detection(true)
+{
+    if (!(threshold.distance > 0))
+        throw std::invalid_argument("KeyframeSelector: the distance threshold must be strictly positive");
+    reset();
+}
+
+void KeyframeSelector::reset()
+{
+    keyframes.clear();
+    cells.clear();
+    current = 0;
+    sample_count = 0;
+}
+
+void KeyframeSelector::getCell(const base::Position& position, int64_t& x, int64_t& y, int64_t& z) const
+{
+    x = static_cast<int64_t>(std::floor(position.x() / threshold.distance));
+    y = static_cast<int64_t>(std::floor(position.y() / threshold.distance));
+    z = static_cast<int64_t>(std::floor(position.z() / threshold.distance));
+}
+
+uint64_t KeyframeSelector::getCellKey(int64_t x, int64_t y, int64_t z) const
+{
+    // 21 bits per axis. Cells that are 2^21 cells apart share a key, which
+    // is harmless as the candidates are tested anyway
+    const uint64_t mask = (1ull << 21) - 1;
+    return (static_cast<uint64_t>(x) & mask)
+        | ((static_cast<uint64_t>(y) & mask) << 21)
+        | ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+int KeyframeSelector::findKeyframe(const base::Position& position, const base::Orientation& orientation) const
+{
+    int64_t cx, cy, cz;
+    getCell(position, cx, cy, cz);
+
+    // the cells are as large as the distance threshold, so all candidates
+    // are in the neighbouring cells
+    int best = -1;
+    double best_distance = 0;
+    for (int64_t x = cx - 1; x <= cx + 1; ++x)
+    {
+        for (int64_t y = cy - 1; y <= cy + 1; ++y)
+        {
+            for (int64_t z = cz - 1; z <= cz + 1; ++z)
+            {
+                SpatialHash::const_iterator cell = cells.find(getCellKey(x, y, z));
+                if (cell == cells.end())
+                    continue;
+
+                for (size_t i = 0; i < cell->second.size(); ++i)
+                {
+                    const Keyframe& keyframe = keyframes[cell->second[i]];
+                    const double distance = (keyframe.position - position).norm();
+                    if (distance > threshold.distance || (best >= 0 && distance >= best_distance))
+                        continue;
+                    if (keyframe.orientation.angularDistance(orientation) > threshold.angle)
+                        continue;
+
+                    best = static_cast<int>(cell->second[i]);
+                    best_distance = distance;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+KeyframeSelector::Decision KeyframeSelector::update(const base::Time& time, const base::Position& position,
+                                                    const base::Orientation& orientation)
+{
+    const size_t sample_index = sample_count++;
+    if (!isnotnan(position) || !isnotnan(orientation.coeffs()))
+        return INVALID;
+
+    if (!keyframes.empty())
+    {
+        // same as PoseUpdateThreshold::test on the transforms, as the norm
+        // of the relative translation does not depend on the frame it is
+        // expressed in
+        const Keyframe& reference = keyframes[current];
+        if (!threshold.test((position - reference.position).norm(),
+                            reference.orientation.angularDistance(orientation)))
+            return SKIPPED;
+
+        if (revisit_detection)
+        {
+            int revisited = findKeyframe(position, orientation);
+            if (revisited >= 0)
+            {
+                current = revisited;
+                return REVISIT;
+            }
+        }
+    }
+
+    Keyframe keyframe;
+    keyframe.time = time;
+    keyframe.position = position;
+    keyframe.orientation = orientation;
+    keyframe.sample_index = sample_index;
+    current = keyframes.size();
+    keyframes.push_back(keyframe);
+
+    int64_t x, y, z;
+    getCell(position, x, y, z);
+    cells[getCellKey(x, y, z)].push_back(current);
+    return NEW_KEYFRAME;
+}
+
+KeyframeSelector::Decision KeyframeSelector::update(const samples::RigidBodyState& rbs)
+{
+    return update(rbs.time, rbs.position, rbs.orientation);
+}
+
+KeyframeSelector::Decision KeyframeSelector::update(const samples::BodyState& state)
+{
+    return update(state.time, state.pose.translation, state.pose.orientation);
+}
+
+size_t KeyframeSelector::select(const std::vector<samples::RigidBodyState>& samples,
+                                std::vector<samples::RigidBodyState>& keyframes)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        if (update(samples[i]) == NEW_KEYFRAME)
+        {
+            keyframes.push_back(samples[i]);
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t KeyframeSelector::select(const std::vector<samples::BodyState>& samples,
+                                std::vector<samples::BodyState>& keyframes)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        if (update(samples[i]) == NEW_KEYFRAME)
+        {
+            keyframes.push_back(samples[i]);
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t KeyframeSelector::getCurrentKeyframeIndex() const
+{
+    if (keyframes.empty())
+        throw std::out_of_range("KeyframeSelector: no keyframes");
+    return current;
+}
+
+const KeyframeSelector::Keyframe& KeyframeSelector::getCurrentKeyframe() const
+{
+    return keyframes[getCurrentKeyframeIndex()];
+}
+
+} // namespaces
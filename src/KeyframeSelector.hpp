@@ -0,0 +1,146 @@
+#ifndef __BASE_KEYFRAME_SELECTOR_HPP__
+#define __BASE_KEYFRAME_SELECTOR_HPP__
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include <base/Eigen.hpp>
+#include <base/Pose.hpp>
+#include <base/Time.hpp>
+#include <base/samples/RigidBodyState.hpp>
+#include <base/samples/BodyState.hpp>
+
+namespace base {
+
+    /**
+     * Decimates a stream of poses into keyframes
+     *
+     * A sample becomes a keyframe when its motion relative to the current
+     * keyframe exceeds the PoseUpdateThreshold, i.e. when either the
+     * distance or the rotation angle between them is greater than the
+     * threshold.
+     *
+     * Keyframes are indexed in a spatial hash whose cells are as large as the
+     * distance threshold. Before a new keyframe is created, the keyframes
+     * around the sample are searched: if one of them is within the
+     * threshold, the sample is a revisit of that keyframe, which becomes the
+     * current keyframe again instead of a new one being created. The number
+     * of keyframes therefore grows with the explored area, not with the
+     * length of the trajectory.
+     *
+     * Memory is only allocated when keyframes are created. Samples that are
+     * dropped cost a distance and an angle computation.
+     */
+    class KeyframeSelector
+    {
+    public:
+        struct Keyframe
+        {
+            base::Time time;
+            base::Position position;
+            base::Orientation orientation;
+            /** Index of the sample in the stream, counting all samples given
+             * to update since the last reset */
+            size_t sample_index;
+        };
+
+        enum Decision
+        {
+            /** The sample is within the threshold of the current keyframe */
+            SKIPPED,
+            /** The sample created a new keyframe */
+            NEW_KEYFRAME,
+            /** The sample is within the threshold of an older keyframe,
+             * which is now the current keyframe */
+            REVISIT,
+            /** The sample has no valid position or orientation */
+            INVALID
+        };
+
+        /**
+         * @param threshold the keyframe distance and angle thresholds. The
+         *   distance must be strictly positive.
+         * @throw std::invalid_argument if the distance threshold is not
+         *   strictly positive
+         */
+        explicit KeyframeSelector(const PoseUpdateThreshold& threshold);
+
+        /** Removes all keyframes */
+        void reset();
+
+        /** Enables or disables the revisit detection (enabled by default)
+         *
+         * Without it, a new keyframe is created each time the threshold is
+         * exceeded.
+         */
+        void setRevisitDetection(bool enable) { revisit_detection = enable; }
+
+        bool getRevisitDetection() const { return revisit_detection; }
+
+        const PoseUpdateThreshold& getThreshold() const { return threshold; }
+
+        /** Processes the next sample of the stream */
+        Decision update(const base::Time& time, const base::Position& position,
+                        const base::Orientation& orientation);
+
+        Decision update(const samples::RigidBodyState& rbs);
+
+        Decision update(const samples::BodyState& state);
+
+        /** Processes a batch of samples, and appends the ones that created
+         * a keyframe to @a keyframes
+         *
+         * @a keyframes is not cleared, so that its capacity can be reused
+         * across calls.
+         *
+         * @return the number of samples appended
+         */
+        size_t select(const std::vector<samples::RigidBodyState>& samples,
+                      std::vector<samples::RigidBodyState>& keyframes);
+
+        size_t select(const std::vector<samples::BodyState>& samples,
+                      std::vector<samples::BodyState>& keyframes);
+
+        /** Returns all keyframes, in creation order */
+        const std::vector<Keyframe>& getKeyframes() const { return keyframes; }
+
+        /** Returns the index of the current keyframe in getKeyframes()
+         *
+         * @throw std::out_of_range if there are no keyframes
+         */
+        size_t getCurrentKeyframeIndex() const;
+
+        /** Returns the current keyframe, i.e. the reference of the next
+         * threshold test
+         *
+         * @throw std::out_of_range if there are no keyframes
+         */
+        const Keyframe& getCurrentKeyframe() const;
+
+        /** Returns the index of the keyframe that is the closest to
+         * @a position among the ones within the threshold of the given pose,
+         * or -1 if there is none
+         */
+        int findKeyframe(const base::Position& position, const base::Orientation& orientation) const;
+
+        /** Returns the number of samples given to update since the last reset */
+        size_t getSampleCount() const { return sample_count; }
+
+    private:
+        typedef std::unordered_map<uint64_t, std::vector<size_t> > SpatialHash;
+
+        uint64_t getCellKey(int64_t x, int64_t y, int64_t z) const;
+        void getCell(const base::Position& position, int64_t& x, int64_t& y, int64_t& z) const;
+
+        PoseUpdateThreshold threshold;
+        bool revisit_detection;
+
+        std::vector<Keyframe> keyframes;
+        SpatialHash cells;
+        size_t current;
+        size_t sample_count;
+    };
+
+} // namespaces
+
+#endif
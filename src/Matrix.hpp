@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Eigen/Eigenvalues>
+#include <Eigen/Cholesky>
+#include <vector>
 
 namespace base {
     
@@ -27,6 +29,144 @@ static typename _MatrixType::PlainObject guaranteeSPD (const _MatrixType &A, con
 
     return spdA;
 };
+
+/**
+* Tests if a symmetric matrix is (semi-) positive definite, with all its
+* eigenvalues not smaller than minEig.
+* Only the lower triangular part is considered. 3x3 matrices are first tested
+* with the closed-form leading principal minors, which is enough for definite
+* matrices; other matrices, and 3x3 ones that fail this test, are tested with a
+* LDLT decomposition, which also handles semi-definite matrices.
+*/
+template <typename _MatrixType>
+static bool isSPD (const _MatrixType &A, const typename _MatrixType::RealScalar& minEig = 0.0)
+{
+    typedef typename _MatrixType::PlainObject Matrix;
+
+    Matrix shifted = A.template selfadjointView<Eigen::Lower>();
+    shifted.diagonal().array() -= minEig;
+
+    if (shifted.rows() == 3)
+    {
+        const typename Matrix::Scalar d1 = shifted(0,0);
+        const typename Matrix::Scalar d2 = shifted(0,0) * shifted(1,1) - shifted(1,0) * shifted(1,0);
+        if (d1 > 0 && d2 > 0 && shifted.determinant() > 0)
+            return true;
+    }
+
+    Eigen::LDLT<Matrix> ldlt(shifted);
+    return ldlt.info() == Eigen::Success && (ldlt.vectorD().array() >= 0).all();
+};
+
+/**
+* Result of sanitizeCovariance, i.e. which repair was necessary
+*/
+enum CovarianceRepair
+{
+    /** The matrix already was SPD, and has not been modified */
+    COVARIANCE_VALID,
+    /** A small multiple of the identity has been added to the matrix */
+    COVARIANCE_BOOSTED,
+    /** The eigenvalues of the matrix have been truncated (guaranteeSPD) */
+    COVARIANCE_PROJECTED,
+    /** The matrix has non-finite values, and has not been modified */
+    COVARIANCE_INVALID
+};
+
+/**
+* Makes a covariance matrix symmetric (semi-) positive definite, with all its
+* eigenvalues not smaller than minEig, at the lowest possible cost.
+*
+* Most covariances are already valid, so the repair is tiered:
+* - the matrix is tested with isSPD, and left unchanged if it passes
+* - otherwise, if adding at most maxRelativeBoost times the mean of its
+*   diagonal to the diagonal makes it pass, this is done. This inflates the
+*   covariance slightly, which is the conservative way to fix rounding errors.
+* - otherwise, the eigenvalues are truncated as in guaranteeSPD. 3x3 matrices
+*   use the closed-form eigen decomposition.
+*
+* Matrices with a non-finite value anywhere, including the upper triangular
+* part, are rejected. Otherwise only the lower triangular part is considered.
+* Repaired matrices are symmetric.
+*/
+template <typename _Derived>
+static CovarianceRepair sanitizeCovariance (Eigen::MatrixBase<_Derived> &A,
+        const typename _Derived::RealScalar& minEig = 0.0,
+        const typename _Derived::RealScalar& maxRelativeBoost = 1e-6)
+{
+    typedef typename _Derived::PlainObject Matrix;
+    typedef typename _Derived::RealScalar RealScalar;
+
+    if (!A.allFinite())
+        return COVARIANCE_INVALID;
+    if (isSPD(A, minEig))
+        return COVARIANCE_VALID;
+
+    Matrix sym = A.template selfadjointView<Eigen::Lower>();
+
+    // try boosts of 1e-6, 1e-3 and 1 times maxRelativeBoost
+    RealScalar scale = sym.diagonal().cwiseAbs().mean();
+    if (scale == 0)
+        scale = 1;
+    RealScalar boost = maxRelativeBoost * scale * 1e-6;
+    for (int i = 0; i < 3; ++i, boost *= 1e3)
+    {
+        if (isSPD(sym, minEig - boost))
+        {
+            sym.diagonal().array() += boost;
+            A = sym;
+            return COVARIANCE_BOOSTED;
+        }
+    }
+
+    // the eigen solver does not support unaligned fixed-size matrices
+    typedef Eigen::Matrix<typename Matrix::Scalar, Matrix::RowsAtCompileTime,
+            Matrix::ColsAtCompileTime> SolverMatrix;
+    Eigen::SelfAdjointEigenSolver<SolverMatrix> eig;
+    if (sym.rows() == 3)
+        eig.computeDirect(SolverMatrix(sym), Eigen::ComputeEigenvectors);
+    else
+        eig.compute(SolverMatrix(sym), Eigen::ComputeEigenvectors);
+    A = eig.eigenvectors() * eig.eigenvalues().cwiseMax(minEig).asDiagonal() * eig.eigenvectors().adjoint();
+    return COVARIANCE_PROJECTED;
+};
+
+/**
+* Counts of the repairs done by sanitizeCovariances
+*/
+struct CovarianceRepairStats
+{
+    size_t valid;
+    size_t boosted;
+    size_t projected;
+    size_t invalid;
+
+    CovarianceRepairStats()
+        : valid(0), boosted(0), projected(0), invalid(0) {}
+};
+
+/**
+* Applies sanitizeCovariance to an array of covariances (e.g. of Matrix3d or
+* Matrix6d)
+*/
+template <typename _MatrixType, typename _Alloc>
+static CovarianceRepairStats sanitizeCovariances (std::vector<_MatrixType, _Alloc> &covariances,
+        const typename _MatrixType::RealScalar& minEig = 0.0,
+        const typename _MatrixType::RealScalar& maxRelativeBoost = 1e-6)
+{
+    CovarianceRepairStats stats;
+    for (size_t i = 0; i < covariances.size(); ++i)
+    {
+        switch (sanitizeCovariance(covariances[i], minEig, maxRelativeBoost))
+        {
+            case COVARIANCE_VALID: ++stats.valid; break;
+            case COVARIANCE_BOOSTED: ++stats.boosted; break;
+            case COVARIANCE_PROJECTED: ++stats.projected; break;
+            case COVARIANCE_INVALID: ++stats.invalid; break;
+        }
+    }
+    return stats;
+};
     
     
     
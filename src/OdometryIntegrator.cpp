@@ -0,0 +1,153 @@
+#include "OdometryIntegrator.hpp"
+
+namespace base {
+
+OdometryIntegrator::OdometryIntegrator()
+{
+    reset(samples::BodyState::Unknown());
+}
+
+OdometryIntegrator::OdometryIntegrator(const samples::BodyState& initial)
+{
+    reset(initial);
+}
+
+void OdometryIntegrator::reset(const samples::BodyState& initial)
+{
+    position = initial.pose.translation;
+    orientation = initial.pose.orientation;
+    if (initial.pose.hasValidCovariance())
+        cov = initial.pose.cov;
+    else
+        cov.setZero();
+
+    last_twist = TwistWithCovariance::Zero();
+    time = initial.time;
+    last_output = initial.time;
+    has_output = false;
+    step_count = 0;
+}
+
+void OdometryIntegrator::expSE3(const Eigen::Vector3d& rho, const Eigen::Vector3d& phi,
+                                Eigen::Vector3d& translation, Eigen::Quaterniond& rotation)
+{
+    const double theta2 = phi.squaredNorm();
+    const double theta = std::sqrt(theta2);
+
+    // a = (1 - cos t) / t^2 and b = (t - sin t) / t^3 are the coefficients of
+    // the left Jacobian of SO(3). Use their Taylor expansion near zero.
+    double a, b, half_sinc;
+    if (theta < 1e-4)
+    {
+        a = 0.5 - theta2 / 24.0;
+        b = 1.0 / 6.0 - theta2 / 120.0;
+        half_sinc = 0.5 - theta2 / 48.0;
+        rotation.w() = 1.0 - theta2 / 8.0;
+    }
+    else
+    {
+        a = (1.0 - std::cos(theta)) / theta2;
+        b = (theta - std::sin(theta)) / (theta2 * theta);
+        half_sinc = std::sin(theta / 2) / theta;
+        rotation.w() = std::cos(theta / 2);
+    }
+    rotation.vec() = half_sinc * phi;
+
+    const Eigen::Vector3d phi_x_rho = phi.cross(rho);
+    translation = rho + a * phi_x_rho + b * phi.cross(phi_x_rho);
+}
+
+void OdometryIntegrator::integrate(const TwistWithCovariance& twist, double dt)
+{
+    const Eigen::Vector3d v(twist.vel), w(twist.rot);
+    Eigen::Vector3d delta_t;
+    Eigen::Quaterniond delta_q;
+    expSE3(v * dt, w * dt, delta_t, delta_q);
+
+    const Eigen::Quaterniond q(orientation);
+    const Eigen::Matrix3d R = q.toRotationMatrix();
+    const Eigen::Vector3d delta_p = R * delta_t;
+
+    // First-order propagation with F = [I -[delta_p]x; 0 I], done block-wise
+    // to avoid the full 6x6 products
+    const Eigen::Matrix3d S = -skew(delta_p);
+    const Eigen::Matrix3d Prr = cov.bottomRightCorner<3,3>();
+    const Eigen::Matrix3d Ptr = cov.topRightCorner<3,3>() + S * Prr;
+    cov.topLeftCorner<3,3>() += S * cov.bottomLeftCorner<3,3>()
+        + cov.topRightCorner<3,3>() * S.transpose() + S * Prr * S.transpose();
+    cov.topRightCorner<3,3>() = Ptr;
+    cov.bottomLeftCorner<3,3>() = Ptr.transpose();
+
+    if (twist.hasValidCovariance())
+    {
+        const Eigen::Matrix3d Rdt = R * dt;
+        cov.topLeftCorner<3,3>() += Rdt * twist.cov.topLeftCorner<3,3>() * Rdt.transpose();
+        cov.topRightCorner<3,3>() += Rdt * twist.cov.topRightCorner<3,3>() * Rdt.transpose();
+        cov.bottomLeftCorner<3,3>() += Rdt * twist.cov.bottomLeftCorner<3,3>() * Rdt.transpose();
+        cov.bottomRightCorner<3,3>() += Rdt * twist.cov.bottomRightCorner<3,3>() * Rdt.transpose();
+    }
+
+    position += delta_p;
+    orientation = (q * delta_q).normalized();
+    last_twist = twist;
+    ++step_count;
+}
+
+bool OdometryIntegrator::update(const base::Time& time, const TwistWithCovariance& twist)
+{
+    if (this->time.isNull())
+    {
+        this->time = time;
+        last_output = time;
+        last_twist = twist;
+        return false;
+    }
+    if (time <= this->time)
+        return false;
+
+    integrate(twist, (time - this->time).toSeconds());
+    this->time = time;
+    return true;
+}
+
+samples::BodyState OdometryIntegrator::getBodyState() const
+{
+    samples::BodyState state(false);
+    state.time = time;
+    state.pose = TransformWithCovariance(position, orientation, cov);
+
+    // same convention than BodyState::composition: the velocity is
+    // expressed in the target frame
+    const Eigen::Matrix3d R = Eigen::Quaterniond(orientation).toRotationMatrix();
+    state.velocity = last_twist;
+    state.velocity.vel = R * last_twist.vel;
+    state.velocity.rot = R * last_twist.rot;
+    if (last_twist.hasValidCovariance())
+    {
+        state.velocity.cov.topLeftCorner<3,3>() = R * last_twist.cov.topLeftCorner<3,3>() * R.transpose();
+        state.velocity.cov.topRightCorner<3,3>() = R * last_twist.cov.topRightCorner<3,3>() * R.transpose();
+        state.velocity.cov.bottomLeftCorner<3,3>() = R * last_twist.cov.bottomLeftCorner<3,3>() * R.transpose();
+        state.velocity.cov.bottomRightCorner<3,3>() = R * last_twist.cov.bottomRightCorner<3,3>() * R.transpose();
+    }
+    return state;
+}
+
+void OdometryIntegrator::setOutputPeriod(const base::Time& period)
+{
+    output_period = period;
+}
+
+bool OdometryIntegrator::pollOutput(samples::BodyState& state)
+{
+    if (has_output && time - last_output < output_period)
+        return false;
+    if (has_output && time == last_output)
+        return false;
+
+    has_output = true;
+    last_output = time;
+    state = getBodyState();
+    return true;
+}
+
+} //end namespace base
@@ -0,0 +1,118 @@
+#ifndef __BASE_ODOMETRY_INTEGRATOR_HPP__
+#define __BASE_ODOMETRY_INTEGRATOR_HPP__
+
+#include <base/Eigen.hpp>
+#include <base/Time.hpp>
+#include <base/TwistWithCovariance.hpp>
+#include <base/samples/BodyState.hpp>
+
+namespace base {
+
+    /**
+     * Integrates a stream of body-frame velocities (TwistWithCovariance)
+     * into a pose (BodyState)
+     *
+     * Each step applies the closed-form SE(3) exponential of the twist over
+     * the step duration, i.e. the motion is exact for a twist that is
+     * constant during the step. This is equivalent to composing the current
+     * state with a delta BodyState, but without building the 6x6 Jacobians
+     * of TransformWithCovariance::composition.
+     *
+     * The pose covariance uses the [translation orientation] ordering of
+     * TransformWithCovariance, with both errors expressed in the target
+     * frame. It is propagated incrementally with a first-order model:
+     * the translation error grows with the lever arm of the step, and the
+     * twist covariance is added after being rotated into the target frame.
+     *
+     * Integration always happens at the input rate. The state can
+     * nonetheless be emitted at a lower rate with setOutputPeriod and
+     * pollOutput, which does not affect the accuracy of the integration.
+     */
+    class OdometryIntegrator
+    {
+    public:
+        /** Starts at the identity, with a zero covariance */
+        OdometryIntegrator();
+
+        /** Starts at the given state
+         *
+         * @see reset
+         */
+        explicit OdometryIntegrator(const samples::BodyState& initial);
+
+        /** Restarts the integration from the given state
+         *
+         * If the pose covariance of @a initial is invalid, the integration
+         * starts with a zero covariance, i.e. the resulting covariance is
+         * the one of the motion since the reset.
+         */
+        void reset(const samples::BodyState& initial);
+
+        /** Integrates @a twist over @a dt seconds
+         *
+         * The twist is expressed in the body frame. If it has no valid
+         * covariance, the pose covariance is only transported, not
+         * increased.
+         */
+        void integrate(const TwistWithCovariance& twist, double dt);
+
+        /** Integrates @a twist over the time elapsed since the last call to
+         * update (or since the time of the state given to reset)
+         *
+         * The twist is assumed to be the mean velocity over that interval,
+         * which is what odometry computed from encoder deltas provides. If
+         * no reference time is known yet, the state time is set and nothing
+         * is integrated. Samples older than the current state are ignored.
+         *
+         * @return true if the twist has been integrated
+         */
+        bool update(const base::Time& time, const TwistWithCovariance& twist);
+
+        /** Returns the current state
+         *
+         * As in BodyState::composition, the velocity is the last integrated
+         * twist expressed in the target frame.
+         */
+        samples::BodyState getBodyState() const;
+
+        /** Sets the period at which pollOutput returns a new state
+         *
+         * A null period (the default) makes pollOutput return every state.
+         */
+        void setOutputPeriod(const base::Time& period);
+
+        const base::Time& getOutputPeriod() const { return output_period; }
+
+        /** Returns true, and sets @a state, if at least one output period
+         * elapsed since the last state returned by pollOutput
+         */
+        bool pollOutput(samples::BodyState& state);
+
+        /** Returns the number of integration steps since the last reset */
+        size_t getStepCount() const { return step_count; }
+
+        /** Closed-form exponential of a body-frame twist
+         *
+         * Computes the motion ( @a translation, @a rotation ) of a body that
+         * moves during a unit time with the constant linear velocity @a rho
+         * and angular velocity @a phi, both expressed in the body frame.
+         */
+        static void expSE3(const Eigen::Vector3d& rho, const Eigen::Vector3d& phi,
+                           Eigen::Vector3d& translation, Eigen::Quaterniond& rotation);
+
+    private:
+        base::Vector3d position;
+        base::Quaterniond orientation;
+        base::Matrix6d cov;
+
+        TwistWithCovariance last_twist;
+        base::Time time;
+        base::Time last_output;
+        base::Time output_period;
+        bool has_output;
+        size_t step_count;
+    };
+
+} // namespaces
+
+#endif
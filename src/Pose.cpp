@@ -1,11 +1,45 @@
 #include "Pose.hpp"
 
+#include <limits>
+
 namespace base 
 {
 
+namespace
+{
+    typedef Eigen::Array<double, 1, Eigen::Dynamic> AngleArray;
+
+    struct Atan2
+    {
+        double operator()(double y, double x) const { return ::atan2(y, x); }
+    };
+
+    /** Branch-free polynomial approximation of atan2, with an absolute error
+     * below 2e-5 rad
+     */
+    AngleArray atan2Approx(AngleArray const& y, AngleArray const& x)
+    {
+        const AngleArray ax = x.abs(), ay = y.abs();
+        const AngleArray a = ax.min(ay) / (ax.max(ay) + std::numeric_limits<double>::min());
+        const AngleArray s = a * a;
+        // Abramowitz & Stegun 4.4.49, valid for a in [0, 1]
+        AngleArray r = a * (0.9998660 + s * (-0.3302995 + s * (0.1801410 + s * (-0.0851330 + s * 0.0208351))));
+        r = (ay > ax).select(M_PI_2 - r, r);
+        r = (x < 0).select(M_PI - r, r);
+        return (y < 0).select(-r, r);
+    }
+
+    AngleArray atan2(AngleArray const& y, AngleArray const& x, EulerPrecision precision)
+    {
+        if (precision == EULER_APPROXIMATE)
+            return atan2Approx(y, x);
+        return y.binaryExpr(x, Atan2());
+    }
+}
+
 Vector3d getEuler(const Orientation& orientation)
 {
-    const Eigen::Matrix3d m = orientation.toRotationMatrix();
+    const aligned::Matrix3d m = toAligned(orientation).toRotationMatrix();
     double x = Vector2d(m.coeff(2,2) , m.coeff(2,1)).norm();
     Vector3d res(0,::atan2(-m.coeff(2,0), x),0);
     if (x > Eigen::NumTraits<double>::dummy_precision()){
@@ -33,6 +67,83 @@ Vector3d getEuler(const AngleAxisd& orientation)
     return res;
 }
 
+void getEuler(Eigen::Ref< const Eigen::Matrix<double, 4, Eigen::Dynamic> > const& orientations,
+              Eigen::Ref< Eigen::Matrix<double, 3, Eigen::Dynamic> > euler,
+              EulerPrecision precision)
+{
+    const AngleArray x = orientations.row(0).array();
+    const AngleArray y = orientations.row(1).array();
+    const AngleArray z = orientations.row(2).array();
+    const AngleArray w = orientations.row(3).array();
+
+    // the terms of the rotation matrix that getEuler uses, see
+    // Eigen::Quaternion::toRotationMatrix
+    const AngleArray m00 = 1 - 2 * (y * y + z * z);
+    const AngleArray m01 = 2 * (x * y - w * z);
+    const AngleArray m10 = 2 * (x * y + w * z);
+    const AngleArray m11 = 1 - 2 * (x * x + z * z);
+    const AngleArray m20 = 2 * (x * z - w * y);
+    const AngleArray m21 = 2 * (y * z + w * x);
+    const AngleArray m22 = 1 - 2 * (x * x + y * y);
+
+    const AngleArray c = (m22 * m22 + m21 * m21).sqrt();
+    const Eigen::Array<bool, 1, Eigen::Dynamic> gimbal_lock =
+        c <= Eigen::NumTraits<double>::dummy_precision();
+
+    euler.row(0) = gimbal_lock.select(0, atan2(m10, m00, precision)).matrix();
+    euler.row(1) = atan2(-m20, c, precision).matrix();
+    const AngleArray gimbal_sign = (m20 > 0).select(AngleArray::Ones(m20.size()), -1);
+    euler.row(2) = gimbal_lock.select(
+        gimbal_sign * atan2(-m01, m11, precision),
+        atan2(m21, m22, precision)).matrix();
+}
+
+std::vector<Vector3d> getEuler(const std::vector<Orientation>& orientations, EulerPrecision precision)
+{
+    std::vector<Vector3d> result(orientations.size());
+    if (orientations.empty())
+        return result;
+
+    Eigen::Map< const Eigen::Matrix<double, 4, Eigen::Dynamic> >
+        q(orientations.front().coeffs().data(), 4, orientations.size());
+    Eigen::Map< Eigen::Matrix<double, 3, Eigen::Dynamic> >
+        euler(result.front().data(), 3, result.size());
+    getEuler(q, euler, precision);
+    return result;
+}
+
+void getYaw(Eigen::Ref< const Eigen::Matrix<double, 4, Eigen::Dynamic> > const& orientations,
+            Eigen::Ref< Eigen::VectorXd > yaw,
+            EulerPrecision precision)
+{
+    const AngleArray x = orientations.row(0).array();
+    const AngleArray y = orientations.row(1).array();
+    const AngleArray z = orientations.row(2).array();
+    const AngleArray w = orientations.row(3).array();
+
+    const AngleArray m00 = 1 - 2 * (y * y + z * z);
+    const AngleArray m10 = 2 * (x * y + w * z);
+    const AngleArray m21 = 2 * (y * z + w * x);
+    const AngleArray m22 = 1 - 2 * (x * x + y * y);
+
+    const Eigen::Array<bool, 1, Eigen::Dynamic> gimbal_lock =
+        (m22 * m22 + m21 * m21).sqrt() <= Eigen::NumTraits<double>::dummy_precision();
+    yaw = gimbal_lock.select(0, atan2(m10, m00, precision)).matrix().transpose();
+}
+
+std::vector<double> getYaw(const std::vector<Orientation>& orientations, EulerPrecision precision)
+{
+    std::vector<double> result(orientations.size());
+    if (orientations.empty())
+        return result;
+
+    Eigen::Map< const Eigen::Matrix<double, 4, Eigen::Dynamic> >
+        q(orientations.front().coeffs().data(), 4, orientations.size());
+    Eigen::Map< Eigen::VectorXd > yaw(&result.front(), result.size());
+    getYaw(q, yaw, precision);
+    return result;
+}
+
 double getYaw(const Orientation& orientation)
 {
     return getEuler(orientation)[0];
@@ -65,7 +176,7 @@ double getRoll(const AngleAxisd& orientation)
 
 Orientation removeYaw(const Orientation& orientation)
 {
-    return Eigen::AngleAxisd( -getYaw(orientation), Eigen::Vector3d::UnitZ()) * orientation;
+    return Orientation(Eigen::AngleAxisd( -getYaw(orientation), Eigen::Vector3d::UnitZ()) * toAligned(orientation));
 }
 
 Orientation removeYaw(const AngleAxisd& orientation)
@@ -75,7 +186,7 @@ Orientation removeYaw(const AngleAxisd& orientation)
 
 Orientation removePitch(const Orientation& orientation)
 {
-    return Eigen::AngleAxisd( -getPitch(orientation), Eigen::Vector3d::UnitY()) * orientation;
+    return Orientation(Eigen::AngleAxisd( -getPitch(orientation), Eigen::Vector3d::UnitY()) * toAligned(orientation));
 }
 
 Orientation removePitch(const AngleAxisd& orientation)
@@ -85,7 +196,7 @@ Orientation removePitch(const AngleAxisd& orientation)
 
 Orientation removeRoll(const Orientation& orientation)
 {
-    return Eigen::AngleAxisd( -getRoll(orientation), Eigen::Vector3d::UnitX()) * orientation;
+    return Orientation(Eigen::AngleAxisd( -getRoll(orientation), Eigen::Vector3d::UnitX()) * toAligned(orientation));
 }
 
 Orientation removeRoll(const AngleAxisd& orientation)
@@ -114,7 +225,8 @@ bool PoseUpdateThreshold::test( const Eigen::Affine3d& pdelta )
 
 bool PoseUpdateThreshold::test(const Eigen::Affine3d& a2b, const Eigen::Affine3d& aprime2b)
 {
-    return test( a2b.inverse() * aprime2b );
+    // poses are rigid transformations, which avoids the general 3x3 inverse
+    return test( a2b.inverse(Eigen::Isometry) * aprime2b );
 }
 
 
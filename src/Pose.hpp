@@ -4,6 +4,8 @@
 #include "Eigen.hpp"
 #include "Angle.hpp"
 
+#include <vector>
+
 namespace base
 {
     /** Pose in a 3D-Space **/
@@ -53,6 +55,53 @@ namespace base
 
     double getRoll(const base::AngleAxisd& orientation);
 
+    /** Precision of the bulk Euler angle extraction functions */
+    enum EulerPrecision
+    {
+        /** Same results than getEuler */
+        EULER_EXACT,
+        /** Uses a polynomial approximation of atan2, whose absolute error is
+         * below 2e-5 rad. It does not call any libm function, which allows
+         * the computation to be vectorized completely.
+         */
+        EULER_APPROXIMATE
+    };
+
+    /**
+     * Bulk version of getEuler
+     *
+     * The rotation matrix terms are computed once for all orientations, and
+     * the angles are extracted with array operations.
+     *
+     * @param orientations 4xN matrix of quaternion coefficients, in the
+     *   (x, y, z, w) order of Eigen::Quaternion::coeffs()
+     * @param euler 3xN matrix receiving the (yaw, pitch, roll) angles. It
+     *   must already have the right size.
+     */
+    void getEuler(Eigen::Ref< const Eigen::Matrix<double, 4, Eigen::Dynamic> > const& orientations,
+                  Eigen::Ref< Eigen::Matrix<double, 3, Eigen::Dynamic> > euler,
+                  EulerPrecision precision = EULER_EXACT);
+
+    /** Bulk version of getEuler for a set of orientations */
+    std::vector<base::Vector3d> getEuler(const std::vector<base::Orientation>& orientations,
+                                         EulerPrecision precision = EULER_EXACT);
+
+    /**
+     * Bulk version of getYaw
+     *
+     * @param orientations 4xN matrix of quaternion coefficients, in the
+     *   (x, y, z, w) order of Eigen::Quaternion::coeffs()
+     * @param yaw vector receiving the yaw angles. It must already have the
+     *   right size.
+     */
+    void getYaw(Eigen::Ref< const Eigen::Matrix<double, 4, Eigen::Dynamic> > const& orientations,
+                Eigen::Ref< Eigen::VectorXd > yaw,
+                EulerPrecision precision = EULER_EXACT);
+
+    /** Bulk version of getYaw for a set of orientations */
+    std::vector<double> getYaw(const std::vector<base::Orientation>& orientations,
+                               EulerPrecision precision = EULER_EXACT);
+
     base::Orientation removeYaw(const base::Orientation& orientation);
 
     base::Orientation removeYaw(const base::AngleAxisd& orientation);
@@ -0,0 +1,90 @@
+#ifndef __BASE_POSE_T_HH__
+#define __BASE_POSE_T_HH__
+
+#include <base/Eigen.hpp>
+#include <base/Pose.hpp>
+
+namespace base
+{
+    /**
+     * @brief Pose with a configurable scalar type
+     *
+     * Same representation than Pose, for pipelines that store many poses and
+     * are limited by memory bandwidth, where single precision halves the
+     * storage. Pose itself stays a plain double type, as it is part of the
+     * interface of many components.
+     *
+     * All conversions between precisions are explicit: use the converting
+     * constructors, cast<>() or toPose().
+     */
+    template<typename _Scalar>
+    struct PoseT
+    {
+        typedef _Scalar Scalar;
+        typedef Eigen::Matrix<Scalar, 3, 1, Eigen::DontAlign> Position;
+        typedef Eigen::Quaternion<Scalar, Eigen::DontAlign> Orientation;
+        typedef Eigen::Transform<Scalar, 3, Eigen::Affine> Transform;
+
+        Position    position;
+        Orientation orientation;
+
+        /**
+         * @brief Default constructor will initialize to zero
+         */
+        PoseT()
+            : position(Position::Zero()), orientation(Orientation::Identity()) {}
+
+        PoseT(Position const& p, Orientation const& o)
+            : position(p), orientation(o) {}
+
+        /** Converts from another precision */
+        template<typename OtherScalar>
+        explicit PoseT(PoseT<OtherScalar> const& other)
+            : position(other.position.template cast<Scalar>())
+            , orientation(other.orientation.template cast<Scalar>()) {}
+
+        /** Converts from a Pose */
+        explicit PoseT(base::Pose const& pose)
+            : position(pose.position.template cast<Scalar>())
+            , orientation(pose.orientation.template cast<Scalar>()) {}
+
+        /** Converts to another precision */
+        template<typename OtherScalar>
+        PoseT<OtherScalar> cast() const
+        {
+            return PoseT<OtherScalar>(*this);
+        }
+
+        /** Converts to a Pose */
+        base::Pose toPose() const
+        {
+            return base::Pose(position.template cast<double>(),
+                    orientation.template cast<double>());
+        }
+
+        /**
+         * @brief set the pose based on a 4x4 matrix
+         */
+        void fromTransform(Transform const& t)
+        {
+            position = t.translation();
+            orientation = t.linear();
+        }
+
+        /**
+         * @brief transform matrix which represents the pose transform as a 4x4
+         *  homogenous matrix
+         */
+        Transform toTransform() const
+        {
+            Transform t;
+            t = orientation;
+            t.pretranslate(position);
+            return t;
+        }
+    };
+
+    typedef PoseT<float> Posef;
+}
+
+#endif
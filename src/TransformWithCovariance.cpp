@@ -35,17 +35,18 @@ TransformWithCovariance TransformWithCovariance::compositionInv(const TransformW
     Eigen::Quaterniond q( q2 * q1 );
 
     // initialize resulting covariance
-    Eigen::Matrix<double,6,6> cov = Eigen::Matrix<double,6,6>::Zero();
+    aligned::Matrix6d cov = aligned::Matrix6d::Zero();
 
-    Eigen::Matrix<double,6,6> J1;
+    aligned::Matrix6d J1;
     J1 << q2.toRotationMatrix(), Eigen::Matrix3d::Zero(),
     Eigen::Matrix3d::Zero(), dr2r1_by_r1(q, q1, q2);
 
-    Eigen::Matrix<double,6,6> J2;
+    aligned::Matrix6d J2;
     J2 << Eigen::Matrix3d::Identity(), drx_by_dr(q2, t1.translation),
     Eigen::Matrix3d::Zero(), dr2r1_by_r2(q, q1, q2);
 
-    cov = J2.inverse() * ( tf.getCovariance() - J1 * t1.getCovariance() * J1.transpose() ) * J2.transpose().inverse();
+    const aligned::Matrix6d cov1( t1.getCovariance() ), covf( tf.getCovariance() );
+    cov = J2.inverse() * ( covf - J1 * cov1 * J1.transpose() ) * J2.transpose().inverse();
 
     // and return the resulting uncertainty transform
     return TransformWithCovariance( p2, q2, cov );
@@ -69,17 +70,18 @@ TransformWithCovariance TransformWithCovariance::preCompositionInv(const Transfo
     Eigen::Quaterniond q( q2 * q1 );
 
     // initialize resulting covariance
-    Eigen::Matrix<double,6,6> cov = Eigen::Matrix<double,6,6>::Zero();
+    aligned::Matrix6d cov = aligned::Matrix6d::Zero();
 
-    Eigen::Matrix<double,6,6> J1;
-    J1 << t2.getTransform().linear(), Eigen::Matrix3d::Zero(),
+    aligned::Matrix6d J1;
+    J1 << q2.toRotationMatrix(), Eigen::Matrix3d::Zero(),
     Eigen::Matrix3d::Zero(), dr2r1_by_r1(q, q1, q2);
 
-    Eigen::Matrix<double,6,6> J2;
+    aligned::Matrix6d J2;
     J2 << Eigen::Matrix3d::Identity(), drx_by_dr(q2, p1),
     Eigen::Matrix3d::Zero(), dr2r1_by_r2(q, q1, q2);
 
-    cov = J1.inverse() * ( tf.getCovariance() - J2 * t2.getCovariance() * J2.transpose() ) * J1.transpose().inverse();
+    const aligned::Matrix6d cov2( t2.getCovariance() ), covf( tf.getCovariance() );
+    cov = J1.inverse() * ( covf - J2 * cov2 * J2.transpose() ) * J1.transpose().inverse();
 
     // and return the resulting uncertainty transform
     return TransformWithCovariance( p1, q1, cov );
@@ -91,57 +93,58 @@ TransformWithCovariance TransformWithCovariance::operator*(const TransformWithCo
     const TransformWithCovariance &t2(*this);
     const TransformWithCovariance &t1(trans);
 
-    const Quaterniond t(t2.orientation * t1.orientation);
-    const Position p(t2.translation + (t2.orientation * t1.translation));
+    // convert the orientations of the respective transforms into quaternions
+    const aligned::Quaterniond q1( toAligned(t1.orientation) ), q2( toAligned(t2.orientation) );
+    const aligned::Quaterniond q( q2 * q1 );
+    const aligned::Vector3d p( toAligned(t2.translation) + q2 * toAligned(t1.translation) );
 
     // short path if there is no uncertainty 
     if( !t1.hasValidCovariance() && !t2.hasValidCovariance() )
     {
-        return TransformWithCovariance(p, t);
+        return TransformWithCovariance(p, q);
     }
 
-    // convert the orientations of the respective transforms into quaternions
-    const Eigen::Quaterniond q1( t1.orientation ), q2( t2.orientation );
-    const Eigen::Quaterniond q( t2.orientation * t1.orientation );
-
     // initialize resulting covariance
-    Eigen::Matrix<double,6,6> cov = Eigen::Matrix<double,6,6>::Zero();
+    aligned::Matrix6d cov = aligned::Matrix6d::Zero();
 
     // calculate the Jacobians (this is what all the above functions are for)
     // and add to the resulting covariance
     if( t1.hasValidCovariance() )
     {
-        Eigen::Matrix<double,6,6> J1;
-        J1 << t2.getTransform().linear(), Eigen::Matrix3d::Zero(),
+        aligned::Matrix6d J1;
+        J1 << q2.toRotationMatrix(), Eigen::Matrix3d::Zero(),
         Eigen::Matrix3d::Zero(), dr2r1_by_r1(q, q1, q2);
 
-        cov += J1*t1.getCovariance()*J1.transpose();
+        const aligned::Matrix6d cov1( t1.getCovariance() );
+        cov += J1*cov1*J1.transpose();
     }
 
     if( t2.hasValidCovariance() )
     {
-        Eigen::Matrix<double,6,6> J2;
+        aligned::Matrix6d J2;
         J2 << Eigen::Matrix3d::Identity(), drx_by_dr(q2, t1.translation),
         Eigen::Matrix3d::Zero(), dr2r1_by_r2(q, q1, q2);
 
-        cov += J2*t2.getCovariance()*J2.transpose();
+        const aligned::Matrix6d cov2( t2.getCovariance() );
+        cov += J2*cov2*J2.transpose();
     }
 
     // and return the resulting uncertainty transform
-    return TransformWithCovariance(p, t, cov);
+    return TransformWithCovariance(p, q, cov);
 }
 
 std::pair<Eigen::Vector3d, Eigen::Matrix3d> TransformWithCovariance::composePointWithCovariance(const Eigen::Vector3d& point, const Eigen::Matrix3d& cov) const
 {
-    Eigen::Matrix3d R( getTransform().linear() );
-    Eigen::Quaterniond q( R );
+    const aligned::Quaterniond q( toAligned(orientation) );
+    const aligned::Matrix3d R( q.toRotationMatrix() );
     Eigen::Matrix<double,3,6> J;
     J << Eigen::Matrix3d::Identity(), drx_by_dr( q, point );
 
-    Eigen::Matrix3d tr_point_cov = J*getCovariance()*J.transpose();
+    const aligned::Matrix6d transform_cov( getCovariance() );
+    Eigen::Matrix3d tr_point_cov = J*transform_cov*J.transpose();
     tr_point_cov += R*cov*R.transpose();
 
-    return std::make_pair(getTransform() * point, tr_point_cov);
+    return std::make_pair(Eigen::Vector3d(R * point + translation), tr_point_cov);
 }
 
 TransformWithCovariance TransformWithCovariance::inverse() const
@@ -150,15 +153,16 @@ TransformWithCovariance TransformWithCovariance::inverse() const
     if( !hasValidCovariance() )
         return TransformWithCovariance(static_cast<Position>(-(this->orientation.inverse() * this->translation)), this->orientation.inverse());
 
-    Eigen::Quaterniond q(this->orientation);
-    Eigen::Vector3d t(this->translation);
-    Eigen::Matrix<double,6,6> J;
+    const aligned::Quaterniond q( toAligned(this->orientation) );
+    const aligned::Vector3d t( this->translation );
+    aligned::Matrix6d J;
     J << q.toRotationMatrix().transpose(), drx_by_dr( q.inverse(), t ),
     Eigen::Matrix3d::Zero(), Eigen::Matrix3d::Identity();
 
-    return TransformWithCovariance(static_cast<Position>(-(this->orientation.inverse() * this->translation)),
-                                this->orientation.inverse(),
-                                J*this->getCovariance()*J.transpose());
+    const aligned::Matrix6d cov( this->getCovariance() );
+    return TransformWithCovariance(static_cast<Position>(-(q.inverse() * t)),
+                                static_cast<Quaterniond>(q.inverse()),
+                                static_cast<Covariance>(J*cov*J.transpose()));
 }
 
 Eigen::Quaterniond TransformWithCovariance::r_to_q(const Eigen::Vector3d& r)
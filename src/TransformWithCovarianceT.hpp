@@ -0,0 +1,143 @@
+#ifndef __BASE_TRANSFORM_WITH_COVARIANCE_T_HPP__
+#define __BASE_TRANSFORM_WITH_COVARIANCE_T_HPP__
+
+#include <base/Eigen.hpp>
+#include <base/Float.hpp>
+#include <base/PoseT.hpp>
+#include <base/TransformWithCovariance.hpp>
+
+namespace base {
+
+    /**
+     * Storage counterpart of TransformWithCovariance with a configurable
+     * scalar type
+     *
+     * It has the same [translation orientation] representation and
+     * covariance convention than TransformWithCovariance, and is meant to
+     * store large amounts of transformations in single precision
+     * (TransformWithCovariancef). TransformWithCovariance itself stays a
+     * plain double type, as it is part of the interface of many components.
+     *
+     * The uncertainty propagation is done in double precision: composition
+     * and inversion convert to TransformWithCovariance, compute, and convert
+     * the result back. Apart from that, all conversions between precisions
+     * are explicit.
+     */
+    template<typename _Scalar>
+    class TransformWithCovarianceT
+    {
+    public:
+        typedef _Scalar Scalar;
+        typedef Eigen::Matrix<Scalar, 3, 1, Eigen::DontAlign> Position;
+        typedef Eigen::Quaternion<Scalar, Eigen::DontAlign> Orientation;
+        typedef Eigen::Matrix<Scalar, 6, 6, Eigen::DontAlign> Covariance;
+
+        Position translation;
+
+        Orientation orientation;
+
+        /** The uncertainty, see TransformWithCovariance::cov */
+        Covariance cov;
+
+    public:
+        TransformWithCovarianceT()
+            : translation(Position::Zero()), orientation(Orientation::Identity())
+        {
+            invalidateCovariance();
+        }
+
+        TransformWithCovarianceT(Position const& translation, Orientation const& orientation)
+            : translation(translation), orientation(orientation)
+        {
+            invalidateCovariance();
+        }
+
+        TransformWithCovarianceT(Position const& translation, Orientation const& orientation, Covariance const& cov)
+            : translation(translation), orientation(orientation), cov(cov) {}
+
+        /** Converts from another precision */
+        template<typename OtherScalar>
+        explicit TransformWithCovarianceT(TransformWithCovarianceT<OtherScalar> const& other)
+            : translation(other.translation.template cast<Scalar>())
+            , orientation(other.orientation.template cast<Scalar>())
+            , cov(other.cov.template cast<Scalar>()) {}
+
+        /** Converts from a TransformWithCovariance */
+        explicit TransformWithCovarianceT(TransformWithCovariance const& other)
+            : translation(other.translation.template cast<Scalar>())
+            , orientation(other.orientation.template cast<Scalar>())
+            , cov(other.cov.template cast<Scalar>()) {}
+
+        static TransformWithCovarianceT Identity()
+        {
+            return TransformWithCovarianceT();
+        }
+
+        /** Converts to another precision */
+        template<typename OtherScalar>
+        TransformWithCovarianceT<OtherScalar> cast() const
+        {
+            return TransformWithCovarianceT<OtherScalar>(*this);
+        }
+
+        /** Converts to a TransformWithCovariance */
+        TransformWithCovariance toTransformWithCovariance() const
+        {
+            return TransformWithCovariance(
+                    base::Position(translation.template cast<double>()),
+                    base::Quaterniond(orientation.template cast<double>()),
+                    TransformWithCovariance::Covariance(cov.template cast<double>()));
+        }
+
+        PoseT<Scalar> getPose() const
+        {
+            return PoseT<Scalar>(translation, orientation);
+        }
+
+        Eigen::Transform<Scalar, 3, Eigen::Affine> getTransform() const
+        {
+            return getPose().toTransform();
+        }
+
+        /** Composition, with result = this * trans
+         *
+         * @see TransformWithCovariance::composition
+         */
+        TransformWithCovarianceT operator*(TransformWithCovarianceT const& trans) const
+        {
+            return TransformWithCovarianceT(toTransformWithCovariance() * trans.toTransformWithCovariance());
+        }
+
+        /** @see TransformWithCovariance::inverse */
+        TransformWithCovarianceT inverse() const
+        {
+            return TransformWithCovarianceT(toTransformWithCovariance().inverse());
+        }
+
+        bool hasValidTransform() const
+        {
+            return !translation.hasNaN() && !orientation.coeffs().hasNaN();
+        }
+
+        void invalidateTransform()
+        {
+            translation = Position::Ones() * NaN<Scalar>();
+            orientation.coeffs().setConstant(NaN<Scalar>());
+        }
+
+        bool hasValidCovariance() const
+        {
+            return !cov.hasNaN();
+        }
+
+        void invalidateCovariance()
+        {
+            cov = Covariance::Ones() * NaN<Scalar>();
+        }
+    };
+
+    typedef TransformWithCovarianceT<float> TransformWithCovariancef;
+
+} // namespaces
+
+#endif
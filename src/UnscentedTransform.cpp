@@ -0,0 +1,237 @@
+#include "UnscentedTransform.hpp"
+#include <stdexcept>
+#include <cmath>
+
+namespace base {
+
+UnscentedTransform::UnscentedTransform(double alpha, double beta, double kappa)
+    : alpha(alpha), beta(beta), kappa(kappa)
+{
+    if (alpha <= 0)
+        throw std::invalid_argument("UnscentedTransform: alpha must be strictly positive");
+}
+
+double UnscentedTransform::getLambda(int n) const
+{
+    return alpha * alpha * (n + kappa) - n;
+}
+
+double UnscentedTransform::getMeanWeight0(int n) const
+{
+    const double lambda = getLambda(n);
+    return lambda / (n + lambda);
+}
+
+double UnscentedTransform::getCovarianceWeight0(int n) const
+{
+    return getMeanWeight0(n) + 1 - alpha * alpha + beta;
+}
+
+double UnscentedTransform::getWeight(int n) const
+{
+    return 1.0 / (2 * (n + getLambda(n)));
+}
+
+double UnscentedTransform::getScale(int n) const
+{
+    const double s = n + getLambda(n);
+    if (s <= 0)
+        throw std::invalid_argument("UnscentedTransform: alpha and kappa lead to a non-positive sigma point spread");
+    return std::sqrt(s);
+}
+
+Eigen::Quaterniond UnscentedTransform::rotationVectorToQuaternion(const Eigen::Vector3d& r)
+{
+    const double theta2 = r.squaredNorm();
+    const double theta = std::sqrt(theta2);
+
+    // use the Taylor expansion of sin(t/2)/t near zero, so that small
+    // perturbations are not lost
+    Eigen::Quaterniond q;
+    if (theta < 1e-4)
+    {
+        q.w() = 1.0 - theta2 / 8.0;
+        q.vec() = (0.5 - theta2 / 48.0) * r;
+    }
+    else
+    {
+        q.w() = std::cos(theta / 2);
+        q.vec() = std::sin(theta / 2) / theta * r;
+    }
+    return q;
+}
+
+Eigen::Vector3d UnscentedTransform::quaternionToRotationVector(const Eigen::Quaterniond& q)
+{
+    // q and -q are the same rotation, use the one with the smallest angle
+    const double sign = q.w() < 0 ? -1.0 : 1.0;
+    const Eigen::Vector3d v = sign * q.vec();
+    const double w = sign * q.w();
+    const double n = v.norm();
+    if (n < 1e-10)
+        return 2.0 / w * v;
+    return 2.0 * std::atan2(n, w) / n * v;
+}
+
+Eigen::Matrix<double, 6, 1> UnscentedTransform::toVector(const Eigen::Affine3d& pose)
+{
+    Eigen::Matrix<double, 6, 1> result;
+    result.head<3>() = pose.translation();
+    result.tail<3>() = quaternionToRotationVector(Eigen::Quaterniond(pose.linear()));
+    return result;
+}
+
+void UnscentedTransform::alignRotationVectors(Eigen::Matrix<double, 6, 13>& Y)
+{
+    // r and r * (1 - 2 PI / |r|) are the same rotation. Pick the one closest
+    // to the rotation vector of the mean, so that the sigma points do not
+    // wrap around when the mean is close to a rotation of PI
+    const Eigen::Vector3d r0 = Y.col(0).tail<3>();
+    for (int i = 1; i < Y.cols(); ++i)
+    {
+        const Eigen::Vector3d r = Y.col(i).tail<3>();
+        const double theta = r.norm();
+        if (theta < 1e-10)
+            continue;
+        const Eigen::Vector3d other = r * (1 - 2 * M_PI / theta);
+        if ((other - r0).squaredNorm() < (r - r0).squaredNorm())
+            Y.col(i).tail<3>() = other;
+    }
+}
+
+UnscentedTransform::PoseSigmaPoints UnscentedTransform::computeSigmaPoints(
+        const TransformWithCovariance& transform, int augmented_dimension) const
+{
+    const int n = 6 + augmented_dimension;
+    Eigen::Matrix<double, 6, 6> S = Eigen::Matrix<double, 6, 6>::Zero();
+    if (transform.hasValidCovariance())
+        S = matrixSqrt(Eigen::Matrix<double, 6, 6>(transform.getCovariance())) * getScale(n);
+
+    const Eigen::Vector3d t0(transform.translation);
+    const Eigen::Vector3d r0 = quaternionToRotationVector(Eigen::Quaterniond(transform.orientation));
+
+    PoseSigmaPoints sigma;
+    sigma.dimension = n;
+    sigma.translations.resize(13);
+    sigma.orientations.resize(13);
+    sigma.rotations.resize(13);
+
+    sigma.translations[0] = t0;
+    sigma.orientations[0] = transform.orientation;
+    for (int i = 0; i < 6; ++i)
+    {
+        sigma.translations[1 + i] = t0 + S.col(i).head<3>();
+        sigma.orientations[1 + i] = rotationVectorToQuaternion(r0 + S.col(i).tail<3>());
+        sigma.translations[7 + i] = t0 - S.col(i).head<3>();
+        sigma.orientations[7 + i] = rotationVectorToQuaternion(r0 - S.col(i).tail<3>());
+    }
+    for (int i = 0; i < 13; ++i)
+        sigma.rotations[i] = Eigen::Quaterniond(sigma.orientations[i]).toRotationMatrix();
+    return sigma;
+}
+
+std::pair<Eigen::Vector3d, Eigen::Matrix3d> UnscentedTransform::composePointWithCovariance(
+        const TransformWithCovariance& transform,
+        const Eigen::Vector3d& point, const Eigen::Matrix3d& cov) const
+{
+    std::vector<base::Vector3d> points(1, point), result_points;
+    std::vector<base::Matrix3d> covs(1, cov), result_covs;
+    composePointsWithCovariance(computeSigmaPoints(transform, 3), points, covs, result_points, result_covs);
+    return std::make_pair(Eigen::Vector3d(result_points[0]), Eigen::Matrix3d(result_covs[0]));
+}
+
+namespace
+{
+    /** Shared implementation of the batch point compositions
+     *
+     * The state is [pose point], with independent pose and point errors. Its
+     * sigma points are the 12 pose sigma points applied to the mean point,
+     * and the 6 point sigma points p +/- s_j transformed by the mean pose. The
+     * latter are symmetric around the transformed mean point, so their
+     * contribution to the mean reduces to a weight on the central point, and
+     * their contribution to the covariance to R0 C R0^T.
+     */
+    template<typename CovarianceAt>
+    void composePoints(const UnscentedTransform& ut,
+            const UnscentedTransform::PoseSigmaPoints& sigma,
+            const std::vector<base::Vector3d>& points,
+            CovarianceAt const& covariance_at,
+            std::vector<base::Vector3d>& result_points,
+            std::vector<base::Matrix3d>& result_covs)
+    {
+        if (sigma.dimension != 9 || sigma.size() != 13)
+            throw std::invalid_argument("UnscentedTransform::composePointsWithCovariance: sigma points must be computed with an augmented dimension of 3");
+
+        const double wi = ut.getWeight(9);
+        const double wm0 = ut.getMeanWeight0(9) + 6 * wi;
+        const double wc0 = ut.getCovarianceWeight0(9) + 6 * wi;
+
+        // stack the sigma point transformations, so that all the transformed
+        // points are computed with a single matrix product
+        Eigen::Matrix<double, 36, 3> rotations;
+        Eigen::Matrix<double, 36, 1> translations;
+        for (int i = 0; i < 12; ++i)
+        {
+            rotations.block<3, 3>(3 * i, 0) = sigma.rotations[1 + i];
+            translations.segment<3>(3 * i) = sigma.translations[1 + i];
+        }
+        const Eigen::Matrix3d R0 = sigma.rotations[0];
+        const Eigen::Vector3d t0 = sigma.translations[0];
+
+        result_points.resize(points.size());
+        result_covs.resize(points.size());
+        Eigen::Matrix<double, 36, 1> stacked;
+        Eigen::Map< Eigen::Matrix<double, 3, 12> > Y(stacked.data());
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            const Eigen::Vector3d p = points[i];
+            stacked = rotations * p + translations;
+            const Eigen::Vector3d y0 = R0 * p + t0;
+
+            const Eigen::Vector3d mean = wm0 * y0 + wi * Y.rowwise().sum();
+            const Eigen::Vector3d d0 = y0 - mean;
+            Y.colwise() -= mean;
+
+            const Eigen::Matrix3d C = covariance_at(i);
+            result_points[i] = mean;
+            result_covs[i] = wc0 * d0 * d0.transpose() + wi * Y * Y.transpose()
+                + R0 * C * R0.transpose();
+        }
+    }
+
+    struct PerPointCovariance
+    {
+        const std::vector<base::Matrix3d>& covs;
+        PerPointCovariance(const std::vector<base::Matrix3d>& covs) : covs(covs) {}
+        const base::Matrix3d& operator()(size_t i) const { return covs[i]; }
+    };
+
+    struct CommonCovariance
+    {
+        const base::Matrix3d& cov;
+        CommonCovariance(const base::Matrix3d& cov) : cov(cov) {}
+        const base::Matrix3d& operator()(size_t) const { return cov; }
+    };
+}
+
+void UnscentedTransform::composePointsWithCovariance(const PoseSigmaPoints& sigma,
+        const std::vector<base::Vector3d>& points,
+        const std::vector<base::Matrix3d>& covs,
+        std::vector<base::Vector3d>& result_points,
+        std::vector<base::Matrix3d>& result_covs) const
+{
+    if (points.size() != covs.size())
+        throw std::invalid_argument("UnscentedTransform::composePointsWithCovariance: points and covs have different sizes");
+    composePoints(*this, sigma, points, PerPointCovariance(covs), result_points, result_covs);
+}
+
+void UnscentedTransform::composePointsWithCovariance(const PoseSigmaPoints& sigma,
+        const std::vector<base::Vector3d>& points,
+        const base::Matrix3d& cov,
+        std::vector<base::Vector3d>& result_points,
+        std::vector<base::Matrix3d>& result_covs) const
+{
+    composePoints(*this, sigma, points, CommonCovariance(cov), result_points, result_covs);
+}
+
+} //end namespace base
@@ -0,0 +1,273 @@
+#ifndef __BASE_UNSCENTED_TRANSFORM_HPP__
+#define __BASE_UNSCENTED_TRANSFORM_HPP__
+
+#include <vector>
+#include <utility>
+
+#include <Eigen/Cholesky>
+
+#include <base/Eigen.hpp>
+#include <base/TransformWithCovariance.hpp>
+#include <base/TwistWithCovariance.hpp>
+
+namespace base {
+
+    /**
+     * Propagation of the uncertainty of the base covariance types through
+     * arbitrary, possibly nonlinear, functions with the scaled unscented
+     * transform.
+     *
+     * This complements the first-order (Jacobian based) propagation of
+     * TransformWithCovariance: the function is evaluated on 2n+1 sigma points
+     * chosen from the mean and covariance of the input, and the output mean
+     * and covariance are computed from the weighted results.
+     *
+     * The uncertainty of a TransformWithCovariance is handled with the same
+     * parametrization than its covariance, i.e. as additive errors on the
+     * translation and on the rotation vector of the orientation. Rotation
+     * vectors are averaged linearly, which makes the results unreliable for
+     * rotations whose angle is close to PI.
+     *
+     * The matrix square roots used to build the sigma points are computed
+     * with a LDLT decomposition, so semi-definite covariances (e.g. with some
+     * zero variances) are supported. They can be computed once and reused
+     * through PoseSigmaPoints, which is what the batch point composition
+     * does.
+     */
+    class UnscentedTransform
+    {
+    public:
+        /** Sigma points of a TransformWithCovariance
+         *
+         * The 13 poses obtained by perturbing the mean pose along the columns
+         * of the square root of its covariance. They depend only on the pose
+         * and on the dimension of the state they are part of, so that they
+         * can be shared between many propagations.
+         */
+        struct PoseSigmaPoints
+        {
+            /** Dimension of the (possibly augmented) state the sigma points
+             * have been computed for
+             */
+            int dimension;
+
+            /** Sigma point translations, the first one being the mean */
+            std::vector<base::Vector3d> translations;
+            /** Sigma point orientations, the first one being the mean */
+            std::vector<base::Quaterniond> orientations;
+            /** Rotation matrices of the orientations */
+            std::vector<base::Matrix3d> rotations;
+
+            size_t size() const { return translations.size(); }
+        };
+
+        /** Creates a scaled unscented transform
+         *
+         * @param alpha spread of the sigma points around the mean
+         * @param beta prior knowledge of the distribution, 2 is optimal for
+         *   gaussians
+         * @param kappa secondary scaling parameter
+         */
+        explicit UnscentedTransform(double alpha = 1.0, double beta = 2.0, double kappa = 0.0);
+
+        double getAlpha() const { return alpha; }
+        double getBeta() const { return beta; }
+        double getKappa() const { return kappa; }
+
+        /** Weight of the central sigma point in the mean, for a state of
+         * dimension @a n
+         */
+        double getMeanWeight0(int n) const;
+
+        /** Weight of the central sigma point in the covariance, for a state
+         * of dimension @a n
+         */
+        double getCovarianceWeight0(int n) const;
+
+        /** Weight of the other sigma points, both in the mean and the
+         * covariance, for a state of dimension @a n
+         */
+        double getWeight(int n) const;
+
+        /** Distance of the sigma points to the mean, in units of the
+         * covariance square root, for a state of dimension @a n
+         */
+        double getScale(int n) const;
+
+        /** Returns a matrix S such that S * S^T = A
+         *
+         * Uses a LDLT decomposition, i.e. supports semi-definite matrices.
+         * Negative pivots (caused by rounding errors) are clamped to zero.
+         */
+        template<typename Derived>
+        static typename Derived::PlainObject matrixSqrt(const Eigen::MatrixBase<Derived>& A)
+        {
+            typedef typename Derived::PlainObject Matrix;
+            Eigen::LDLT<Matrix> ldlt(A);
+            Matrix L = ldlt.matrixL();
+            L = L * ldlt.vectorD().cwiseMax(0).cwiseSqrt().asDiagonal();
+            return ldlt.transpositionsP().transpose() * L;
+        }
+
+        /** Propagates a gaussian through @a f
+         *
+         * @param f function object with the signature
+         *   Eigen::Matrix<double,M,1> f(Eigen::Matrix<double,N,1> const&)
+         */
+        template<int N, int M, typename Function>
+        void propagate(const Eigen::Matrix<double, N, 1>& mean,
+                       const Eigen::Matrix<double, N, N>& cov,
+                       Function const& f,
+                       Eigen::Matrix<double, M, 1>& out_mean,
+                       Eigen::Matrix<double, M, M>& out_cov) const
+        {
+            const Eigen::Matrix<double, N, N> S = matrixSqrt(cov) * getScale(N);
+            const double wm0 = getMeanWeight0(N), wc0 = getCovarianceWeight0(N), wi = getWeight(N);
+
+            Eigen::Matrix<double, M, 2 * N + 1> Y;
+            Y.col(0) = f(mean);
+            for (int i = 0; i < N; ++i)
+            {
+                Y.col(1 + i) = f(Eigen::Matrix<double, N, 1>(mean + S.col(i)));
+                Y.col(1 + N + i) = f(Eigen::Matrix<double, N, 1>(mean - S.col(i)));
+            }
+            accumulate(Y, wm0, wc0, wi, out_mean, out_cov);
+        }
+
+        /** Propagates a twist through @a f
+         *
+         * @param f function object with the signature
+         *   base::Vector6d f(base::Vector6d const&)
+         *   where the vectors are the [vel rot] velocities of
+         *   TwistWithCovariance::getVelocity
+         */
+        template<typename Function>
+        TwistWithCovariance propagate(const TwistWithCovariance& twist, Function const& f) const
+        {
+            Eigen::Matrix<double, 6, 1> mean;
+            Eigen::Matrix<double, 6, 6> cov;
+            propagate<6, 6>(Eigen::Matrix<double, 6, 1>(twist.getVelocity()),
+                    Eigen::Matrix<double, 6, 6>(twist.getCovariance()),
+                    TwistFunction<Function>(f), mean, cov);
+            return TwistWithCovariance(base::Vector6d(mean), base::Matrix6d(cov));
+        }
+
+        /** Propagates a transformation through @a f
+         *
+         * @param f function object with the signature
+         *   Eigen::Affine3d f(Eigen::Affine3d const&)
+         */
+        template<typename Function>
+        TransformWithCovariance propagate(const TransformWithCovariance& transform, Function const& f) const
+        {
+            PoseSigmaPoints sigma = computeSigmaPoints(transform);
+            Eigen::Matrix<double, 6, 13> Y;
+            for (size_t i = 0; i < sigma.size(); ++i)
+            {
+                Eigen::Affine3d pose(Eigen::Quaterniond(sigma.orientations[i]));
+                pose.translation() = sigma.translations[i];
+                Y.col(i) = toVector(f(pose));
+            }
+            alignRotationVectors(Y);
+
+            Eigen::Matrix<double, 6, 1> mean;
+            Eigen::Matrix<double, 6, 6> cov;
+            accumulate(Y, getMeanWeight0(6), getCovarianceWeight0(6), getWeight(6), mean, cov);
+            return TransformWithCovariance(base::Position(mean.head<3>()),
+                    base::Quaterniond(rotationVectorToQuaternion(mean.tail<3>())),
+                    base::Matrix6d(cov));
+        }
+
+        /** Computes the sigma points of @a transform
+         *
+         * @param augmented_dimension count of additional, independent state
+         *   dimensions the pose will be combined with. The sigma points can
+         *   only be used for propagations of a state of that dimension, e.g.
+         *   3 for composePointsWithCovariance.
+         */
+        PoseSigmaPoints computeSigmaPoints(const TransformWithCovariance& transform,
+                                           int augmented_dimension = 0) const;
+
+        /** Unscented counterpart of
+         * TransformWithCovariance::composePointWithCovariance
+         */
+        std::pair<Eigen::Vector3d, Eigen::Matrix3d>
+        composePointWithCovariance(const TransformWithCovariance& transform,
+                                   const Eigen::Vector3d& point, const Eigen::Matrix3d& cov) const;
+
+        /** Transforms many points, each with its own covariance, by the same
+         * uncertain transformation
+         *
+         * The pose sigma points are computed once and shared between all
+         * points. As a point enters the composition linearly, the
+         * contribution of its own uncertainty is computed in closed form, so
+         * no decomposition of the point covariances is needed.
+         *
+         * @param sigma the sigma points of the transformation, as returned by
+         *   computeSigmaPoints(transform, 3)
+         * @throw std::invalid_argument if sigma has not been computed for a
+         *   point composition, or if points and covs have different sizes
+         */
+        void composePointsWithCovariance(const PoseSigmaPoints& sigma,
+                                         const std::vector<base::Vector3d>& points,
+                                         const std::vector<base::Matrix3d>& covs,
+                                         std::vector<base::Vector3d>& result_points,
+                                         std::vector<base::Matrix3d>& result_covs) const;
+
+        /** Same than the other overload, with a covariance common to all
+         * points
+         */
+        void composePointsWithCovariance(const PoseSigmaPoints& sigma,
+                                         const std::vector<base::Vector3d>& points,
+                                         const base::Matrix3d& cov,
+                                         std::vector<base::Vector3d>& result_points,
+                                         std::vector<base::Matrix3d>& result_covs) const;
+
+        /** Converts a rotation vector into a quaternion */
+        static Eigen::Quaterniond rotationVectorToQuaternion(const Eigen::Vector3d& r);
+
+        /** Converts a quaternion into a rotation vector */
+        static Eigen::Vector3d quaternionToRotationVector(const Eigen::Quaterniond& q);
+
+    private:
+        double alpha;
+        double beta;
+        double kappa;
+
+        double getLambda(int n) const;
+
+        template<typename Function>
+        struct TwistFunction
+        {
+            Function const& f;
+            TwistFunction(Function const& f) : f(f) {}
+            Eigen::Matrix<double, 6, 1> operator()(Eigen::Matrix<double, 6, 1> const& v) const
+            { return Eigen::Matrix<double, 6, 1>(f(base::Vector6d(v))); }
+        };
+
+        /** Converts a transformation into its [translation rotation-vector]
+         * representation
+         */
+        static Eigen::Matrix<double, 6, 1> toVector(const Eigen::Affine3d& pose);
+
+        /** Makes the rotation vectors of the sigma points continuous with the
+         * one of the first sigma point
+         */
+        static void alignRotationVectors(Eigen::Matrix<double, 6, 13>& Y);
+
+        template<int M, int Cols>
+        static void accumulate(const Eigen::Matrix<double, M, Cols>& Y,
+                               double wm0, double wc0, double wi,
+                               Eigen::Matrix<double, M, 1>& mean,
+                               Eigen::Matrix<double, M, M>& cov)
+        {
+            mean = wm0 * Y.col(0) + wi * Y.rightCols(Cols - 1).rowwise().sum();
+            const Eigen::Matrix<double, M, Cols> D = Y.colwise() - mean;
+            cov = wc0 * D.col(0) * D.col(0).transpose()
+                + wi * D.rightCols(Cols - 1) * D.rightCols(Cols - 1).transpose();
+        }
+    };
+
+} // namespaces
+
+#endif
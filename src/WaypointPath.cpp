@@ -0,0 +1,293 @@
+#include "WaypointPath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <base/Angle.hpp>
+
+namespace base {
+
+WaypointPath::WaypointPath(double cell_size)
+    : cell_size(cell_size)
+{
+    if (!(cell_size > 0))
+        throw std::invalid_argument("WaypointPath: the cell size must be strictly positive");
+    clear();
+}
+
+WaypointPath::WaypointPath(const std::vector<Waypoint>& waypoints, double cell_size)
+    : cell_size(cell_size)
+{
+    if (!(cell_size > 0))
+        throw std::invalid_argument("WaypointPath: the cell size must be strictly positive");
+    clear();
+    this->waypoints.reserve(waypoints.size());
+    for (size_t i = 0; i < waypoints.size(); ++i)
+        push_back(waypoints[i]);
+}
+
+void WaypointPath::clear()
+{
+    waypoints.clear();
+    grid.clear();
+    for (int i = 0; i < 3; ++i)
+    {
+        min_cell[i] = 0;
+        max_cell[i] = -1;
+    }
+    max_tol_position = 0;
+    target = 0;
+}
+
+void WaypointPath::getCell(const base::Vector3d& position, int64_t& x, int64_t& y, int64_t& z) const
+{
+    x = static_cast<int64_t>(std::floor(position.x() / cell_size));
+    y = static_cast<int64_t>(std::floor(position.y() / cell_size));
+    z = static_cast<int64_t>(std::floor(position.z() / cell_size));
+}
+
+bool WaypointPath::isIndexable(const base::Vector3d& position) const
+{
+    // leaves room for the search radius and the tolerances
+    return (position.array().abs() / cell_size).maxCoeff() < 1e15;
+}
+
+uint64_t WaypointPath::getCellKey(int64_t x, int64_t y, int64_t z)
+{
+    // 21 bits per axis. Far away cells may share a key, which only costs
+    // a few more distance tests
+    const uint64_t mask = (1ull << 21) - 1;
+    return (static_cast<uint64_t>(x) & mask)
+        | ((static_cast<uint64_t>(y) & mask) << 21)
+        | ((static_cast<uint64_t>(z) & mask) << 42);
+}
+
+void WaypointPath::push_back(const Waypoint& waypoint)
+{
+    int64_t cell[3];
+    getCell(waypoint.position, cell[0], cell[1], cell[2]);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (waypoints.empty() || cell[i] < min_cell[i])
+            min_cell[i] = cell[i];
+        if (waypoints.empty() || cell[i] > max_cell[i])
+            max_cell[i] = cell[i];
+    }
+
+    grid[getCellKey(cell[0], cell[1], cell[2])].push_back(waypoints.size());
+    max_tol_position = std::max(max_tol_position, waypoint.tol_position);
+    waypoints.push_back(waypoint);
+}
+
+bool WaypointPath::isReached(const Waypoint& waypoint, const base::Vector3d& position, double heading)
+{
+    return (waypoint.position - position).squaredNorm() <= waypoint.tol_position * waypoint.tol_position
+        && std::abs(Angle::normalizeRad(heading - waypoint.heading)) <= waypoint.tol_heading;
+}
+
+int WaypointPath::findNearestLinear(const base::Vector3d& position) const
+{
+    int best = 0;
+    double best_distance = (waypoints[0].position - position).squaredNorm();
+    for (size_t i = 1; i < waypoints.size(); ++i)
+    {
+        double distance = (waypoints[i].position - position).squaredNorm();
+        if (distance < best_distance)
+        {
+            best = static_cast<int>(i);
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+int WaypointPath::findNearest(const base::Vector3d& position) const
+{
+    if (!position.allFinite())
+        throw std::invalid_argument("WaypointPath::findNearest: the position must be finite");
+    if (waypoints.empty())
+        return -1;
+    if (!isIndexable(position))
+        return findNearestLinear(position);
+
+    int64_t center[3];
+    getCell(position, center[0], center[1], center[2]);
+
+    // search shells of cells of increasing (chebyshev) radius around the
+    // cell of the position, starting with the first one that reaches the
+    // occupied cells. A waypoint in the shell r is at least (r - 1) *
+    // cell_size away, so the search stops once the best candidate is closer
+    // than that.
+    int64_t min_radius = 0, max_radius = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        min_radius = std::max(min_radius, std::max(min_cell[i] - center[i], center[i] - max_cell[i]));
+        max_radius = std::max(max_radius, std::max(std::abs(center[i] - min_cell[i]), std::abs(max_cell[i] - center[i])));
+    }
+
+    int best = -1;
+    double best_distance = 0;
+    auto visit = [&](int64_t x, int64_t y, int64_t z) {
+        Grid::const_iterator cell = grid.find(getCellKey(x, y, z));
+        if (cell == grid.end())
+            return;
+
+        for (size_t i = 0; i < cell->second.size(); ++i)
+        {
+            double distance = (waypoints[cell->second[i]].position - position).norm();
+            if (best < 0 || distance < best_distance
+                    || (distance == best_distance && static_cast<int>(cell->second[i]) < best))
+            {
+                best = static_cast<int>(cell->second[i]);
+                best_distance = distance;
+            }
+        }
+    };
+
+    for (int64_t r = min_radius; r <= max_radius; ++r)
+    {
+        if (best >= 0 && best_distance <= (r - 1) * cell_size)
+            break;
+
+        int64_t lo[3], hi[3];
+        double cell_count = 1;
+        for (int i = 0; i < 3; ++i)
+        {
+            lo[i] = std::max(center[i] - r, min_cell[i]);
+            hi[i] = std::min(center[i] + r, max_cell[i]);
+            cell_count *= hi[i] - lo[i] + 1;
+        }
+
+        // all the shells up to r cover the clamped box. Once it has more
+        // cells than there are waypoints, scanning the waypoints is cheaper,
+        // e.g. for sparse paths or positions far away from the path
+        if (cell_count > waypoints.size())
+            return findNearestLinear(position);
+
+        for (int64_t x = lo[0]; x <= hi[0]; ++x)
+        {
+            const bool x_on_shell = std::abs(x - center[0]) == r;
+            for (int64_t y = lo[1]; y <= hi[1]; ++y)
+            {
+                if (x_on_shell || std::abs(y - center[1]) == r)
+                {
+                    for (int64_t z = lo[2]; z <= hi[2]; ++z)
+                        visit(x, y, z);
+                }
+                else
+                {
+                    // inside the shell in X and Y, only its two Z faces
+                    if (center[2] - r >= lo[2])
+                        visit(x, y, center[2] - r);
+                    if (r > 0 && center[2] + r <= hi[2])
+                        visit(x, y, center[2] + r);
+                }
+            }
+        }
+    }
+    return best;
+}
+
+size_t WaypointPath::findReached(const base::Vector3d& position, double heading, std::vector<size_t>& result) const
+{
+    if (!position.allFinite())
+        throw std::invalid_argument("WaypointPath::findReached: the position must be finite");
+    if (waypoints.empty())
+        return 0;
+
+    const size_t start = result.size();
+    int64_t lo[3], hi[3];
+    double cell_count = 1;
+    const bool indexable = isIndexable(position.cwiseAbs() + base::Vector3d::Constant(max_tol_position));
+    if (indexable)
+    {
+        getCell(position - base::Vector3d::Constant(max_tol_position), lo[0], lo[1], lo[2]);
+        getCell(position + base::Vector3d::Constant(max_tol_position), hi[0], hi[1], hi[2]);
+        for (int i = 0; i < 3; ++i)
+        {
+            lo[i] = std::max(lo[i], min_cell[i]);
+            hi[i] = std::min(hi[i], max_cell[i]);
+            cell_count *= std::max<int64_t>(hi[i] - lo[i] + 1, 0);
+        }
+    }
+
+    // same fallback as findNearest, for tolerances larger than the path
+    if (!indexable || cell_count > waypoints.size())
+    {
+        for (size_t i = 0; i < waypoints.size(); ++i)
+        {
+            if (isReached(waypoints[i], position, heading))
+                result.push_back(i);
+        }
+        return result.size() - start;
+    }
+
+    for (int64_t x = lo[0]; x <= hi[0]; ++x)
+    {
+        for (int64_t y = lo[1]; y <= hi[1]; ++y)
+        {
+            for (int64_t z = lo[2]; z <= hi[2]; ++z)
+            {
+                Grid::const_iterator cell = grid.find(getCellKey(x, y, z));
+                if (cell == grid.end())
+                    continue;
+
+                for (size_t i = 0; i < cell->second.size(); ++i)
+                {
+                    if (isReached(waypoints[cell->second[i]], position, heading))
+                        result.push_back(cell->second[i]);
+                }
+            }
+        }
+    }
+
+    // cells that share a key are visited more than once
+    std::sort(result.begin() + start, result.end());
+    result.erase(std::unique(result.begin() + start, result.end()), result.end());
+    return result.size() - start;
+}
+
+void WaypointPath::setTarget(size_t index)
+{
+    if (index > waypoints.size())
+        throw std::out_of_range("WaypointPath::setTarget: index out of range");
+    target = index;
+}
+
+const Waypoint& WaypointPath::getTarget() const
+{
+    if (isFinished())
+        throw std::out_of_range("WaypointPath::getTarget: the path is finished");
+    return waypoints[target];
+}
+
+size_t WaypointPath::updateTarget(const base::Vector3d& position, double heading)
+{
+    while (target < waypoints.size() && isReached(waypoints[target], position, heading))
+        ++target;
+    return target;
+}
+
+Trajectory WaypointPath::toTrajectory(double speed, double geometric_resolution, int order) const
+{
+    if (waypoints.empty())
+        throw std::runtime_error("WaypointPath::toTrajectory: the path is empty");
+
+    Trajectory trajectory;
+    trajectory.speed = speed;
+    trajectory.spline = geometry::Spline<3>(geometric_resolution, order);
+    if (waypoints.size() == 1)
+    {
+        trajectory.spline.setSingleton(waypoints.front().position);
+        return trajectory;
+    }
+
+    std::vector<base::Vector3d> points;
+    points.reserve(waypoints.size());
+    for (size_t i = 0; i < waypoints.size(); ++i)
+        points.push_back(waypoints[i].position);
+    trajectory.spline.interpolate(points);
+    return trajectory;
+}
+
+} // namespaces
@@ -0,0 +1,142 @@
+#ifndef __BASE_WAYPOINT_PATH_HH__
+#define __BASE_WAYPOINT_PATH_HH__
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include <base/Eigen.hpp>
+#include <base/Waypoint.hpp>
+#include <base/Trajectory.hpp>
+
+namespace base
+{
+    /**
+     * An ordered list of waypoints, with the path-level operations needed to
+     * follow it
+     *
+     * The waypoints are indexed in a uniform grid of cubic cells, which makes
+     * the nearest-waypoint search and the tolerance checks independent of
+     * the length of the path. The grid is updated incrementally by
+     * push_back. The cell size should be in the order of the spacing of the
+     * waypoints.
+     *
+     * Following the path is done with updateTarget, which advances the
+     * current target while the vehicle is within its tolerances.
+     */
+    class WaypointPath
+    {
+    public:
+        typedef std::vector<Waypoint>::const_iterator const_iterator;
+
+        /**
+         * @param cell_size the size of the cells of the spatial index, in m
+         * @throw std::invalid_argument if cell_size is not strictly positive
+         */
+        explicit WaypointPath(double cell_size = 1.0);
+
+        explicit WaypointPath(const std::vector<Waypoint>& waypoints, double cell_size = 1.0);
+
+        void push_back(const Waypoint& waypoint);
+
+        /** Removes all waypoints, and resets the current target */
+        void clear();
+
+        size_t size() const { return waypoints.size(); }
+        bool empty() const { return waypoints.empty(); }
+
+        const Waypoint& operator[](size_t index) const { return waypoints[index]; }
+        const_iterator begin() const { return waypoints.begin(); }
+        const_iterator end() const { return waypoints.end(); }
+        const std::vector<Waypoint>& getWaypoints() const { return waypoints; }
+
+        double getCellSize() const { return cell_size; }
+
+        /**
+         * Tests if a vehicle at @a position with the given @a heading is
+         * within the position and heading tolerances of @a waypoint
+         */
+        static bool isReached(const Waypoint& waypoint, const base::Vector3d& position, double heading);
+
+        /**
+         * Returns the index of the waypoint that is the closest to
+         * @a position, or -1 if the path is empty
+         *
+         * The search visits the cells around @a position, and falls back to
+         * a scan of all waypoints when that would visit more cells than
+         * there are waypoints. Ties go to the lowest index.
+         *
+         * @throw std::invalid_argument if position is not finite
+         */
+        int findNearest(const base::Vector3d& position) const;
+
+        /**
+         * Appends to @a result the indexes, in increasing order, of all the
+         * waypoints whose tolerances contain the given position and heading
+         *
+         * @a result is not cleared, so that its capacity can be reused
+         * across calls.
+         *
+         * @return the number of indexes appended
+         * @throw std::invalid_argument if position is not finite
+         */
+        size_t findReached(const base::Vector3d& position, double heading, std::vector<size_t>& result) const;
+
+        /** Sets the current target
+         *
+         * @throw std::out_of_range if index is greater than size()
+         */
+        void setTarget(size_t index);
+
+        /** Returns the index of the current target. It is equal to size()
+         * once the path is finished */
+        size_t getTargetIndex() const { return target; }
+
+        /** Returns the current target
+         *
+         * @throw std::out_of_range if the path is finished
+         */
+        const Waypoint& getTarget() const;
+
+        /** True if all waypoints have been reached */
+        bool isFinished() const { return target >= waypoints.size(); }
+
+        /**
+         * Advances the current target while the vehicle is within its
+         * tolerances, and returns the index of the new target
+         *
+         * Only the waypoints from the current target on are tested, so the
+         * cost is proportional to the number of waypoints reached during the
+         * call.
+         */
+        size_t updateTarget(const base::Vector3d& position, double heading);
+
+        /**
+         * Converts the positions of the waypoints into a trajectory
+         *
+         * The spline goes through the waypoint positions, in order.
+         *
+         * @throw std::runtime_error if the path is empty
+         */
+        Trajectory toTrajectory(double speed, double geometric_resolution = 0.1, int order = 3) const;
+
+    private:
+        typedef std::unordered_map<uint64_t, std::vector<size_t> > Grid;
+
+        /** False if the cell indexes of @a position would overflow */
+        bool isIndexable(const base::Vector3d& position) const;
+        void getCell(const base::Vector3d& position, int64_t& x, int64_t& y, int64_t& z) const;
+        static uint64_t getCellKey(int64_t x, int64_t y, int64_t z);
+        int findNearestLinear(const base::Vector3d& position) const;
+
+        double cell_size;
+        std::vector<Waypoint> waypoints;
+        Grid grid;
+        /** Bounds of the occupied cells, which end the nearest search */
+        int64_t min_cell[3];
+        int64_t max_cell[3];
+        double max_tol_position;
+        size_t target;
+    };
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __BASE_WAYPOINT_T_HH__
+#define __BASE_WAYPOINT_T_HH__
+
+#include <base/Eigen.hpp>
+#include <base/Waypoint.hpp>
+
+namespace base
+{
+    /**
+     * @brief Waypoint with a configurable scalar type
+     *
+     * Storage counterpart of Waypoint, for planners that keep long paths in
+     * single precision (Waypointf). Waypoint itself stays a plain double
+     * type, as it is part of the interface of many components.
+     *
+     * All conversions between precisions are explicit: use the converting
+     * constructors, cast<>() or toWaypoint().
+     */
+    template<typename _Scalar>
+    struct WaypointT
+    {
+        typedef _Scalar Scalar;
+        typedef Eigen::Matrix<Scalar, 3, 1, Eigen::DontAlign> Position;
+
+        Position position;
+        //heading in radians
+        Scalar heading;
+
+        //tolerance of the position in m
+        Scalar tol_position;
+        //tolerance of the heading in rad
+        Scalar tol_heading;
+
+        // default: initializing with identity and zero
+        WaypointT()
+            : position(Position::Zero()), heading(0), tol_position(0), tol_heading(0) {}
+
+        WaypointT(Position const& position, Scalar heading,
+                Scalar tol_position, Scalar tol_heading)
+            : position(position), heading(heading)
+            , tol_position(tol_position), tol_heading(tol_heading) {}
+
+        /** Converts from another precision */
+        template<typename OtherScalar>
+        explicit WaypointT(WaypointT<OtherScalar> const& other)
+            : position(other.position.template cast<Scalar>())
+            , heading(static_cast<Scalar>(other.heading))
+            , tol_position(static_cast<Scalar>(other.tol_position))
+            , tol_heading(static_cast<Scalar>(other.tol_heading)) {}
+
+        /** Converts from a Waypoint */
+        explicit WaypointT(base::Waypoint const& waypoint)
+            : position(waypoint.position.template cast<Scalar>())
+            , heading(static_cast<Scalar>(waypoint.heading))
+            , tol_position(static_cast<Scalar>(waypoint.tol_position))
+            , tol_heading(static_cast<Scalar>(waypoint.tol_heading)) {}
+
+        /** Converts to another precision */
+        template<typename OtherScalar>
+        WaypointT<OtherScalar> cast() const
+        {
+            return WaypointT<OtherScalar>(*this);
+        }
+
+        /** Converts to a Waypoint */
+        base::Waypoint toWaypoint() const
+        {
+            return base::Waypoint(base::Vector3d(position.template cast<double>()),
+                    heading, tol_position, tol_heading);
+        }
+    };
+
+    typedef WaypointT<float> Waypointf;
+}
+
+#endif
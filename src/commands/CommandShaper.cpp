@@ -0,0 +1,172 @@
+#include "CommandShaper.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace base { namespace commands {
+
+static inline double clampAbs(double value, double limit)
+{
+    return std::max(-limit, std::min(limit, value));
+}
+
+CommandChannelShaper::CommandChannelShaper()
+{
+    reset();
+}
+
+void CommandChannelShaper::reset()
+{
+    value = 0;
+    acceleration = 0;
+    initialized = false;
+}
+
+void CommandChannelShaper::reset(double value)
+{
+    this->value = value;
+    acceleration = 0;
+    initialized = true;
+}
+
+double CommandChannelShaper::update(double target, double dt, ShapingLimits const& limits, bool angular)
+{
+    if (!initialized)
+    {
+        reset(angular ? Angle::normalizeRad(target) : target);
+        return value;
+    }
+    if (!(dt > 0))
+        return value;
+
+    double error = target - value;
+    if (angular)
+        error = Angle::normalizeRad(error);
+
+    // acceleration that reaches the target in this step
+    double desired = clampAbs(error / dt, limits.acceleration);
+    if (std::isfinite(limits.jerk))
+    {
+        // the largest acceleration from which the jerk limit still allows
+        // to be back at zero when the target is reached
+        desired = clampAbs(desired, std::sqrt(2 * limits.jerk * std::abs(error)));
+        acceleration += clampAbs(desired - acceleration, limits.jerk * dt);
+    }
+    else
+        acceleration = desired;
+
+    const double delta = acceleration * dt;
+    if ((error >= 0 && delta >= error) || (error <= 0 && delta <= error))
+    {
+        // target reached
+        value += error;
+        acceleration = 0;
+    }
+    else
+        value += delta;
+
+    if (angular)
+        value = Angle::normalizeRad(value);
+    return value;
+}
+
+Motion2DShaper::Motion2DShaper(ShapingLimits const& translation, ShapingLimits const& rotation,
+                               ShapingLimits const& heading)
+    : translation_limits(translation), rotation_limits(rotation), heading_limits(heading)
+{
+}
+
+void Motion2DShaper::reset()
+{
+    translation.reset();
+    rotation.reset();
+    heading.reset();
+}
+
+void Motion2DShaper::reset(Motion2D const& current)
+{
+    translation.reset(current.translation);
+    rotation.reset(current.rotation);
+    heading.reset(current.heading.getRad());
+}
+
+Motion2D Motion2DShaper::update(Motion2D const& target, double dt)
+{
+    return Motion2D(
+            translation.update(target.translation, dt, translation_limits),
+            rotation.update(target.rotation, dt, rotation_limits),
+            Angle::fromRad(heading.update(target.heading.getRad(), dt, heading_limits, true)));
+}
+
+void Motion2DShaper::update(std::vector<Motion2D> const& targets, double dt, std::vector<Motion2D>& output)
+{
+    output.resize(targets.size());
+    if (!targets.empty())
+        update(&targets[0], targets.size(), dt, &output[0]);
+}
+
+void Motion2DShaper::update(Motion2D const* targets, size_t count, double dt, Motion2D* output)
+{
+    for (size_t i = 0; i < count; ++i)
+        output[i] = update(targets[i], dt);
+}
+
+LinearAngular6DShaper::LinearAngular6DShaper(ShapingLimits const& linear, ShapingLimits const& angular)
+    : linear_limits(linear), angular_limits(angular)
+{
+}
+
+void LinearAngular6DShaper::reset()
+{
+    for (int i = 0; i < 6; ++i)
+        channels[i].reset();
+    last_time = base::Time();
+    last_output = LinearAngular6DCommand();
+}
+
+LinearAngular6DCommand LinearAngular6DShaper::update(LinearAngular6DCommand const& target)
+{
+    // a null timestamp would freeze the shaping, as dt would always be zero
+    const base::Time time = target.time.isNull() ? base::Time::now() : target.time;
+    if (last_time.isNull())
+    {
+        last_time = time;
+        return update(target, 0);
+    }
+    if (time <= last_time)
+        return last_output;
+
+    double dt = (time - last_time).toSeconds();
+    last_time = time;
+    return update(target, dt);
+}
+
+LinearAngular6DCommand LinearAngular6DShaper::update(LinearAngular6DCommand const& target, double dt)
+{
+    LinearAngular6DCommand result;
+    result.time = target.time;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (base::isUnset(target.linear(i)))
+            channels[i].reset();
+        else
+            result.linear(i) = channels[i].update(target.linear(i), dt, linear_limits);
+
+        if (base::isUnset(target.angular(i)))
+            channels[i + 3].reset();
+        else
+            result.angular(i) = channels[i + 3].update(target.angular(i), dt, angular_limits);
+    }
+    last_output = result;
+    return result;
+}
+
+void LinearAngular6DShaper::update(std::vector<LinearAngular6DCommand> const& targets,
+                                   std::vector<LinearAngular6DCommand>& output)
+{
+    output.resize(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i)
+        output[i] = update(targets[i]);
+}
+
+}} // end namespace base::commands
@@ -0,0 +1,164 @@
+#ifndef BASE_COMMANDS_COMMAND_SHAPER_HPP
+#define BASE_COMMANDS_COMMAND_SHAPER_HPP
+
+#include <vector>
+#include <base/Float.hpp>
+#include <base/Time.hpp>
+#include <base/commands/Motion2D.hpp>
+#include <base/commands/LinearAngular6DCommand.hpp>
+
+namespace base
+{
+    namespace commands
+    {
+
+    /** Limits of a shaped command channel
+     *
+     * For velocity commands (e.g. Motion2D::translation), acceleration
+     * limits the rate of change of the command and jerk the rate of change
+     * of the acceleration. For position commands (e.g. Motion2D::heading),
+     * the same fields limit the velocity and the acceleration of the
+     * command.
+     *
+     * An infinite value disables the corresponding limit.
+     */
+    struct ShapingLimits
+    {
+        double acceleration;
+        double jerk;
+
+        ShapingLimits()
+            : acceleration(base::infinity<double>()), jerk(base::infinity<double>()) {}
+        ShapingLimits(double acceleration, double jerk = base::infinity<double>())
+            : acceleration(acceleration), jerk(jerk) {}
+    };
+
+    /** Jerk- and acceleration-limited filter of a single command value
+     *
+     * The output follows the target with an acceleration that is limited,
+     * and whose changes are limited by the jerk. When the jerk is limited,
+     * the acceleration is also bounded so that it can come back to zero
+     * when the output reaches the target, i.e. the output does not
+     * overshoot constant targets.
+     *
+     * The state is made of the current value and acceleration only.
+     */
+    class CommandChannelShaper
+    {
+    public:
+        CommandChannelShaper();
+
+        /** Forgets the state. The next target is passed through */
+        void reset();
+
+        /** Sets the current value, with a zero acceleration */
+        void reset(double value);
+
+        bool isInitialized() const { return initialized; }
+        double getValue() const { return value; }
+        double getAcceleration() const { return acceleration; }
+
+        /** Moves the value towards @a target during @a dt seconds, and
+         * returns it
+         *
+         * @param angular if true, values are angles in radians: the value
+         *   goes the shortest way to the target, and is normalized to
+         *   ]-PI, PI]
+         */
+        double update(double target, double dt, ShapingLimits const& limits, bool angular = false);
+
+    private:
+        double value;
+        double acceleration;
+        bool initialized;
+    };
+
+    /** Command shaping for Motion2D streams
+     *
+     * The translation, rotation and heading are shaped independently. Until
+     * the first command (or after a reset()), the state is unknown and the
+     * first command is passed through. Use reset(Motion2D()) to start from
+     * a stopped robot instead.
+     */
+    class Motion2DShaper
+    {
+    public:
+        Motion2DShaper(ShapingLimits const& translation, ShapingLimits const& rotation,
+                       ShapingLimits const& heading = ShapingLimits());
+
+        void reset();
+        void reset(Motion2D const& current);
+
+        /** Shapes the next command, @a dt seconds after the previous one */
+        Motion2D update(Motion2D const& target, double dt);
+
+        /** Shapes a sequence of commands with a fixed period, e.g. for
+         * offline simulation
+         *
+         * @a output is resized to the size of @a targets, which does not
+         * allocate when its capacity is sufficient. The state is kept, so
+         * that sequences can be processed in chunks.
+         */
+        void update(std::vector<Motion2D> const& targets, double dt, std::vector<Motion2D>& output);
+
+        /** Same as above, on plain arrays of @a count commands */
+        void update(Motion2D const* targets, size_t count, double dt, Motion2D* output);
+
+    private:
+        ShapingLimits translation_limits;
+        ShapingLimits rotation_limits;
+        ShapingLimits heading_limits;
+        CommandChannelShaper translation;
+        CommandChannelShaper rotation;
+        CommandChannelShaper heading;
+    };
+
+    /** Command shaping for LinearAngular6DCommand streams
+     *
+     * Each of the six components is shaped independently, the angular part
+     * as plain values (not as angles). Unset components are passed through
+     * and reset their channel, so that the shaping restarts from the next
+     * set value.
+     *
+     * The command timestamps are used to compute the time steps. Commands
+     * without a timestamp are stamped with the time at which they are
+     * shaped.
+     */
+    class LinearAngular6DShaper
+    {
+    public:
+        LinearAngular6DShaper(ShapingLimits const& linear, ShapingLimits const& angular);
+
+        void reset();
+
+        /** Shapes the next command, using the time elapsed since the
+         * previous one. Commands that are not newer than the previous one
+         * do not change the state */
+        LinearAngular6DCommand update(LinearAngular6DCommand const& target);
+
+        /** Shapes the next command, @a dt seconds after the previous one
+         *
+         * The output has the timestamp of @a target
+         */
+        LinearAngular6DCommand update(LinearAngular6DCommand const& target, double dt);
+
+        /** Shapes a sequence of commands, using their timestamps
+         *
+         * @a output is resized to the size of @a targets, which does not
+         * allocate when its capacity is sufficient.
+         */
+        void update(std::vector<LinearAngular6DCommand> const& targets,
+                    std::vector<LinearAngular6DCommand>& output);
+
+    private:
+        ShapingLimits linear_limits;
+        ShapingLimits angular_limits;
+        CommandChannelShaper channels[6];
+        base::Time last_time;
+        LinearAngular6DCommand last_output;
+    };
+
+    }
+}
+
+#endif
@@ -21,6 +21,11 @@ const Affine3d BodyState::getPose() const
     return this->pose.getTransform();
 }
 
+Vector3d BodyState::getEuler() const
+{
+    return base::getEuler(this->pose.orientation);
+}
+
 double BodyState::getYaw() const
 {
     return base::getYaw(this->pose.orientation);
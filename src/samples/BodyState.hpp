@@ -52,6 +52,12 @@ namespace base { namespace samples {
 
         const base::Affine3d getPose() const;
 
+        /** Returns the (yaw, pitch, roll) angles of the orientation, see
+         * base::getEuler. Use this instead of calling getYaw, getPitch and
+         * getRoll separately, as each of them decomposes the orientation.
+         */
+        base::Vector3d getEuler() const;
+
         double getYaw() const;
 	
         double getPitch() const;
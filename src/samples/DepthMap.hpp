@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <Eigen/Geometry>
+#include <base/Eigen.hpp>
 
 #include <base/Angle.hpp>
 #include <base/Time.hpp>
@@ -239,8 +240,8 @@ public:
 	point_cloud.reserve(distances.size());
 	
 	// precompute local transformations
-	std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > rows2column;
-	std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > columns2pointcloud;
+	aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > rows2column;
+	aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > columns2pointcloud;
 	computeLocalTransformations(rows2column, columns2pointcloud, use_lut);
 	
 	// convert rows
@@ -282,8 +283,8 @@ public:
 	point_cloud.reserve(distances.size());
 	
 	// precompute local transformations
-	std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > rows2column;
-	std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > columns2pointcloud;
+	aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > rows2column;
+	aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > columns2pointcloud;
 	computeLocalTransformations(rows2column, columns2pointcloud, use_lut);
 	
 	Eigen::Matrix<typename T::Scalar,3,1> translation_delta = last_transformation.translation() - first_transformation.translation();
@@ -309,7 +310,7 @@ public:
 	}
 	else
 	{
-	    std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > pointcloud2world;
+	    aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > pointcloud2world;
 	    for(unsigned v = 0; v < vertical_size; v++)
 	    {
 		Eigen::Transform<typename T::Scalar,3,Eigen::Affine> transformation = 
@@ -339,7 +340,7 @@ public:
      */
     template<typename T>
     void convertDepthMapToPointCloud(std::vector<T> &point_cloud,
-				const std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > >& transformations,
+				const aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> >& transformations,
 				bool use_lut = false,
 				bool skip_invalid_measurements = true,
 				bool apply_transforms_vertically = true) const
@@ -358,8 +359,8 @@ public:
 	point_cloud.reserve(distances.size());
 	
 	// precompute local transformations
-	std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > rows2column;
-	std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > > columns2pointcloud;
+	aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > rows2column;
+	aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > columns2pointcloud;
 	computeLocalTransformations(rows2column, columns2pointcloud);
 	
 	// apply global transformations
@@ -398,19 +399,27 @@ protected:
     void convertSingleRow(std::vector<T> &point_cloud, 
 			    unsigned int row,
 			    const Eigen::Transform<typename T::Scalar,3,Eigen::Affine>& row2column,
-			    const std::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> > >& columns2pointcloud,
+			    const aligned::vector< Eigen::Transform<typename T::Scalar,3,Eigen::Affine> >& columns2pointcloud,
 			    const Eigen::Transform<typename T::Scalar,3,Eigen::Affine>& pointcloud2world,
 			    bool skip_invalid_measurements) const
     {
+	typedef Eigen::Matrix<typename T::Scalar,3,1> Vector;
+
+	// a measurement is the point (distance, 0, 0) in the row frame, so the
+	// row transformation reduces to a scaled axis plus an offset. The
+	// transformations are applied to the point instead of being composed
+	// with each other, and in aligned types
+	const Vector row_axis = row2column.linear().col(0);
+	const Vector row_offset = row2column.translation();
+
 	size_t row_index = (size_t)row * (size_t)horizontal_size;
 	for(unsigned h = 0; h < horizontal_size; h++)
 	{
 	    scalar distance = distances[row_index + h];
 	    if(isMeasurementValid(distance))
 	    {
-		T point(distance, 0.0, 0.0);
-		point =  pointcloud2world * (columns2pointcloud[h] * row2column * point);
-		point_cloud.push_back(point);
+		const Vector column_point = columns2pointcloud[h] * Vector(row_axis * distance + row_offset);
+		point_cloud.push_back(T(pointcloud2world * column_point));
 	    }
 	    else if(!skip_invalid_measurements)
 	    {
@@ -423,8 +432,8 @@ protected:
 
     /** Helper method to compute the local rows2column and columns2pointcloud transformations. */
     template<typename T>
-    void computeLocalTransformations(std::vector< Eigen::Transform<T,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<T,3,Eigen::Affine> > >& rows2column, 
-				     std::vector< Eigen::Transform<T,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<T,3,Eigen::Affine> > >& columns2pointcloud,
+    void computeLocalTransformations(aligned::vector< Eigen::Transform<T,3,Eigen::Affine> >& rows2column, 
+				     aligned::vector< Eigen::Transform<T,3,Eigen::Affine> >& columns2pointcloud,
 				     bool use_lut = false) const
     {
 	// check interval sizes
@@ -548,7 +557,7 @@ protected:
     
     /** Helper method to compute the rotations around an unit axis. */
     template<typename T>
-    void computeRotations(std::vector< Eigen::Transform<T,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<T,3,Eigen::Affine> > >& rotations, 
+    void computeRotations(aligned::vector< Eigen::Transform<T,3,Eigen::Affine> >& rotations, 
 			const std::vector<base::Angle>& angles, 
 			UNIT_AXIS axis,
 			bool use_lut = false) const
@@ -638,7 +647,7 @@ private:
     private:
 	double rad2deg;
 	double deg2rad;
-	std::vector< Eigen::Transform<T,3,Eigen::Affine>, Eigen::aligned_allocator< Eigen::Transform<T,3,Eigen::Affine> > > transformations;
+	aligned::vector< Eigen::Transform<T,3,Eigen::Affine> > transformations;
     };
 };
 
@@ -0,0 +1,109 @@
+#include "IMUSensorsBatch.hpp"
+#include <limits>
+#include <stdexcept>
+
+namespace base { namespace samples {
+
+void IMUSensorsBatch::clear()
+{
+    time = base::Time();
+    time_offsets.clear();
+    acc.clear();
+    gyro.clear();
+    mag.clear();
+}
+
+void IMUSensorsBatch::reserve(size_t count)
+{
+    time_offsets.reserve(count);
+    acc.reserve(count);
+    gyro.reserve(count);
+    mag.reserve(count);
+}
+
+void IMUSensorsBatch::push_back(IMUSensors const& sample)
+{
+    if (empty())
+        time = sample.time;
+
+    int64_t offset = (sample.time - time).toMicroseconds();
+    if (offset < 0 || (!empty() && static_cast<uint32_t>(offset) < time_offsets.back()))
+        throw std::invalid_argument("IMUSensorsBatch::push_back: samples must be added in time order");
+    if (offset > std::numeric_limits<uint32_t>::max())
+        throw std::invalid_argument("IMUSensorsBatch::push_back: sample too far from the batch time");
+
+    time_offsets.push_back(static_cast<uint32_t>(offset));
+    acc.push_back(sample.acc);
+    gyro.push_back(sample.gyro);
+    mag.push_back(sample.mag);
+}
+
+Time IMUSensorsBatch::getTime(size_t idx) const
+{
+    return time + Time::fromMicroseconds(time_offsets[idx]);
+}
+
+double IMUSensorsBatch::getTimeStep(size_t idx) const
+{
+    return (time_offsets[idx + 1] - time_offsets[idx]) * 1e-6;
+}
+
+IMUSensors IMUSensorsBatch::getSample(size_t idx) const
+{
+    IMUSensors sample;
+    sample.time = getTime(idx);
+    sample.acc = acc[idx];
+    sample.gyro = gyro[idx];
+    sample.mag = mag[idx];
+    return sample;
+}
+
+IMUSensorsBatch::ReadingMap IMUSensorsBatch::accMatrix()
+{
+    return ReadingMap(acc.empty() ? 0 : acc.front().data(), 3, acc.size());
+}
+
+IMUSensorsBatch::ReadingMapConst IMUSensorsBatch::accMatrix() const
+{
+    return ReadingMapConst(acc.empty() ? 0 : acc.front().data(), 3, acc.size());
+}
+
+IMUSensorsBatch::ReadingMap IMUSensorsBatch::gyroMatrix()
+{
+    return ReadingMap(gyro.empty() ? 0 : gyro.front().data(), 3, gyro.size());
+}
+
+IMUSensorsBatch::ReadingMapConst IMUSensorsBatch::gyroMatrix() const
+{
+    return ReadingMapConst(gyro.empty() ? 0 : gyro.front().data(), 3, gyro.size());
+}
+
+IMUSensorsBatch::ReadingMap IMUSensorsBatch::magMatrix()
+{
+    return ReadingMap(mag.empty() ? 0 : mag.front().data(), 3, mag.size());
+}
+
+IMUSensorsBatch::ReadingMapConst IMUSensorsBatch::magMatrix() const
+{
+    return ReadingMapConst(mag.empty() ? 0 : mag.front().data(), 3, mag.size());
+}
+
+IMUSensorsBatch IMUSensorsBatch::fromSamples(std::vector<IMUSensors> const& samples)
+{
+    IMUSensorsBatch batch;
+    batch.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+        batch.push_back(samples[i]);
+    return batch;
+}
+
+std::vector<IMUSensors> IMUSensorsBatch::toSamples() const
+{
+    std::vector<IMUSensors> samples;
+    samples.reserve(size());
+    for (size_t i = 0; i < size(); ++i)
+        samples.push_back(getSample(i));
+    return samples;
+}
+
+}} // namespaces
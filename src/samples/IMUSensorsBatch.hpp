@@ -0,0 +1,80 @@
+#ifndef BASE_SAMPLES_IMU_SENSORS_BATCH_H__
+#define BASE_SAMPLES_IMU_SENSORS_BATCH_H__
+
+#include <vector>
+#include <stdint.h>
+#include <base/Time.hpp>
+#include <base/Eigen.hpp>
+#include <base/samples/IMUSensors.hpp>
+
+namespace base { namespace samples {
+
+    /** A packed sequence of IMUSensors samples
+     *
+     * High-rate IMUs produce many small samples. This type groups them in a
+     * single structure of arrays: the readings are stored in separate
+     * contiguous arrays, and the timestamps as offsets in microseconds from
+     * the batch time, i.e. the time of the first sample.
+     *
+     * All arrays have the same size. The samples are sorted in time.
+     */
+    struct IMUSensorsBatch
+    {
+        /** Timestamp of the first sample */
+        base::Time time;
+
+        /** Time of each sample, in microseconds since @a time */
+        std::vector<uint32_t> time_offsets;
+
+        /** raw accelerometer readings */
+        std::vector<base::Vector3d> acc;
+
+        /** raw gyro readings */
+        std::vector<base::Vector3d> gyro;
+
+        /** raw magnetometer readings */
+        std::vector<base::Vector3d> mag;
+
+        typedef Eigen::Map< Eigen::Matrix<double, 3, Eigen::Dynamic> > ReadingMap;
+        typedef Eigen::Map< const Eigen::Matrix<double, 3, Eigen::Dynamic> > ReadingMapConst;
+
+        size_t size() const { return time_offsets.size(); }
+
+        bool empty() const { return time_offsets.empty(); }
+
+        void clear();
+
+        void reserve(size_t count);
+
+        /** Appends a sample
+         *
+         * @throw std::invalid_argument if the sample is older than the last
+         *   one, or too far from the batch time to be represented (about 71
+         *   minutes)
+         */
+        void push_back(IMUSensors const& sample);
+
+        /** Returns the time of the sample at @a idx */
+        base::Time getTime(size_t idx) const;
+
+        /** Returns the time between the samples at @a idx and @a idx + 1, in
+         * seconds */
+        double getTimeStep(size_t idx) const;
+
+        IMUSensors getSample(size_t idx) const;
+
+        /** Returns 3xN views on the readings */
+        ReadingMap accMatrix();
+        ReadingMapConst accMatrix() const;
+        ReadingMap gyroMatrix();
+        ReadingMapConst gyroMatrix() const;
+        ReadingMap magMatrix();
+        ReadingMapConst magMatrix() const;
+
+        static IMUSensorsBatch fromSamples(std::vector<IMUSensors> const& samples);
+
+        std::vector<IMUSensors> toSamples() const;
+    };
+}} // namespaces
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef BASE_POINTCLOUD_T_HPP
+#define BASE_POINTCLOUD_T_HPP
+
+#include <vector>
+#include <base/Eigen.hpp>
+#include <base/samples/Pointcloud.hpp>
+
+namespace base { namespace samples {
+
+  /**
+   * Point cloud with a configurable scalar type
+   *
+   * Storage counterpart of Pointcloud, for pipelines that are limited by
+   * memory bandwidth (Pointcloudf halves the size of the points and colors).
+   * Pointcloud itself stays a plain double type, as it is part of the
+   * interface of many components.
+   *
+   * All conversions between precisions are explicit: use the converting
+   * constructors, cast<>() or toPointcloud().
+   */
+  template<typename _Scalar>
+  struct PointcloudT
+  {
+    typedef _Scalar Scalar;
+    typedef Eigen::Matrix<Scalar, 3, 1, Eigen::DontAlign> Point;
+    typedef Eigen::Matrix<Scalar, 4, 1, Eigen::DontAlign> Color;
+
+    Time time;
+
+    std::vector<Point> points;
+
+    /** Colors of each point, see Pointcloud::colors */
+    std::vector<Color> colors;
+
+    PointcloudT() {}
+
+    /** Converts from another precision */
+    template<typename OtherScalar>
+    explicit PointcloudT(PointcloudT<OtherScalar> const& other)
+      : time(other.time)
+    {
+      convert(other.points, points);
+      convert(other.colors, colors);
+    }
+
+    /** Converts from a Pointcloud */
+    explicit PointcloudT(Pointcloud const& other)
+      : time(other.time)
+    {
+      convert(other.points, points);
+      convert(other.colors, colors);
+    }
+
+    /** Converts to another precision */
+    template<typename OtherScalar>
+    PointcloudT<OtherScalar> cast() const
+    {
+      return PointcloudT<OtherScalar>(*this);
+    }
+
+    /** Converts to a Pointcloud */
+    Pointcloud toPointcloud() const
+    {
+      Pointcloud result;
+      result.time = time;
+      convert(points, result.points);
+      convert(colors, result.colors);
+      return result;
+    }
+
+  private:
+    template<typename From, typename To>
+    static void convert(std::vector<From> const& from, std::vector<To>& to)
+    {
+      to.resize(from.size());
+      for (size_t i = 0; i < from.size(); ++i)
+        to[i] = from[i].template cast<typename To::Scalar>();
+    }
+  };
+
+  typedef PointcloudT<float> Pointcloudf;
+
+}}
+
+#endif
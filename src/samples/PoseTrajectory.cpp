@@ -0,0 +1,295 @@
+#include "PoseTrajectory.hpp"
+#include <stdexcept>
+
+namespace base { namespace samples {
+
+bool PoseTrajectory::hasCovariance() const
+{
+    return !times.empty() && cov_position.size() == times.size();
+}
+
+void PoseTrajectory::clear()
+{
+    times.clear();
+    positions.clear();
+    orientations.clear();
+    cov_position.clear();
+    cov_orientation.clear();
+}
+
+void PoseTrajectory::reserve(size_t count, bool with_covariance)
+{
+    times.reserve(count);
+    positions.reserve(count);
+    orientations.reserve(count);
+    if (with_covariance)
+    {
+        cov_position.reserve(count);
+        cov_orientation.reserve(count);
+    }
+}
+
+void PoseTrajectory::push_back(Time const& time, Pose const& pose)
+{
+    if (hasCovariance())
+        throw std::invalid_argument("PoseTrajectory::push_back: this trajectory stores covariances");
+
+    times.push_back(time);
+    positions.push_back(pose.position);
+    orientations.push_back(pose.orientation);
+}
+
+void PoseTrajectory::push_back(Time const& time, Pose const& pose,
+        Matrix3d const& cov_position, Matrix3d const& cov_orientation)
+{
+    if (!empty() && !hasCovariance())
+        throw std::invalid_argument("PoseTrajectory::push_back: this trajectory does not store covariances");
+
+    times.push_back(time);
+    positions.push_back(pose.position);
+    orientations.push_back(pose.orientation);
+    this->cov_position.push_back(cov_position);
+    this->cov_orientation.push_back(cov_orientation);
+}
+
+void PoseTrajectory::push_back(RigidBodyState const& rbs)
+{
+    // the first sample decides whether the trajectory stores covariances
+    bool with_covariance = empty()
+        ? rbs.hasValidPositionCovariance() || rbs.hasValidOrientationCovariance()
+        : hasCovariance();
+    if (with_covariance)
+        push_back(rbs.time, rbs.getPose(), rbs.cov_position, rbs.cov_orientation);
+    else
+        push_back(rbs.time, rbs.getPose());
+}
+
+Pose PoseTrajectory::getPose(size_t idx) const
+{
+    return Pose(positions[idx], orientations[idx]);
+}
+
+Eigen::Affine3d PoseTrajectory::getTransform(size_t idx) const
+{
+    return getPose(idx).toTransform();
+}
+
+RigidBodyState PoseTrajectory::getRigidBodyState(size_t idx,
+        std::string const& sourceFrame, std::string const& targetFrame) const
+{
+    RigidBodyState rbs;
+    rbs.time = times[idx];
+    rbs.sourceFrame = sourceFrame;
+    rbs.targetFrame = targetFrame;
+    rbs.position = positions[idx];
+    rbs.orientation = orientations[idx];
+    if (hasCovariance())
+    {
+        rbs.cov_position = cov_position[idx];
+        rbs.cov_orientation = cov_orientation[idx];
+    }
+    return rbs;
+}
+
+PoseTrajectory::PositionMap PoseTrajectory::positionMatrix()
+{
+    return PositionMap(positions.empty() ? 0 : positions.front().data(), 3, positions.size());
+}
+
+PoseTrajectory::PositionMapConst PoseTrajectory::positionMatrix() const
+{
+    return PositionMapConst(positions.empty() ? 0 : positions.front().data(), 3, positions.size());
+}
+
+PoseTrajectory::OrientationMap PoseTrajectory::orientationMatrix()
+{
+    return OrientationMap(orientations.empty() ? 0 : orientations.front().coeffs().data(), 4, orientations.size());
+}
+
+PoseTrajectory::OrientationMapConst PoseTrajectory::orientationMatrix() const
+{
+    return OrientationMapConst(orientations.empty() ? 0 : orientations.front().coeffs().data(), 4, orientations.size());
+}
+
+std::vector<Vector3d> PoseTrajectory::getEuler(EulerPrecision precision) const
+{
+    return base::getEuler(orientations, precision);
+}
+
+std::vector<double> PoseTrajectory::getYaw(EulerPrecision precision) const
+{
+    return base::getYaw(orientations, precision);
+}
+
+void PoseTrajectory::transform(Eigen::Affine3d const& transform)
+{
+    const Eigen::Matrix3d R = transform.linear();
+    const Eigen::Vector3d t = transform.translation();
+
+    PositionMap p = positionMatrix();
+    p = (R * p).colwise() + t;
+
+    // Quaternion left-multiplication q' = q_t * q, written as a 4x4 matrix
+    // acting on the (x, y, z, w) coefficients, so that all orientations are
+    // updated in a single matrix product
+    const Eigen::Quaterniond q(R);
+    Eigen::Matrix4d L;
+    L <<  q.w(), -q.z(),  q.y(), q.x(),
+          q.z(),  q.w(), -q.x(), q.y(),
+         -q.y(),  q.x(),  q.w(), q.z(),
+         -q.x(), -q.y(), -q.z(), q.w();
+    OrientationMap o = orientationMatrix();
+    o = L * o;
+
+    for (size_t i = 0; i < cov_position.size(); ++i)
+        cov_position[i] = R * cov_position[i] * R.transpose();
+}
+
+PoseTrajectory PoseTrajectory::relativePoses() const
+{
+    PoseTrajectory result;
+    if (size() < 2)
+        return result;
+
+    result.reserve(size() - 1);
+    for (size_t i = 1; i < size(); ++i)
+    {
+        const Eigen::Quaterniond inv = Eigen::Quaterniond(orientations[i - 1]).conjugate();
+        result.times.push_back(times[i]);
+        result.positions.push_back(inv * (positions[i] - positions[i - 1]));
+        result.orientations.push_back(inv * orientations[i]);
+    }
+    return result;
+}
+
+std::vector<double> PoseTrajectory::cumulativeDistance() const
+{
+    std::vector<double> result(size(), 0);
+    if (size() < 2)
+        return result;
+
+    PositionMapConst p = positionMatrix();
+    const size_t n = size() - 1;
+    Eigen::Map< Eigen::VectorXd > distances(&result[1], n);
+    distances = (p.rightCols(n) - p.leftCols(n)).colwise().norm().transpose();
+    for (size_t i = 1; i < result.size(); ++i)
+        result[i] += result[i - 1];
+    return result;
+}
+
+double PoseTrajectory::length() const
+{
+    if (size() < 2)
+        return 0;
+
+    PositionMapConst p = positionMatrix();
+    const size_t n = size() - 1;
+    return (p.rightCols(n) - p.leftCols(n)).colwise().norm().sum();
+}
+
+PoseTrajectory PoseTrajectory::resample(std::vector<Time> const& query) const
+{
+    if (empty())
+        throw std::runtime_error("PoseTrajectory::resample: cannot resample an empty trajectory");
+
+    const bool with_covariance = hasCovariance();
+    PoseTrajectory result;
+    result.reserve(query.size(), with_covariance);
+
+    size_t segment = 0;
+    for (size_t i = 0; i < query.size(); ++i)
+    {
+        Time const& time = query[i];
+        while (segment + 1 < size() && times[segment + 1] < time)
+            ++segment;
+
+        size_t a = segment, b = std::min(segment + 1, size() - 1);
+        double alpha = 0;
+        if (time <= times[a])
+            b = a;
+        else if (times[b] <= time)
+            a = b;
+        else
+            alpha = static_cast<double>((time - times[a]).microseconds) /
+                (times[b] - times[a]).microseconds;
+
+        result.times.push_back(time);
+        result.positions.push_back(positions[a] + alpha * (positions[b] - positions[a]));
+        result.orientations.push_back(orientations[a].slerp(alpha, orientations[b]));
+        if (with_covariance)
+        {
+            result.cov_position.push_back(cov_position[a] + alpha * (cov_position[b] - cov_position[a]));
+            result.cov_orientation.push_back(cov_orientation[a] + alpha * (cov_orientation[b] - cov_orientation[a]));
+        }
+    }
+    return result;
+}
+
+PoseTrajectory PoseTrajectory::resample(Time const& period) const
+{
+    if (period.microseconds <= 0)
+        throw std::invalid_argument("PoseTrajectory::resample: period must be strictly positive");
+    if (empty())
+        throw std::runtime_error("PoseTrajectory::resample: cannot resample an empty trajectory");
+
+    std::vector<Time> query;
+    query.reserve((times.back() - times.front()).microseconds / period.microseconds + 1);
+    for (Time t = times.front(); t <= times.back(); t = t + period)
+        query.push_back(t);
+    return resample(query);
+}
+
+PoseTrajectory PoseTrajectory::fromRigidBodyStates(std::vector<RigidBodyState> const& states, bool with_covariance)
+{
+    PoseTrajectory result;
+    result.reserve(states.size(), with_covariance);
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        RigidBodyState const& rbs = states[i];
+        result.times.push_back(rbs.time);
+        result.positions.push_back(rbs.position);
+        result.orientations.push_back(rbs.orientation);
+        if (with_covariance)
+        {
+            result.cov_position.push_back(rbs.cov_position);
+            result.cov_orientation.push_back(rbs.cov_orientation);
+        }
+    }
+    return result;
+}
+
+PoseTrajectory PoseTrajectory::fromPoses(std::vector<Pose> const& poses, std::vector<Time> const& times)
+{
+    if (!times.empty() && times.size() != poses.size())
+        throw std::invalid_argument("PoseTrajectory::fromPoses: poses and times have different sizes");
+
+    PoseTrajectory result;
+    result.reserve(poses.size());
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        result.times.push_back(times.empty() ? Time() : times[i]);
+        result.positions.push_back(poses[i].position);
+        result.orientations.push_back(poses[i].orientation);
+    }
+    return result;
+}
+
+std::vector<RigidBodyState> PoseTrajectory::toRigidBodyStates(std::string const& sourceFrame, std::string const& targetFrame) const
+{
+    std::vector<RigidBodyState> result;
+    result.reserve(size());
+    for (size_t i = 0; i < size(); ++i)
+        result.push_back(getRigidBodyState(i, sourceFrame, targetFrame));
+    return result;
+}
+
+std::vector<Pose> PoseTrajectory::toPoses() const
+{
+    std::vector<Pose> result;
+    result.reserve(size());
+    for (size_t i = 0; i < size(); ++i)
+        result.push_back(getPose(i));
+    return result;
+}
+
+}} //end namespace base::samples
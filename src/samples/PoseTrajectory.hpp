@@ -0,0 +1,170 @@
+#ifndef __BASE_SAMPLES_POSE_TRAJECTORY_HH
+#define __BASE_SAMPLES_POSE_TRAJECTORY_HH
+
+#include <vector>
+#include <base/Pose.hpp>
+#include <base/Time.hpp>
+#include <base/Eigen.hpp>
+#include <base/samples/RigidBodyState.hpp>
+
+namespace base { namespace samples {
+
+    /** Compact representation of a sequence of timestamped poses
+     *
+     * Unlike std::vector<RigidBodyState>, the fields are stored in separate
+     * contiguous arrays (structure of arrays). Only the pose is stored, and
+     * the covariances are optional: cov_position and cov_orientation are
+     * either empty or have the same size than the trajectory.
+     *
+     * The bulk operations (transform, cumulativeDistance) work on the
+     * position and orientation arrays as a whole, which allows Eigen to
+     * vectorize them.
+     */
+    struct PoseTrajectory
+    {
+        /** Timestamps of the poses */
+        std::vector<base::Time> times;
+
+        /** Positions, same semantic as RigidBodyState::position */
+        std::vector<base::Position> positions;
+
+        /** Orientations, same semantic as RigidBodyState::orientation */
+        std::vector<base::Orientation> orientations;
+
+        /** Optional covariance of the positions */
+        std::vector<base::Matrix3d> cov_position;
+
+        /** Optional covariance of the orientations, as an axis/angle
+         * manifold in body coordinates
+         */
+        std::vector<base::Matrix3d> cov_orientation;
+
+        typedef Eigen::Map< Eigen::Matrix<double, 3, Eigen::Dynamic> > PositionMap;
+        typedef Eigen::Map< const Eigen::Matrix<double, 3, Eigen::Dynamic> > PositionMapConst;
+        typedef Eigen::Map< Eigen::Matrix<double, 4, Eigen::Dynamic> > OrientationMap;
+        typedef Eigen::Map< const Eigen::Matrix<double, 4, Eigen::Dynamic> > OrientationMapConst;
+
+        size_t size() const { return times.size(); }
+
+        bool empty() const { return times.empty(); }
+
+        /** True if the covariance arrays are filled */
+        bool hasCovariance() const;
+
+        void clear();
+
+        /** Reserves memory for @a count samples, including the covariances
+         * if @a with_covariance is set
+         */
+        void reserve(size_t count, bool with_covariance = false);
+
+        /** Appends a pose without covariance
+         *
+         * @throw std::invalid_argument if the trajectory stores covariances
+         */
+        void push_back(base::Time const& time, base::Pose const& pose);
+
+        /** Appends a pose with its covariance
+         *
+         * @throw std::invalid_argument if the trajectory is not empty and does not
+         *   store covariances
+         */
+        void push_back(base::Time const& time, base::Pose const& pose,
+                base::Matrix3d const& cov_position, base::Matrix3d const& cov_orientation);
+
+        /** Appends the pose part of a RigidBodyState, and its covariance if
+         * this trajectory stores covariances
+         *
+         * On an empty trajectory, the covariances are stored if @a rbs has
+         * either a valid position or a valid orientation covariance
+         */
+        void push_back(RigidBodyState const& rbs);
+
+        base::Pose getPose(size_t idx) const;
+
+        Eigen::Affine3d getTransform(size_t idx) const;
+
+        /** Returns the pose at @a idx as a RigidBodyState
+         *
+         * Velocities are invalidated, and the covariances are set only if
+         * this trajectory stores them.
+         */
+        RigidBodyState getRigidBodyState(size_t idx,
+                std::string const& sourceFrame = std::string(),
+                std::string const& targetFrame = std::string()) const;
+
+        /** Returns a 3xN view on the positions */
+        PositionMap positionMatrix();
+        PositionMapConst positionMatrix() const;
+
+        /** Returns a 4xN view on the orientation coefficients (x, y, z, w) */
+        OrientationMap orientationMatrix();
+        OrientationMapConst orientationMatrix() const;
+
+        /** Returns the (yaw, pitch, roll) angles of all orientations, see
+         * base::getEuler
+         */
+        std::vector<base::Vector3d> getEuler(base::EulerPrecision precision = base::EULER_EXACT) const;
+
+        /** Returns the yaw of all orientations, see base::getYaw */
+        std::vector<double> getYaw(base::EulerPrecision precision = base::EULER_EXACT) const;
+
+        /** Left-multiplies all poses by @a transform, i.e. changes the
+         * target frame of the trajectory. The position covariances are
+         * rotated accordingly, the orientation covariances being expressed in
+         * body coordinates are left unchanged.
+         */
+        void transform(Eigen::Affine3d const& transform);
+
+        /** Returns the relative pose between consecutive samples, i.e. the
+         * pose of sample i+1 expressed in the frame of sample i. The result
+         * has size() - 1 elements, timestamped with the time of sample i+1.
+         * Covariances are not propagated.
+         */
+        PoseTrajectory relativePoses() const;
+
+        /** Returns the distance travelled from the first sample up to each
+         * sample. The result has size() elements, the first one being zero.
+         */
+        std::vector<double> cumulativeDistance() const;
+
+        /** Total distance travelled along the trajectory */
+        double length() const;
+
+        /** Interpolates the trajectory at the given times
+         *
+         * Positions (and covariances) are interpolated linearly, orientations
+         * using slerp. Times before the first (resp. after the last) sample
+         * are clamped to the first (resp. last) pose.
+         *
+         * @param times the query times, sorted in increasing order
+         * @throw std::runtime_error if the trajectory is empty
+         */
+        PoseTrajectory resample(std::vector<base::Time> const& times) const;
+
+        /** Interpolates the trajectory at a fixed @a period between the first
+         * and last sample
+         *
+         * @throw std::invalid_argument if the period is not strictly positive
+         */
+        PoseTrajectory resample(base::Time const& period) const;
+
+        /** Creates a trajectory from the pose part of a set of RigidBodyState
+         */
+        static PoseTrajectory fromRigidBodyStates(std::vector<RigidBodyState> const& states, bool with_covariance = false);
+
+        /** Creates a trajectory from a set of poses. If @a times is empty, the
+         * times are left null
+         */
+        static PoseTrajectory fromPoses(std::vector<base::Pose> const& poses,
+                std::vector<base::Time> const& times = std::vector<base::Time>());
+
+        std::vector<RigidBodyState> toRigidBodyStates(
+                std::string const& sourceFrame = std::string(),
+                std::string const& targetFrame = std::string()) const;
+
+        std::vector<base::Pose> toPoses() const;
+    };
+}}
+
+#endif
@@ -31,6 +31,31 @@ PoseWithCovariance PoseWithCovariance::operator*(const PoseWithCovariance& pose)
     return new_pose;
 }
 
+FrameId PoseWithCovariance::getFrameId() const
+{
+    return FrameId::fromName(frame_id);
+}
+
+FrameId PoseWithCovariance::getObjectFrameId() const
+{
+    return FrameId::fromName(object_frame_id);
+}
+
+FramePair PoseWithCovariance::getFramePair() const
+{
+    return FramePair(getObjectFrameId(), getFrameId());
+}
+
+void PoseWithCovariance::setFrameId(FrameId const& frame)
+{
+    frame_id = frame.getName();
+}
+
+void PoseWithCovariance::setObjectFrameId(FrameId const& frame)
+{
+    object_frame_id = frame.getName();
+}
+
 void PoseWithCovariance::setTransform(const TransformWithCovariance& transform)
 {
     this->transform = transform;
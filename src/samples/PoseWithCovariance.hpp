@@ -3,6 +3,7 @@
 
 #include <string>
 #include <base/Time.hpp>
+#include <base/FrameId.hpp>
 #include <base/TransformWithCovariance.hpp>
 #include <base/samples/RigidBodyState.hpp>
 
@@ -53,6 +54,23 @@ public:
     */
     PoseWithCovariance operator*(const PoseWithCovariance& pose) const;
 
+    /** Returns frame_id as an interned frame ID */
+    base::FrameId getFrameId() const;
+
+    /** Returns object_frame_id as an interned frame ID */
+    base::FrameId getObjectFrameId() const;
+
+    /** Returns the (object_frame_id, frame_id) pair as interned frame IDs,
+     * i.e. with the same source/target semantic than RigidBodyState
+     */
+    base::FramePair getFramePair() const;
+
+    /** Sets frame_id from an interned frame ID */
+    void setFrameId(base::FrameId const& frame);
+
+    /** Sets object_frame_id from an interned frame ID */
+    void setObjectFrameId(base::FrameId const& frame);
+
     /** Sets the transformation as TransformWithCovariance */
     void setTransform(const base::TransformWithCovariance& transform);
 
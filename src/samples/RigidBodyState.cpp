@@ -8,6 +8,31 @@ RigidBodyState::RigidBodyState(bool doInvalidation)
         invalidate();
 }
 
+FrameId RigidBodyState::getSourceFrameId() const
+{
+    return FrameId::fromName(sourceFrame);
+}
+
+FrameId RigidBodyState::getTargetFrameId() const
+{
+    return FrameId::fromName(targetFrame);
+}
+
+FramePair RigidBodyState::getFramePair() const
+{
+    return FramePair(getSourceFrameId(), getTargetFrameId());
+}
+
+void RigidBodyState::setSourceFrame(FrameId const& frame)
+{
+    sourceFrame = frame.getName();
+}
+
+void RigidBodyState::setTargetFrame(FrameId const& frame)
+{
+    targetFrame = frame.getName();
+}
+
 void RigidBodyState::setTransform(const Eigen::Affine3d& transform)
 {
     position = transform.translation();
@@ -34,6 +59,11 @@ Pose RigidBodyState::getPose() const
     return Pose( position, orientation );
 }
 
+Vector3d RigidBodyState::getEuler() const
+{
+    return base::getEuler(orientation);
+}
+
 double RigidBodyState::getYaw() const
 {
     return base::getYaw(orientation);
@@ -4,6 +4,7 @@
 #include <base/Pose.hpp>
 #include <base/Time.hpp>
 #include <base/Float.hpp>
+#include <base/FrameId.hpp>
 
 #include <Eigen/Core>
 #include <Eigen/LU>
@@ -41,6 +42,21 @@ namespace base { namespace samples {
 	/** Name of the target reference frame */
 	std::string targetFrame;
 
+        /** Returns sourceFrame as an interned frame ID */
+        base::FrameId getSourceFrameId() const;
+
+        /** Returns targetFrame as an interned frame ID */
+        base::FrameId getTargetFrameId() const;
+
+        /** Returns the (sourceFrame, targetFrame) pair as interned frame IDs */
+        base::FramePair getFramePair() const;
+
+        /** Sets sourceFrame from an interned frame ID */
+        void setSourceFrame(base::FrameId const& frame);
+
+        /** Sets targetFrame from an interned frame ID */
+        void setTargetFrame(base::FrameId const& frame);
+
         /** Position in m of sourceFrame's origin expressed in targetFrame
          */
         Position   position;
@@ -77,6 +93,12 @@ namespace base { namespace samples {
 
 	base::Pose getPose() const;
 
+        /** Returns the (yaw, pitch, roll) angles of the orientation, see
+         * base::getEuler. Use this instead of calling getYaw, getPitch and
+         * getRoll separately, as each of them decomposes the orientation.
+         */
+        base::Vector3d getEuler() const;
+
         double getYaw() const;
 	
         double getPitch() const;
@@ -0,0 +1,130 @@
+#ifndef __BASE_SAMPLES_RIGID_BODY_STATE_T_HH
+#define __BASE_SAMPLES_RIGID_BODY_STATE_T_HH
+
+#include <string>
+#include <type_traits>
+#include <base/Eigen.hpp>
+#include <base/Float.hpp>
+#include <base/PoseT.hpp>
+#include <base/Time.hpp>
+#include <base/samples/RigidBodyState.hpp>
+
+namespace base { namespace samples {
+    /** Rigid body state with a configurable scalar type
+     *
+     * Storage counterpart of RigidBodyState, with the same fields and
+     * conventions, for pose buffers that are limited by memory bandwidth
+     * (RigidBodyStatef). RigidBodyState itself stays a plain double type, as
+     * it is what the transformer and the components exchange.
+     *
+     * All conversions between precisions are explicit: use the converting
+     * constructors, cast<>() or toRigidBodyState(). Computations should be
+     * done on the converted RigidBodyState.
+     */
+    template<typename _Scalar>
+    struct RigidBodyStateT
+    {
+        typedef _Scalar Scalar;
+        typedef Eigen::Matrix<Scalar, 3, 1, Eigen::DontAlign> Vector3;
+        typedef Eigen::Matrix<Scalar, 3, 3, Eigen::DontAlign> Matrix3;
+        typedef Eigen::Quaternion<Scalar, Eigen::DontAlign> Orientation;
+
+        base::Time time;
+
+        /** Name of the source reference frame */
+        std::string sourceFrame;
+
+        /** Name of the target reference frame */
+        std::string targetFrame;
+
+        /** See RigidBodyState::position */
+        Vector3 position;
+        Matrix3 cov_position;
+
+        /** See RigidBodyState::orientation */
+        Orientation orientation;
+        Matrix3 cov_orientation;
+
+        /** See RigidBodyState::velocity */
+        Vector3 velocity;
+        Matrix3 cov_velocity;
+
+        /** See RigidBodyState::angular_velocity */
+        Vector3 angular_velocity;
+        Matrix3 cov_angular_velocity;
+
+        /** Initializes all the values and covariances with NaN, as
+         * RigidBodyState does
+         */
+        RigidBodyStateT()
+            : position(Vector3::Constant(base::NaN<Scalar>()))
+            , cov_position(Matrix3::Constant(base::NaN<Scalar>()))
+            , orientation(Orientation(Eigen::Matrix<Scalar, 4, 1>::Constant(base::NaN<Scalar>())))
+            , cov_orientation(Matrix3::Constant(base::NaN<Scalar>()))
+            , velocity(Vector3::Constant(base::NaN<Scalar>()))
+            , cov_velocity(Matrix3::Constant(base::NaN<Scalar>()))
+            , angular_velocity(Vector3::Constant(base::NaN<Scalar>()))
+            , cov_angular_velocity(Matrix3::Constant(base::NaN<Scalar>())) {}
+
+        /** Converts from another precision */
+        template<typename OtherScalar>
+        explicit RigidBodyStateT(RigidBodyStateT<OtherScalar> const& other)
+        {
+            convert(other, *this);
+        }
+
+        /** Converts from a RigidBodyState */
+        explicit RigidBodyStateT(RigidBodyState const& other)
+        {
+            convert(other, *this);
+        }
+
+        /** Converts to another precision */
+        template<typename OtherScalar>
+        RigidBodyStateT<OtherScalar> cast() const
+        {
+            return RigidBodyStateT<OtherScalar>(*this);
+        }
+
+        /** Converts to a RigidBodyState */
+        RigidBodyState toRigidBodyState() const
+        {
+            RigidBodyState result(false);
+            convert(*this, result);
+            return result;
+        }
+
+        PoseT<Scalar> getPose() const
+        {
+            return PoseT<Scalar>(position, orientation);
+        }
+
+        void setPose(PoseT<Scalar> const& pose)
+        {
+            position = pose.position;
+            orientation = pose.orientation;
+        }
+
+    private:
+        template<typename From, typename To>
+        static void convert(From const& from, To& to)
+        {
+            typedef typename std::remove_reference<decltype(to.position[0])>::type ToScalar;
+            to.time = from.time;
+            to.sourceFrame = from.sourceFrame;
+            to.targetFrame = from.targetFrame;
+            to.position = from.position.template cast<ToScalar>();
+            to.cov_position = from.cov_position.template cast<ToScalar>();
+            to.orientation = from.orientation.template cast<ToScalar>();
+            to.cov_orientation = from.cov_orientation.template cast<ToScalar>();
+            to.velocity = from.velocity.template cast<ToScalar>();
+            to.cov_velocity = from.cov_velocity.template cast<ToScalar>();
+            to.angular_velocity = from.angular_velocity.template cast<ToScalar>();
+            to.cov_angular_velocity = from.cov_angular_velocity.template cast<ToScalar>();
+        }
+    };
+
+    typedef RigidBodyStateT<float> RigidBodyStatef;
+}}
+
+#endif
@@ -1,4 +1,6 @@
 #include <base/TimeMark.hpp>
+#include <base/Angle.hpp>
+#include <vector>
 #include <iostream>
 #include "bench_func.h"
 
@@ -78,5 +80,38 @@ int main()
 	    mult_tt4(TransformDoubleNoAlign::Identity(), TransformDoubleNoAlign::Identity());
 	std::cerr << t << std::endl;
     }
-}
+    {
+	const int angle_count = 1000000;
+	const int repeat = 100;
+	std::vector<double> bearings(angle_count);
+	for( int i=0; i<angle_count; i++ )
+	    bearings[i] = (i - angle_count / 2) * 1e-4;
 
+	std::vector<double> result(angle_count);
+	{
+	    base::TimeMark t("Angle::normalizeRad per value");
+	    for( int r=0; r<repeat; r++ )
+		for( int i=0; i<angle_count; i++ )
+		    result[i] = base::Angle::normalizeRad(bearings[i]);
+	    std::cerr << t << std::endl;
+	}
+	{
+	    base::TimeMark t("Angle::normalizeRad bulk");
+	    for( int r=0; r<repeat; r++ )
+	    {
+		result = bearings;
+		base::Angle::normalizeRad(result);
+	    }
+	    std::cerr << t << std::endl;
+	}
+	{
+	    base::TimeMark t("Angle::unwrap bulk");
+	    for( int r=0; r<repeat; r++ )
+	    {
+		base::Angle::normalizeRad(result);
+		base::Angle::unwrap(result);
+	    }
+	    std::cerr << t << std::endl;
+	}
+    }
+}
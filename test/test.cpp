@@ -2,14 +2,20 @@
 #include <boost/test/unit_test.hpp>
 
 #include <base/Angle.hpp>
+#include <base/AngleSegmentSet.hpp>
 #include <base/commands/Joints.hpp>
+#include <base/commands/CommandShaper.hpp>
 #include <base/commands/Motion2D.hpp>
 #include <base/commands/Speed6D.hpp>
 #include <base/Deprecated.hpp>
 #include <base/Eigen.hpp>
 #include <base/Float.hpp>
+#include <base/FrameId.hpp>
+#include <base/IMUPreintegrator.hpp>
 #include <base/JointState.hpp>
+#include <base/KeyframeSelector.hpp>
 #include <base/NamedVector.hpp>
+#include <base/OdometryIntegrator.hpp>
 #include <base/JointLimitRange.hpp>
 #include <base/JointLimits.hpp>
 #include <base/JointsTrajectory.hpp>
@@ -20,17 +26,21 @@
 #include <base/samples/DistanceImage.hpp>
 #include <base/samples/Frame.hpp>
 #include <base/samples/IMUSensors.hpp>
+#include <base/samples/IMUSensorsBatch.hpp>
 #include <base/samples/Joints.hpp>
 #include <base/samples/LaserScan.hpp>
 #include <base/samples/Pointcloud.hpp>
+#include <base/samples/PointcloudT.hpp>
 #include <base/samples/Pressure.hpp>
 #include <base/samples/RigidBodyAcceleration.hpp>
 #include <base/samples/RigidBodyState.hpp>
+#include <base/samples/RigidBodyStateT.hpp>
 #include <base/samples/BodyState.hpp>
 #include <base/samples/SonarBeam.hpp>
 #include <base/samples/SonarScan.hpp>
 #include <base/samples/DepthMap.hpp>
 #include <base/TransformWithCovariance.hpp>
+#include <base/TransformWithCovarianceT.hpp>
 #include <base/samples/Sonar.hpp>
 #include <base/samples/PoseWithCovariance.hpp>
 #include <base/Temperature.hpp>
@@ -38,7 +48,10 @@
 #include <base/TimeMark.hpp>
 #include <base/Trajectory.hpp>
 #include <base/Waypoint.hpp>
+#include <base/WaypointPath.hpp>
+#include <base/WaypointT.hpp>
 #include <base/TwistWithCovariance.hpp>
+#include <base/UnscentedTransform.hpp>
 
 #ifdef SISL_FOUND
 #include <base/Trajectory.hpp>
@@ -47,6 +60,7 @@
 #include <Eigen/SVD>
 #include <Eigen/LU>
 #include <Eigen/Geometry>
+#include <unistd.h>
 
 using namespace std;
 
@@ -178,6 +192,293 @@ BOOST_AUTO_TEST_CASE(body_state_operations)
     std::cout<<"Body State Composition\n"<<bs3<<std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(odometry_integrator)
+{
+    base::TwistWithCovariance twist(base::Vector3d(1, 0, 0), base::Vector3d(0, 0, 0.5));
+    twist.setCovariance(0.01 * base::Matrix6d::Identity());
+
+    // integrating a constant twist in small steps gives the same pose than a
+    // single step, as the SE(3) exponential is exact
+    base::OdometryIntegrator fine, coarse;
+    for (int i = 0; i < 1000; ++i)
+        fine.integrate(twist, 0.002);
+    coarse.integrate(twist, 2.0);
+    base::samples::BodyState fine_state = fine.getBodyState();
+    base::samples::BodyState coarse_state = coarse.getBodyState();
+    BOOST_CHECK(fine_state.getPose().isApprox(coarse_state.getPose(), 1e-9));
+
+    // a half circle of radius 2
+    base::OdometryIntegrator circle;
+    for (int i = 0; i < 100; ++i)
+        circle.integrate(twist, M_PI / 50);
+    base::samples::BodyState state = circle.getBodyState();
+    BOOST_CHECK(state.position().isApprox(base::Vector3d(0, 4, 0), 1e-9));
+    BOOST_CHECK_CLOSE(M_PI, std::abs(state.getYaw()), 1e-6);
+    BOOST_CHECK(state.hasValidPoseCovariance());
+    BOOST_CHECK(state.cov_pose().isApprox(state.cov_pose().transpose()));
+
+    // decimated output at 10Hz of a 1kHz input
+    base::OdometryIntegrator decimated;
+    decimated.setOutputPeriod(base::Time::fromMilliseconds(100));
+    int outputs = 0;
+    base::samples::BodyState output;
+    for (int i = 0; i <= 1000; ++i)
+    {
+        decimated.update(base::Time::fromMicroseconds(1000000 + i * 1000), twist);
+        if (decimated.pollOutput(output))
+            ++outputs;
+    }
+    BOOST_CHECK_EQUAL(11, outputs);
+    BOOST_CHECK_EQUAL(1000, decimated.getStepCount());
+    base::OdometryIntegrator reference;
+    reference.integrate(twist, 1.0);
+    BOOST_CHECK(output.getPose().isApprox(reference.getBodyState().getPose(), 1e-9));
+
+    // straight line along X with independent velocity noises. With
+    // q = dt^2 var_rot, the orientation variance after N steps is N q, the
+    // yaw (resp. pitch) error correlates with the Y (resp. Z) error by
+    // N (N - 1) / 2 dt q, and the lateral variance gains the lever arm
+    // term (N - 1) N (2N - 1) / 6 dt^2 q on top of the N dt^2 var_vel of
+    // the velocity noise
+    const int N = 10;
+    const double dt = 0.5, var_vel = 0.01, var_rot = 0.04;
+    base::TwistWithCovariance straight(base::Vector3d(1, 0, 0), base::Vector3d::Zero());
+    base::Matrix6d straight_cov = base::Matrix6d::Zero();
+    straight_cov.topLeftCorner<3,3>() = var_vel * base::Matrix3d::Identity();
+    straight_cov.bottomRightCorner<3,3>() = var_rot * base::Matrix3d::Identity();
+    straight.setCovariance(straight_cov);
+    base::OdometryIntegrator line;
+    for (int i = 0; i < N; ++i)
+        line.integrate(straight, dt);
+    base::samples::BodyState line_state = line.getBodyState();
+    BOOST_CHECK(line_state.position().isApprox(base::Vector3d(N * dt, 0, 0), 1e-12));
+
+    const double q = dt * dt * var_rot;
+    const double along = N * dt * dt * var_vel;
+    const double lateral = along + (N - 1) * N * (2 * N - 1) / 6.0 * dt * dt * q;
+    const double cross = N * (N - 1) / 2.0 * dt * q;
+    base::Matrix6d expected = base::Matrix6d::Zero();
+    expected.diagonal() << along, lateral, lateral, N * q, N * q, N * q;
+    expected(1, 5) = expected(5, 1) = cross;
+    expected(2, 4) = expected(4, 2) = -cross;
+    BOOST_CHECK_CLOSE(0.025, along, 1e-9);
+    BOOST_CHECK_CLOSE(0.025 + 0.7125, lateral, 1e-9);
+    BOOST_CHECK_CLOSE(0.225, cross, 1e-9);
+    for (int r = 0; r < 6; ++r)
+        for (int c = 0; c < 6; ++c)
+            BOOST_CHECK_SMALL(line_state.cov_pose()(r, c) - expected(r, c), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(imu_sensors_batch)
+{
+    std::vector<base::samples::IMUSensors> samples(5);
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        samples[i].time = base::Time::fromMicroseconds(1000000 + 500 * i);
+        samples[i].acc = base::Vector3d(i, 0, 9.81);
+        samples[i].gyro = base::Vector3d(0, i, 0);
+        samples[i].mag = base::Vector3d(0, 0, i);
+    }
+
+    base::samples::IMUSensorsBatch batch = base::samples::IMUSensorsBatch::fromSamples(samples);
+    BOOST_REQUIRE_EQUAL(5u, batch.size());
+    BOOST_CHECK(samples[0].time == batch.time);
+    BOOST_CHECK_EQUAL(2000u, batch.time_offsets.back());
+    BOOST_CHECK_CLOSE(5e-4, batch.getTimeStep(1), 1e-9);
+    BOOST_CHECK_EQUAL(10, batch.accMatrix().row(0).sum());
+    BOOST_CHECK_EQUAL(10, batch.gyroMatrix().row(1).sum());
+    BOOST_CHECK_EQUAL(10, batch.magMatrix().row(2).sum());
+
+    std::vector<base::samples::IMUSensors> result = batch.toSamples();
+    BOOST_REQUIRE_EQUAL(samples.size(), result.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        BOOST_CHECK(samples[i].time == result[i].time);
+        BOOST_CHECK(samples[i].acc == result[i].acc);
+    }
+
+    BOOST_CHECK_THROW(batch.push_back(samples[2]), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(imu_preintegration)
+{
+    const base::Vector3d gravity(0, 0, -9.81);
+
+    // at rest, the accelerometers measure the opposite of gravity
+    base::IMUPreintegrator integrator(1e-3, 1e-2);
+    for (int i = 0; i < 100; ++i)
+        integrator.integrate(-gravity, base::Vector3d::Zero(), 0.01);
+    base::PreintegratedIMU delta = integrator.getDelta();
+    BOOST_CHECK_CLOSE(1.0, delta.dt, 1e-9);
+    BOOST_CHECK((delta.delta_velocity - base::Vector3d(0, 0, 9.81)).norm() < 1e-9);
+    BOOST_CHECK((delta.delta_position - base::Vector3d(0, 0, 4.905)).norm() < 1e-9);
+
+    base::Quaterniond q_j;
+    base::Vector3d v_j, p_j;
+    base::Quaterniond q_i(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ()));
+    delta.predict(q_i, base::Vector3d(1, 0, 0), base::Vector3d(0, 0, 2), gravity, q_j, v_j, p_j);
+    BOOST_CHECK(q_j.isApprox(q_i));
+    BOOST_CHECK((v_j - base::Vector3d(1, 0, 0)).norm() < 1e-9);
+    BOOST_CHECK((p_j - base::Vector3d(1, 0, 2)).norm() < 1e-9);
+
+    // the covariance grows and stays symmetric
+    BOOST_CHECK(delta.cov.isApprox(delta.cov.transpose()));
+    BOOST_CHECK(delta.cov(0, 0) > 0 && delta.cov(3, 3) > 0 && delta.cov(6, 6) > 0);
+    BOOST_CHECK_CLOSE(1e-6, delta.cov(0, 0), 1e-6);
+    BOOST_CHECK(delta.cov(6, 6) > delta.cov(3, 3) * 0.2);
+
+    // rotating at constant rate, the streaming and batch interfaces agree
+    base::samples::IMUSensorsBatch batch;
+    integrator.reset(base::Vector3d(0, 0, 0.1), base::Vector3d(0.05, 0, 0));
+    for (int i = 0; i <= 200; ++i)
+    {
+        base::samples::IMUSensors sample;
+        sample.time = base::Time::fromMicroseconds(1000000 + 5000 * i);
+        sample.acc = base::Vector3d(0.5, std::sin(i * 0.01), 9.81);
+        sample.gyro = base::Vector3d(0, 0, 0.6);
+        sample.mag = base::Vector3d::Zero();
+        integrator.update(sample);
+        batch.push_back(sample);
+    }
+    delta = integrator.getDelta();
+    BOOST_CHECK_CLOSE(1.0, delta.dt, 1e-9);
+    BOOST_CHECK_CLOSE(0.5, Eigen::AngleAxisd(base::Quaterniond(delta.delta_rotation)).angle(), 1e-6);
+
+    base::IMUPreintegrator batch_integrator(1e-3, 1e-2);
+    batch_integrator.reset(delta.bias_gyro, delta.bias_acc);
+    batch_integrator.integrate(batch);
+    BOOST_CHECK(batch_integrator.getDelta().delta_position.isApprox(delta.delta_position));
+    BOOST_CHECK(batch_integrator.getDelta().cov.isApprox(delta.cov));
+    BOOST_CHECK(batch_integrator.getTime() == batch.getTime(batch.size() - 1));
+
+    // first-order bias correction against a new integration
+    const base::Vector3d bias_gyro(0.01, -0.02, 0.11);
+    const base::Vector3d bias_acc(0.02, 0.01, -0.03);
+    base::PreintegratedIMU corrected = delta.correct(bias_gyro, bias_acc);
+    batch_integrator.reset(bias_gyro, bias_acc);
+    batch_integrator.resetTime();
+    batch_integrator.integrate(batch);
+    base::PreintegratedIMU expected = batch_integrator.getDelta();
+    BOOST_CHECK(base::Quaterniond(corrected.delta_rotation).angularDistance(expected.delta_rotation) < 1e-4);
+    BOOST_CHECK((corrected.delta_velocity - expected.delta_velocity).norm()
+            < 0.02 * (delta.delta_velocity - expected.delta_velocity).norm());
+    BOOST_CHECK((corrected.delta_position - expected.delta_position).norm()
+            < 0.02 * (delta.delta_position - expected.delta_position).norm());
+}
+
+BOOST_AUTO_TEST_CASE(keyframe_selector)
+{
+    BOOST_CHECK_THROW(base::KeyframeSelector(base::PoseUpdateThreshold(0, 0.5)), std::invalid_argument);
+
+    base::KeyframeSelector selector(base::PoseUpdateThreshold(1.0, 0.5));
+    BOOST_CHECK_THROW(selector.getCurrentKeyframe(), std::out_of_range);
+
+    // forth and back on a line
+    std::vector<base::samples::RigidBodyState> samples;
+    for (int i = 0; i <= 40; ++i)
+    {
+        base::samples::RigidBodyState rbs;
+        rbs.time = base::Time::fromSeconds(i);
+        rbs.position = base::Position((i <= 20 ? i : 40 - i) * 0.25, 0, 0);
+        rbs.orientation = base::Orientation::Identity();
+        samples.push_back(rbs);
+    }
+
+    std::vector<base::samples::RigidBodyState> keyframes;
+    BOOST_REQUIRE_EQUAL(5u, selector.select(samples, keyframes));
+    BOOST_REQUIRE_EQUAL(5u, selector.getKeyframes().size());
+    for (size_t i = 0; i < keyframes.size(); ++i)
+    {
+        BOOST_CHECK_CLOSE(keyframes[i].position.x(), 1.25 * i, 1e-9);
+        BOOST_CHECK_EQUAL(5 * i, selector.getKeyframes()[i].sample_index);
+    }
+    // back to the start, which is a revisit of the first keyframe
+    BOOST_CHECK_EQUAL(0u, selector.getCurrentKeyframeIndex());
+
+    // rotating in place creates a new keyframe
+    base::samples::BodyState state;
+    state.pose.translation = base::Position(0.1, 0, 0);
+    state.pose.orientation = base::Orientation(Eigen::AngleAxisd(0.4, Eigen::Vector3d::UnitZ()));
+    BOOST_CHECK_EQUAL(base::KeyframeSelector::SKIPPED, selector.update(state));
+    state.pose.orientation = base::Orientation(Eigen::AngleAxisd(0.6, Eigen::Vector3d::UnitZ()));
+    BOOST_CHECK_EQUAL(base::KeyframeSelector::NEW_KEYFRAME, selector.update(state));
+    BOOST_CHECK_EQUAL(5u, selector.getCurrentKeyframeIndex());
+    state.pose.orientation = base::Orientation::Identity();
+    BOOST_CHECK_EQUAL(base::KeyframeSelector::REVISIT, selector.update(state));
+    BOOST_CHECK_EQUAL(0u, selector.getCurrentKeyframeIndex());
+
+    state.pose.invalidateTransform();
+    BOOST_CHECK_EQUAL(base::KeyframeSelector::INVALID, selector.update(state));
+
+    // without revisit detection, going back creates keyframes
+    selector.reset();
+    selector.setRevisitDetection(false);
+    keyframes.clear();
+    BOOST_CHECK_EQUAL(9u, selector.select(samples, keyframes));
+    BOOST_CHECK_EQUAL(41u, selector.getSampleCount());
+}
+
+BOOST_AUTO_TEST_CASE(waypoint_path)
+{
+    BOOST_CHECK_THROW(base::WaypointPath(0), std::invalid_argument);
+
+    // a square of side 10, with waypoints every meter
+    base::WaypointPath path(2.0);
+    BOOST_CHECK_EQUAL(-1, path.findNearest(base::Vector3d::Zero()));
+    for (int side = 0; side < 4; ++side)
+    {
+        base::Vector3d start(side == 1 || side == 2 ? 10 : 0, side >= 2 ? 10 : 0, 0);
+        base::Vector3d direction(side == 0 ? 1 : side == 2 ? -1 : 0, side == 1 ? 1 : side == 3 ? -1 : 0, 0);
+        for (int i = 0; i < 10; ++i)
+            path.push_back(base::Waypoint(base::Vector3d(start + direction * i), side * M_PI / 2, 0.6, 0.1));
+    }
+    BOOST_REQUIRE_EQUAL(40u, path.size());
+
+    for (int x = -30; x <= 130; x += 7)
+    {
+        for (int y = -30; y <= 130; y += 11)
+        {
+            base::Vector3d p(x * 0.1, y * 0.1, (x - y) * 0.01);
+            int expected = 0;
+            for (size_t i = 1; i < path.size(); ++i)
+            {
+                if ((path[i].position - p).norm() < (path[expected].position - p).norm())
+                    expected = i;
+            }
+            BOOST_CHECK_EQUAL(expected, path.findNearest(p));
+        }
+    }
+    // far away from the path, and beyond what the cell indexes can hold
+    BOOST_CHECK_EQUAL(30, path.findNearest(base::Vector3d(-1000, 1000, 0)));
+    BOOST_CHECK_EQUAL(20, path.findNearest(base::Vector3d(3e15, 3e15, 0)));
+    BOOST_CHECK_THROW(path.findNearest(base::Vector3d(base::NaN<double>(), 0, 0)), std::invalid_argument);
+    BOOST_CHECK_THROW(path.findNearest(base::Vector3d(0, base::infinity<double>(), 0)), std::invalid_argument);
+
+    std::vector<size_t> reached;
+    BOOST_CHECK_THROW(path.findReached(base::Vector3d(0, 0, base::NaN<double>()), 0, reached), std::invalid_argument);
+    BOOST_CHECK_EQUAL(0u, path.findReached(base::Vector3d(1e300, 0, 0), 0, reached));
+    BOOST_CHECK_EQUAL(2u, path.findReached(base::Vector3d(3.5, 0, 0), 0.05, reached));
+    BOOST_REQUIRE_EQUAL(2u, reached.size());
+    BOOST_CHECK_EQUAL(3u, reached[0]);
+    BOOST_CHECK_EQUAL(4u, reached[1]);
+    BOOST_CHECK_EQUAL(0u, path.findReached(base::Vector3d(3.5, 0, 0), 1, reached));
+    // the corner waypoint (10, 0) belongs to the second side
+    BOOST_CHECK_EQUAL(1u, path.findReached(base::Vector3d(10, 0, 0), M_PI / 2, reached));
+    BOOST_CHECK_EQUAL(10u, reached.back());
+
+    BOOST_CHECK_EQUAL(0u, path.updateTarget(base::Vector3d(5, 0, 0), 0));
+    BOOST_CHECK_EQUAL(1u, path.updateTarget(base::Vector3d(0.2, 0, 0), 0));
+    path.setTarget(9);
+    BOOST_CHECK_EQUAL(10u, path.updateTarget(base::Vector3d(9, 0.1, 0), 2 * M_PI));
+    BOOST_CHECK_EQUAL(11u, path.updateTarget(base::Vector3d(10, 0.3, 0), M_PI / 2));
+    path.setTarget(39);
+    BOOST_CHECK(!path.isFinished());
+    BOOST_CHECK_EQUAL(40u, path.updateTarget(base::Vector3d(0, 1, 0), -M_PI / 2));
+    BOOST_CHECK(path.isFinished());
+    BOOST_CHECK_THROW(path.getTarget(), std::out_of_range);
+    BOOST_CHECK_THROW(path.setTarget(41), std::out_of_range);
+}
+
 BOOST_AUTO_TEST_CASE(joint_state)
 {
     base::JointState state;
@@ -1231,6 +1532,106 @@ BOOST_AUTO_TEST_CASE( yaw_test )
     }
 }
 
+BOOST_AUTO_TEST_CASE( bulk_angle_test )
+{
+    std::vector<double> rad;
+    rad.push_back(M_PI);
+    rad.push_back(-M_PI);
+    rad.push_back(nextafter(-M_PI, 0));
+    rad.push_back(0);
+    rad.push_back(base::unknown<double>());
+    for (int i = -100; i <= 100; ++i)
+        rad.push_back(i * 0.37);
+
+    std::vector<base::Angle> angles = base::Angle::fromRad(rad);
+    std::vector<double> normalized(rad);
+    base::Angle::normalizeRad(normalized);
+    BOOST_REQUIRE_EQUAL( rad.size(), angles.size() );
+    BOOST_CHECK_EQUAL( M_PI, normalized[0] );
+    BOOST_CHECK_EQUAL( M_PI, normalized[1] );
+    BOOST_CHECK_EQUAL( nextafter(-M_PI, 0), normalized[2] );
+    BOOST_CHECK( base::isUnknown(normalized[4]) );
+    for (size_t i = 0; i < rad.size(); ++i)
+    {
+        if (i != 4)
+            BOOST_CHECK_CLOSE( base::Angle::normalizeRad(rad[i]) + 10, normalized[i] + 10, 1e-10 );
+        BOOST_CHECK( base::isUnknown(normalized[i]) || (normalized[i] > -M_PI && normalized[i] <= M_PI) );
+        BOOST_CHECK( base::isUnknown(angles[i].getRad()) || angles[i].getRad() == normalized[i] );
+    }
+
+    // large and huge values, alone and next to small ones, match the scalar
+    // normalization
+    std::vector<double> large;
+    for (int i = 0; i < 100; ++i)
+        large.push_back(i * 0.37);
+    large.push_back(1e6 + 0.5);
+    large.push_back(-3e7);
+    large.push_back(1e15);
+    large.push_back(-1e15);
+    large.push_back(1e17);
+    large.push_back(-1e300);
+    std::vector<double> large_normalized(large);
+    base::Angle::normalizeRad(large_normalized);
+    for (size_t i = 0; i < large.size(); ++i)
+    {
+        // -PI and PI are the same angle
+        BOOST_CHECK_SMALL( base::Angle::normalizeRad(base::Angle::normalizeRad(large[i]) - large_normalized[i]), 1e-9 );
+        BOOST_CHECK( large_normalized[i] > -M_PI && large_normalized[i] <= M_PI );
+    }
+    std::vector<double> huge(200, 1e17);
+    base::Angle::normalizeRad(huge);
+    for (size_t i = 0; i < huge.size(); ++i)
+        BOOST_CHECK_EQUAL( M_PI, huge[i] );
+
+    std::vector<base::Angle> a, b;
+    a.push_back(base::Angle::fromDeg(170));
+    b.push_back(base::Angle::fromDeg(-170));
+    a.push_back(base::Angle::fromDeg(10));
+    b.push_back(base::Angle::fromDeg(20));
+    std::vector<base::Angle> diff = base::Angle::difference(a, b);
+    BOOST_CHECK( diff[0].isApprox(base::Angle::fromDeg(-20)) );
+    BOOST_CHECK( diff[1].isApprox(base::Angle::fromDeg(-10)) );
+    BOOST_CHECK_THROW( base::Angle::difference(a, std::vector<base::Angle>()), std::invalid_argument );
+
+    BOOST_CHECK( base::Angle::mean(b).isApprox(base::Angle::fromDeg(105)) );
+    a.pop_back();
+    a.push_back(base::Angle::fromDeg(-170));
+    BOOST_CHECK( base::Angle::mean(a).isApprox(base::Angle::fromDeg(180)) );
+    BOOST_CHECK( base::isUnknown(base::Angle::mean(std::vector<base::Angle>()).getRad()) );
+
+    std::vector<double> wrapped;
+    for (int i = 0; i < 100; ++i)
+        wrapped.push_back(base::Angle::normalizeRad(i * 0.3 - 2));
+    base::Angle::unwrap(wrapped);
+    for (int i = 0; i < 100; ++i)
+        BOOST_CHECK_CLOSE( i * 0.3 - 2 + 10, wrapped[i] + 10, 1e-10 );
+}
+
+BOOST_AUTO_TEST_CASE( bulk_euler_test )
+{
+    std::vector<base::Orientation> orientations;
+    for (int i = 0; i < 100; ++i)
+        orientations.push_back(base::Orientation(Eigen::Quaterniond::UnitRandom()));
+    // gimbal lock
+    orientations.push_back(base::Orientation(Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitY())));
+
+    std::vector<base::Vector3d> exact = base::getEuler(orientations);
+    std::vector<base::Vector3d> approx = base::getEuler(orientations, base::EULER_APPROXIMATE);
+    std::vector<double> yaw = base::getYaw(orientations, base::EULER_APPROXIMATE);
+    BOOST_REQUIRE_EQUAL(orientations.size(), exact.size());
+    for (size_t i = 0; i < orientations.size(); ++i)
+    {
+        base::Vector3d expected = base::getEuler(orientations[i]);
+        BOOST_CHECK(exact[i].isApprox(expected, 1e-12));
+        BOOST_CHECK((approx[i] - expected).cwiseAbs().maxCoeff() < 2e-5);
+        BOOST_CHECK(std::abs(yaw[i] - expected[0]) < 2e-5);
+    }
+
+    base::samples::RigidBodyState rbs;
+    rbs.orientation = orientations[0];
+    BOOST_CHECK(rbs.getEuler() == base::getEuler(orientations[0]));
+}
+
 BOOST_AUTO_TEST_CASE( angle_segment )
 {
     using base::Angle;
@@ -1308,6 +1709,58 @@ BOOST_AUTO_TEST_CASE( angle_segment )
 
 }
 
+BOOST_AUTO_TEST_CASE( angle_segment_set )
+{
+    using namespace base;
+
+    std::vector<AngleSegment> segments;
+    segments.push_back(AngleSegment(Angle::fromDeg(170), Angle::deg2Rad(20)));
+    segments.push_back(AngleSegment(Angle::fromDeg(0), Angle::deg2Rad(30)));
+    segments.push_back(AngleSegment(Angle::fromDeg(20), Angle::deg2Rad(20)));
+    AngleSegmentSet set = AngleSegmentSet::fromSegments(segments);
+
+    // the segment crossing PI is split, the two overlapping ones are merged
+    BOOST_CHECK_EQUAL(3, set.size());
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(60), set.getWidth(), 1e-9);
+    BOOST_CHECK(set.isInside(Angle::fromDeg(180)));
+    BOOST_CHECK(set.isInside(Angle::fromDeg(-175)));
+    BOOST_CHECK(set.isInside(Angle::fromDeg(35)));
+    BOOST_CHECK(!set.isInside(Angle::fromDeg(45)));
+    BOOST_CHECK(!set.isInside(Angle::fromDeg(-90)));
+    BOOST_CHECK(set.isInside(AngleSegment(Angle::fromDeg(175), Angle::deg2Rad(10))));
+    BOOST_CHECK(!set.isInside(AngleSegment(Angle::fromDeg(35), Angle::deg2Rad(10))));
+
+    std::vector<AngleSegment> merged = set.getSegments();
+    BOOST_REQUIRE_EQUAL(2, merged.size());
+    BOOST_CHECK(merged[0].getStart().isApprox(Angle::fromDeg(170)));
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(20), merged[0].getWidth(), 1e-9);
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(40), merged[1].getWidth(), 1e-9);
+
+    AngleSegmentSet other(AngleSegment(Angle::fromDeg(30), Angle::deg2Rad(150)));
+    AngleSegmentSet intersection = set.intersect(other);
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(20), intersection.getWidth(), 1e-9);
+    BOOST_CHECK(intersection.isInside(Angle::fromDeg(175)));
+    BOOST_CHECK(intersection.isInside(Angle::fromDeg(35)));
+
+    AngleSegmentSet united = set.unite(other);
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(190), united.getWidth(), 1e-9);
+    BOOST_CHECK_EQUAL(1, united.getSegments().size());
+
+    AngleSegmentSet difference = set.subtract(other);
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(40), difference.getWidth(), 1e-9);
+    BOOST_CHECK(!difference.isInside(Angle::fromDeg(35)));
+    BOOST_CHECK(difference.isInside(Angle::fromDeg(-175)));
+
+    AngleSegmentSet complement = set.complement();
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(300), complement.getWidth(), 1e-9);
+    BOOST_CHECK(complement.unite(set) == AngleSegmentSet::full());
+    BOOST_CHECK(complement.intersect(set).empty());
+
+    set.insert(AngleSegment(Angle::fromDeg(-170), Angle::deg2Rad(175)));
+    BOOST_CHECK_CLOSE(Angle::deg2Rad(230), set.getWidth(), 1e-9);
+    BOOST_CHECK_EQUAL(1, set.getSegments().size());
+}
+
 BOOST_AUTO_TEST_CASE( angle_between_vectors )
 {
     using base::Angle;
@@ -1480,6 +1933,35 @@ BOOST_AUTO_TEST_CASE( rbs_validity )
     BOOST_CHECK(!rbs.hasValidAngularVelocityCovariance());
 }
 
+BOOST_AUTO_TEST_CASE( frame_id_interning )
+{
+    base::FrameId body = base::FrameId::fromName("body");
+    base::FrameId world = base::FrameId::fromName("world");
+    BOOST_CHECK(body == base::FrameId::fromName(std::string("bo") + "dy"));
+    BOOST_CHECK(body != world);
+    BOOST_CHECK(body.getName() == "body");
+    // the name is shared by all the IDs of a frame
+    BOOST_CHECK(&body.getName() == &base::FrameId::find("body").getName());
+    BOOST_CHECK(base::FrameId().getName().empty());
+    BOOST_CHECK(base::FrameId().empty());
+    BOOST_CHECK(base::FrameId::fromName("").empty());
+    BOOST_CHECK(base::FrameId::find("frame_id_interning_never_used").empty());
+
+    base::samples::RigidBodyState rbs;
+    rbs.sourceFrame = "body";
+    rbs.targetFrame = "world";
+    BOOST_CHECK(rbs.getSourceFrameId() == body);
+    BOOST_CHECK(rbs.getFramePair() == base::FramePair(body, world));
+    rbs.setSourceFrame(world);
+    BOOST_CHECK(rbs.sourceFrame == "world");
+
+    base::samples::PoseWithCovariance pose(rbs);
+    BOOST_CHECK(pose.getFrameId() == world);
+    pose.setObjectFrameId(body);
+    BOOST_CHECK(pose.object_frame_id == "body");
+    BOOST_CHECK(pose.getFramePair().inverse() == base::FramePair(world, body));
+}
+
 BOOST_AUTO_TEST_CASE( transform_with_covariance )
 {
     // test if the relative transform also 
@@ -1526,6 +2008,150 @@ BOOST_AUTO_TEST_CASE( transform_with_covariance )
     BOOST_CHECK( t1.getCovariance().isApprox( t1r.getCovariance(), sigma ) );
 }
 
+BOOST_AUTO_TEST_CASE( float_transform_types )
+{
+    base::Pose pose(base::Position(1, 2, 3),
+            base::Orientation(Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitZ())));
+    base::Posef posef(pose);
+    BOOST_CHECK( posef.toPose().position.isApprox(pose.position, 1e-6) );
+    BOOST_CHECK( posef.cast<double>().orientation.isApprox(pose.orientation, 1e-6) );
+    BOOST_CHECK( posef.toTransform().matrix().isApprox(pose.toTransform().matrix().cast<float>()) );
+
+    base::Matrix6d cov = base::Matrix6d::Identity() * 0.01;
+    base::TransformWithCovariance t1(pose.position, pose.orientation, cov);
+    base::TransformWithCovariance t2(base::Position(0, 1, 0),
+            base::Quaterniond(Eigen::AngleAxisd(0.2, Eigen::Vector3d::UnitX())), cov);
+    base::TransformWithCovariancef t1f(t1), t2f(t2);
+    BOOST_CHECK_EQUAL( sizeof(float) * (3 + 4 + 36), sizeof(base::TransformWithCovariancef) );
+
+    // the composition happens in double precision
+    base::TransformWithCovariance composed = (t1f * t2f).toTransformWithCovariance();
+    base::TransformWithCovariance expected = t1 * t2;
+    BOOST_CHECK( composed.getTransform().matrix().isApprox(expected.getTransform().matrix(), 1e-6) );
+    BOOST_CHECK( composed.getCovariance().isApprox(expected.getCovariance(), 1e-5) );
+
+    base::TransformWithCovariancef no_cov(posef.position, posef.orientation);
+    BOOST_CHECK( !no_cov.hasValidCovariance() );
+    BOOST_CHECK( !no_cov.inverse().hasValidCovariance() );
+    BOOST_CHECK( (no_cov * no_cov.inverse()).getTransform().matrix().isIdentity(1e-6) );
+}
+
+BOOST_AUTO_TEST_CASE( float_sample_types )
+{
+    base::Waypoint waypoint(base::Vector3d(1, 2, 3), 0.5, 0.1, 0.2);
+    base::Waypointf waypointf(waypoint);
+    BOOST_CHECK_EQUAL( sizeof(float) * 6, sizeof(base::Waypointf) );
+    base::Waypoint back = waypointf.toWaypoint();
+    BOOST_CHECK( back.position.isApprox(waypoint.position) );
+    BOOST_CHECK_CLOSE( back.heading, 0.5, 1e-5 );
+    BOOST_CHECK_CLOSE( back.tol_position, 0.1, 1e-5 );
+    BOOST_CHECK_CLOSE( waypointf.cast<double>().tol_heading, 0.2, 1e-5 );
+
+    base::samples::Pointcloud cloud;
+    cloud.time = base::Time::fromSeconds(10);
+    cloud.points.push_back(base::Point(1, 2, 3));
+    cloud.points.push_back(base::Point(-1, 0.5, 0));
+    cloud.colors.push_back(base::Vector4d(1, 0, 0, 1));
+    cloud.colors.push_back(base::Vector4d(0, 1, 0, 1));
+    base::samples::Pointcloudf cloudf(cloud);
+    base::samples::Pointcloud cloud_back = cloudf.toPointcloud();
+    BOOST_CHECK( cloud_back.time == cloud.time );
+    BOOST_REQUIRE_EQUAL( 2u, cloud_back.points.size() );
+    BOOST_REQUIRE_EQUAL( 2u, cloud_back.colors.size() );
+    for (size_t i = 0; i < 2; ++i)
+    {
+        BOOST_CHECK( cloud_back.points[i].isApprox(cloud.points[i]) );
+        BOOST_CHECK( cloud_back.colors[i].isApprox(cloud.colors[i]) );
+    }
+    BOOST_CHECK( cloudf.cast<double>().points[1].isApprox(cloud.points[1]) );
+
+    base::samples::RigidBodyState rbs;
+    rbs.time = base::Time::fromSeconds(2);
+    rbs.sourceFrame = "body";
+    rbs.targetFrame = "world";
+    rbs.position = base::Position(1, 2, 3);
+    rbs.cov_position = base::Matrix3d::Identity() * 0.5;
+    rbs.orientation = Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ());
+    rbs.velocity = base::Vector3d(0.1, 0, 0);
+    base::samples::RigidBodyStatef rbsf(rbs);
+    base::samples::RigidBodyState rbs_back = rbsf.toRigidBodyState();
+    BOOST_CHECK( rbs_back.time == rbs.time );
+    BOOST_CHECK_EQUAL( "body", rbs_back.sourceFrame );
+    BOOST_CHECK_EQUAL( "world", rbs_back.targetFrame );
+    BOOST_CHECK( rbs_back.position.isApprox(rbs.position) );
+    BOOST_CHECK( rbs_back.cov_position.isApprox(rbs.cov_position) );
+    BOOST_CHECK( rbs_back.orientation.isApprox(rbs.orientation, 1e-6) );
+    BOOST_CHECK( rbs_back.velocity.isApprox(rbs.velocity, 1e-6) );
+    // invalid values stay invalid
+    BOOST_CHECK( !rbs_back.hasValidOrientationCovariance() );
+    BOOST_CHECK( !rbs_back.hasValidAngularVelocity() );
+    BOOST_CHECK( rbsf.getPose().toPose().position.isApprox(rbs.position) );
+    BOOST_CHECK( !base::samples::RigidBodyStatef().toRigidBodyState().hasValidPosition() );
+}
+
+BOOST_AUTO_TEST_CASE( unscented_transform )
+{
+    base::UnscentedTransform ut;
+
+    // semi-definite covariances are supported
+    Eigen::Matrix3d A = Eigen::Vector3d(1, 0, 4).asDiagonal();
+    Eigen::Matrix3d S = base::UnscentedTransform::matrixSqrt(A);
+    BOOST_CHECK( (S * S.transpose()).isApprox(A) );
+
+    // a linear function is propagated exactly
+    Eigen::Matrix<double,6,6> linear;
+    for (int i = 0; i < 36; ++i)
+        linear(i) = std::sin(i + 1.0);
+    base::Matrix6d cov = base::Matrix6d::Identity() * 0.01;
+    cov(0, 1) = cov(1, 0) = 0.005;
+    base::TwistWithCovariance twist(base::Vector6d(1, -2, 0.5, 0.1, 0, -0.3), cov);
+    base::TwistWithCovariance result = ut.propagate(twist,
+            [&linear](base::Vector6d const& v) { return base::Vector6d(linear * v); });
+    BOOST_CHECK( result.getVelocity().isApprox(linear * twist.getVelocity(), 1e-9) );
+    BOOST_CHECK( result.getCovariance().isApprox(linear * cov * linear.transpose(), 1e-9) );
+
+    // for small uncertainties, the point composition matches the first-order
+    // propagation of TransformWithCovariance (whose rotation Jacobian is
+    // itself approximated)
+    base::Matrix6d pose_cov = base::Matrix6d::Identity() * 1e-6;
+    pose_cov(3, 4) = pose_cov(4, 3) = 5e-7;
+    base::TransformWithCovariance tf(
+            Eigen::Affine3d(Eigen::Translation3d(1, 2, 3) * Eigen::AngleAxisd(0.5, Eigen::Vector3d(1, 1, 0).normalized())),
+            pose_cov);
+    Eigen::Vector3d point(2, -1, 0.5);
+    Eigen::Matrix3d point_cov = Eigen::Matrix3d::Identity() * 1e-4;
+    std::pair<Eigen::Vector3d, Eigen::Matrix3d> linearized = tf.composePointWithCovariance(point, point_cov);
+    std::pair<Eigen::Vector3d, Eigen::Matrix3d> unscented = ut.composePointWithCovariance(tf, point, point_cov);
+    BOOST_CHECK( unscented.first.isApprox(linearized.first, 1e-6) );
+    BOOST_CHECK( unscented.second.isApprox(linearized.second, 5e-2) );
+
+    // the batch path gives the same results than single points
+    base::UnscentedTransform::PoseSigmaPoints sigma = ut.computeSigmaPoints(tf, 3);
+    std::vector<base::Vector3d> points, result_points;
+    std::vector<base::Matrix3d> covs, result_covs;
+    for (int i = 0; i < 10; ++i)
+    {
+        points.push_back(base::Vector3d(i, 5 - i, std::cos(i)) * 2);
+        covs.push_back(base::Matrix3d::Identity() * (i + 1) * 1e-3);
+    }
+    ut.composePointsWithCovariance(sigma, points, covs, result_points, result_covs);
+    BOOST_REQUIRE_EQUAL( points.size(), result_points.size() );
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        unscented = ut.composePointWithCovariance(tf, points[i], covs[i]);
+        BOOST_CHECK( result_points[i].isApprox(unscented.first, 1e-12) );
+        BOOST_CHECK( result_covs[i].isApprox(unscented.second, 1e-12) );
+    }
+    BOOST_CHECK_THROW( ut.composePointsWithCovariance(ut.computeSigmaPoints(tf), points, covs, result_points, result_covs),
+            std::invalid_argument );
+
+    // the identity function gives back the input transformation
+    base::TransformWithCovariance same = ut.propagate(tf,
+            [](Eigen::Affine3d const& pose) { return pose; });
+    BOOST_CHECK( same.getTransform().matrix().isApprox(tf.getTransform().matrix(), 1e-9) );
+    BOOST_CHECK( same.getCovariance().isApprox(tf.getCovariance(), 1e-6) );
+}
+
 BOOST_AUTO_TEST_CASE( pose_with_covariance )
 {
     base::samples::RigidBodyState rbs;
@@ -1605,6 +2231,98 @@ BOOST_AUTO_TEST_CASE( pose_with_covariance )
     BOOST_CHECK( sensor_in_body.getCovariance().isApprox( sensor_in_body_r.getCovariance(), 1e-12 ) );
 }
 
+BOOST_AUTO_TEST_CASE( command_shaper )
+{
+    using namespace base::commands;
+
+    // acceleration limit only
+    Motion2DShaper shaper(ShapingLimits(0.5), ShapingLimits(1.0), ShapingLimits(0.1));
+    shaper.reset(Motion2D());
+    Motion2D target(1.0, -0.2, base::Angle::fromRad(0));
+    Motion2D cmd;
+    for (int i = 0; i < 10; ++i)
+        cmd = shaper.update(target, 0.1);
+    BOOST_CHECK_CLOSE(0.5, cmd.translation, 1e-9);
+    BOOST_CHECK_CLOSE(-0.2, cmd.rotation, 1e-9);
+
+    // the heading takes the shortest way, through PI
+    shaper.reset(Motion2D(0, 0, base::Angle::fromRad(3.0)));
+    for (int i = 0; i < 10; ++i)
+        cmd = shaper.update(Motion2D(0, 0, base::Angle::fromRad(-3.0)), 0.1);
+    BOOST_CHECK_CLOSE(3.1, cmd.heading.getRad(), 1e-9);
+    for (int i = 0; i < 30; ++i)
+        cmd = shaper.update(Motion2D(0, 0, base::Angle::fromRad(-3.0)), 0.1);
+    BOOST_CHECK_CLOSE(-3.0, cmd.heading.getRad(), 1e-9);
+
+    // jerk limit: smooth, no overshoot, and in batch
+    Motion2DShaper smooth(ShapingLimits(1.0, 2.0), ShapingLimits());
+    smooth.reset(Motion2D());
+    std::vector<Motion2D> targets(500, Motion2D(1.0, 0.5));
+    std::vector<Motion2D> output;
+    smooth.update(targets, 0.01, output);
+    BOOST_REQUIRE_EQUAL(targets.size(), output.size());
+    double last = 0, last_acc = 0;
+    for (size_t i = 0; i < output.size(); ++i)
+    {
+        double acc = (output[i].translation - last) / 0.01;
+        BOOST_REQUIRE(output[i].translation >= last && output[i].translation <= 1.0);
+        BOOST_REQUIRE(acc <= 1.0 + 1e-9);
+        if (output[i].translation < 1.0)
+            BOOST_REQUIRE(std::abs(acc - last_acc) <= 2.0 * 0.01 + 1e-9);
+        last = output[i].translation;
+        last_acc = acc;
+    }
+    BOOST_CHECK_EQUAL(1.0, output.back().translation);
+    BOOST_CHECK_EQUAL(0.5, output[0].rotation);
+
+    // 6D commands, using the timestamps
+    LinearAngular6DShaper shaper6d(ShapingLimits(1.0), ShapingLimits(2.0));
+    LinearAngular6DCommand command;
+    command.time = base::Time::fromSeconds(10);
+    command.linear = base::Vector3d::Zero();
+    command.yaw() = 0;
+    LinearAngular6DCommand shaped = shaper6d.update(command);
+    BOOST_CHECK_EQUAL(0, shaped.x());
+    BOOST_CHECK(base::isUnset(shaped.roll()));
+
+    command.time = base::Time::fromSeconds(10.5);
+    command.linear = base::Vector3d(1, -1, 0.2);
+    command.yaw() = 5;
+    shaped = shaper6d.update(command);
+    BOOST_CHECK_CLOSE(0.5, shaped.x(), 1e-9);
+    BOOST_CHECK_CLOSE(-0.5, shaped.y(), 1e-9);
+    BOOST_CHECK_CLOSE(0.2, shaped.z(), 1e-9);
+    BOOST_CHECK_CLOSE(1.0, shaped.yaw(), 1e-9);
+    BOOST_CHECK(command.time == shaped.time);
+
+    // older commands are ignored, unset components reset their channel
+    command.time = base::Time::fromSeconds(10.2);
+    BOOST_CHECK_CLOSE(0.5, shaper6d.update(command).x(), 1e-9);
+    command.time = base::Time::fromSeconds(11);
+    command.yaw() = base::unset<double>();
+    shaped = shaper6d.update(command);
+    BOOST_CHECK(base::isUnset(shaped.yaw()));
+    command.time = base::Time::fromSeconds(11.5);
+    command.yaw() = 5;
+    BOOST_CHECK_EQUAL(5, shaper6d.update(command).yaw());
+
+    // commands without a timestamp use the reception time
+    shaper6d.reset();
+    command.time = base::Time();
+    command.linear = base::Vector3d::Zero();
+    shaper6d.update(command);
+    command.linear = base::Vector3d(1, 0, 0);
+    double last_x = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        usleep(10000);
+        shaped = shaper6d.update(command);
+        BOOST_CHECK_GT(shaped.x(), last_x);
+        BOOST_CHECK_LT(shaped.x(), 1);
+        last_x = shaped.x();
+    }
+}
+
 #ifdef SISL_FOUND
 #include <base/geometry/spline.h>
 BOOST_AUTO_TEST_CASE( spline_to_points )
@@ -1,5 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include <base/Eigen.hpp>
+#include <base/Float.hpp>
+#include <base/Matrix.hpp>
 #include <iostream>
 #include "../src/TwistWithCovariance.cpp"
 
@@ -24,4 +26,110 @@ BOOST_AUTO_TEST_CASE(test_SPD)
     test_SPD_helper(Eigen::MatrixXd::Random(10,10), 1e-15);
 }
 
+BOOST_AUTO_TEST_CASE(test_sanitize_covariance)
+{
+    // already valid, semi-definite matrices included
+    base::Matrix3d valid = base::Vector3d(1, 2, 0).asDiagonal();
+    base::Matrix3d A = valid;
+    BOOST_CHECK(base::isSPD(A));
+    BOOST_CHECK_EQUAL(base::COVARIANCE_VALID, base::sanitizeCovariance(A));
+    BOOST_CHECK(A == valid);
+
+    // rounding errors are fixed by a small boost of the diagonal
+    base::Matrix3d rounded;
+    rounded << 1, 1, 0,
+               1, 1 - 1e-12, 0,
+               0, 0, 1;
+    A = rounded;
+    BOOST_CHECK(!base::isSPD(A));
+    BOOST_CHECK_EQUAL(base::COVARIANCE_BOOSTED, base::sanitizeCovariance(A));
+    BOOST_CHECK(base::isSPD(A));
+    BOOST_CHECK((A - rounded).norm() < 1e-6);
+
+    // really indefinite matrices are projected
+    base::Matrix6d B = base::Matrix6d::Identity();
+    B(2, 2) = -1;
+    B(5, 0) = B(0, 5) = 0.5;
+    base::Matrix6d expected = base::guaranteeSPD(B, 1e-3);
+    BOOST_CHECK_EQUAL(base::COVARIANCE_PROJECTED, base::sanitizeCovariance(B, 1e-3));
+    BOOST_CHECK(B.isApprox(expected));
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6> > eig(B);
+    BOOST_CHECK(eig.eigenvalues().minCoeff() > 1e-3 - 1e-12);
+
+    A = base::Vector3d(1, -1, 1).asDiagonal();
+    BOOST_CHECK_EQUAL(base::COVARIANCE_PROJECTED, base::sanitizeCovariance(A));
+    BOOST_CHECK(A.isApprox(base::Matrix3d(base::Vector3d(1, 0, 1).asDiagonal())));
+
+    A(1, 1) = base::unknown<double>();
+    BOOST_CHECK_EQUAL(base::COVARIANCE_INVALID, base::sanitizeCovariance(A));
+
+    std::vector<base::Matrix3d> covs(4, valid);
+    covs[1] = rounded;
+    covs[2] = base::Vector3d(1, -1, 1).asDiagonal();
+    covs[3](0, 0) = base::unknown<double>();
+    base::CovarianceRepairStats stats = base::sanitizeCovariances(covs);
+    BOOST_CHECK_EQUAL(1u, stats.valid);
+    BOOST_CHECK_EQUAL(1u, stats.boosted);
+    BOOST_CHECK_EQUAL(1u, stats.projected);
+    BOOST_CHECK_EQUAL(1u, stats.invalid);
+    for (size_t i = 0; i < 3; ++i)
+        BOOST_CHECK(base::isSPD(covs[i]));
+}
+
+BOOST_AUTO_TEST_CASE(test_bulk_float_checks)
+{
+    std::vector<double> values(200, 1.0);
+    BOOST_CHECK(!base::anyNaN(values.data(), values.size()));
+    BOOST_CHECK(base::allFinite(values.data(), values.size()));
+
+    values[150] = base::infinity<double>();
+    BOOST_CHECK(!base::anyNaN(values.data(), values.size()));
+    BOOST_CHECK(!base::allFinite(values.data(), values.size()));
+    values[70] = base::NaN<double>();
+    values[199] = -base::NaN<double>();
+    BOOST_CHECK(base::anyNaN(values.data(), values.size()));
+    BOOST_CHECK_EQUAL(2u, base::countNaN(values.data(), values.size()));
+    BOOST_CHECK_EQUAL(3u, base::countNonFinite(values.data(), values.size()));
+
+    std::vector<float> floats(10, -std::numeric_limits<float>::max());
+    floats[3] = -base::infinity<float>();
+    floats[4] = base::NaN<float>();
+    bool mask[10];
+    BOOST_CHECK_EQUAL(1u, base::maskNaN(floats.data(), floats.size(), mask));
+    BOOST_CHECK(mask[4] && !mask[3]);
+    BOOST_CHECK_EQUAL(2u, base::maskNonFinite(floats.data(), floats.size(), mask));
+    for (size_t i = 0; i < floats.size(); ++i)
+        BOOST_CHECK_EQUAL(mask[i], !std::isfinite(floats[i]));
+
+    // maps, blocks and expressions
+    Eigen::Map<Eigen::MatrixXd> map(values.data(), 20, 10);
+    BOOST_CHECK(!base::isnotnan(map));
+    BOOST_CHECK(base::isnotnan(map.block(0, 0, 20, 3)));
+    BOOST_CHECK(!base::isfinite(map.block(5, 6, 15, 2)));
+    BOOST_CHECK(base::isfinite(map.block(0, 6, 10, 4)));
+    BOOST_CHECK_EQUAL(2u, base::countNaN(map));
+    BOOST_CHECK_EQUAL(3u, base::countNonFinite(map));
+    BOOST_CHECK_EQUAL(1u, base::countNaN(map.row(19)));
+    BOOST_CHECK(base::isnotnan(map.block(0, 0, 2, 2) * 2.0));
+    BOOST_CHECK(base::isnotnan(Eigen::Vector3i(1, 2, 3)));
+}
+
+BOOST_AUTO_TEST_CASE(test_aligned_conversion)
+{
+    base::Quaterniond q(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ()));
+    base::Affine3d t(q);
+    t.translation() = base::Vector3d(1, 2, 3);
+
+    base::aligned::Quaterniond aq = base::toAligned(q);
+    base::aligned::Affine3d at = base::toAligned(t);
+    base::aligned::Vector3d av = base::toAligned(t.translation());
+    BOOST_CHECK(aq.coeffs() == q.coeffs());
+    BOOST_CHECK(at.matrix() == t.matrix());
+    BOOST_CHECK(av == base::Vector3d(1, 2, 3));
+
+    base::aligned::vector<base::aligned::Affine3d> transforms(3, at);
+    base::Affine3d back(transforms[2] * at);
+    BOOST_CHECK(back.matrix().isApprox((t * t).matrix()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
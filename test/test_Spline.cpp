@@ -2,6 +2,7 @@
 #include <base/Eigen.hpp>
 #include <iostream>
 #include <base/geometry/Spline.hpp>
+#include <base/WaypointPath.hpp>
 
 
 BOOST_AUTO_TEST_SUITE(Spline)
@@ -43,5 +44,30 @@ BOOST_AUTO_TEST_CASE(test_derive_singleton_raises)
     BOOST_REQUIRE_THROW(spline.derive(1), std::invalid_argument);
 }
 
+BOOST_AUTO_TEST_CASE(test_waypoint_path_to_trajectory)
+{
+    base::WaypointPath path;
+    BOOST_REQUIRE_THROW(path.toTrajectory(1), std::runtime_error);
+
+    path.push_back(base::Waypoint(base::Vector3d(1, 2, 3), 0, 0.1, 0.1));
+    base::Trajectory singleton = path.toTrajectory(2);
+    BOOST_CHECK_EQUAL(2, singleton.speed);
+    BOOST_CHECK(singleton.spline.isSingleton());
+    BOOST_CHECK(singleton.spline.getStartPoint().isApprox(base::Vector3d(1, 2, 3)));
+
+    for (int i = 1; i < 5; ++i)
+        path.push_back(base::Waypoint(base::Vector3d(1 + i, 2 + (i % 2), 3), 0, 0.1, 0.1));
+    base::Trajectory trajectory = path.toTrajectory(-1);
+    BOOST_CHECK_EQUAL(-1, trajectory.speed);
+    BOOST_CHECK(!trajectory.spline.isSingleton());
+    BOOST_CHECK(trajectory.spline.getStartPoint().isApprox(path[0].position));
+    BOOST_CHECK(trajectory.spline.getEndPoint().isApprox(path[4].position));
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        double t = trajectory.spline.findOneClosestPoint(path[i].position, 1e-3);
+        BOOST_CHECK_SMALL((trajectory.spline.getPoint(t) - path[i].position).norm(), 1e-3);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
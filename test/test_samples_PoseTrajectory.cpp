@@ -0,0 +1,137 @@
+#include <boost/test/unit_test.hpp>
+#include <base/samples/PoseTrajectory.hpp>
+
+using namespace base;
+using namespace base::samples;
+
+BOOST_AUTO_TEST_SUITE(samples_PoseTrajectory)
+
+static PoseTrajectory makeStraightLine(size_t count)
+{
+    PoseTrajectory trajectory;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Pose pose(Position(i, 0, 0), Orientation(Eigen::AngleAxisd(0.1 * i, Eigen::Vector3d::UnitZ())));
+        trajectory.push_back(Time::fromSeconds(static_cast<int>(i)), pose);
+    }
+    return trajectory;
+}
+
+BOOST_AUTO_TEST_CASE(it_converts_from_and_to_rigid_body_states)
+{
+    std::vector<RigidBodyState> states;
+    for (int i = 0; i < 5; ++i)
+    {
+        RigidBodyState rbs;
+        rbs.time = Time::fromSeconds(i);
+        rbs.position = Position(i, 2 * i, 3 * i);
+        rbs.orientation = Eigen::AngleAxisd(0.2 * i, Eigen::Vector3d::UnitX());
+        rbs.cov_position = Matrix3d::Identity() * i;
+        rbs.cov_orientation = Matrix3d::Identity() * 2 * i;
+        states.push_back(rbs);
+    }
+
+    PoseTrajectory trajectory = PoseTrajectory::fromRigidBodyStates(states, true);
+    BOOST_REQUIRE_EQUAL(5, trajectory.size());
+    BOOST_REQUIRE(trajectory.hasCovariance());
+
+    std::vector<RigidBodyState> result = trajectory.toRigidBodyStates("body", "world");
+    BOOST_REQUIRE_EQUAL(5, result.size());
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        BOOST_CHECK(result[i].time == states[i].time);
+        BOOST_CHECK(result[i].position.isApprox(states[i].position));
+        BOOST_CHECK(result[i].orientation.isApprox(states[i].orientation));
+        BOOST_CHECK(result[i].cov_orientation.isApprox(states[i].cov_orientation));
+        BOOST_CHECK_EQUAL("body", result[i].sourceFrame);
+        BOOST_CHECK_EQUAL("world", result[i].targetFrame);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(the_first_rigid_body_state_decides_whether_covariances_are_stored)
+{
+    RigidBodyState rbs;
+    rbs.time = Time::fromSeconds(1);
+    rbs.position = Position(1, 2, 3);
+    rbs.orientation = Orientation::Identity();
+    rbs.cov_position = Matrix3d::Identity() * 0.5;
+    rbs.cov_orientation = Matrix3d::Identity() * 0.1;
+
+    PoseTrajectory trajectory;
+    trajectory.push_back(rbs);
+    BOOST_REQUIRE(trajectory.hasCovariance());
+    BOOST_CHECK(trajectory.cov_position[0].isApprox(rbs.cov_position));
+    BOOST_CHECK(trajectory.cov_orientation[0].isApprox(rbs.cov_orientation));
+
+    rbs.cov_position = Matrix3d::Identity() * 2;
+    trajectory.push_back(rbs);
+    BOOST_REQUIRE_EQUAL(2, trajectory.size());
+    BOOST_REQUIRE(trajectory.hasCovariance());
+    BOOST_CHECK(trajectory.cov_position[1].isApprox(rbs.cov_position));
+    BOOST_CHECK(trajectory.getRigidBodyState(0, "body", "world").cov_position.isApprox(Matrix3d::Identity() * 0.5));
+
+    rbs.invalidateCovariances();
+    PoseTrajectory without;
+    without.push_back(rbs);
+    BOOST_CHECK(!without.hasCovariance());
+    BOOST_CHECK_THROW(without.push_back(rbs.time, rbs.getPose(), Matrix3d::Identity(), Matrix3d::Identity()),
+            std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(transform_applies_the_transformation_to_all_poses)
+{
+    PoseTrajectory trajectory = makeStraightLine(10);
+    std::vector<Pose> poses = trajectory.toPoses();
+
+    Eigen::Affine3d t(Eigen::AngleAxisd(0.5, Eigen::Vector3d(1, 2, 3).normalized()));
+    t.translation() = Eigen::Vector3d(1, -2, 0.5);
+    trajectory.transform(t);
+
+    for (size_t i = 0; i < poses.size(); ++i)
+    {
+        Eigen::Affine3d expected = t * poses[i].toTransform();
+        BOOST_CHECK(trajectory.getTransform(i).isApprox(expected));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(relative_poses_compose_back_to_the_trajectory)
+{
+    PoseTrajectory trajectory = makeStraightLine(10);
+    PoseTrajectory relative = trajectory.relativePoses();
+    BOOST_REQUIRE_EQUAL(9, relative.size());
+
+    Eigen::Affine3d pose = trajectory.getTransform(0);
+    for (size_t i = 0; i < relative.size(); ++i)
+    {
+        pose = pose * relative.getTransform(i);
+        BOOST_CHECK(pose.isApprox(trajectory.getTransform(i + 1)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cumulative_distance_sums_the_segment_lengths)
+{
+    PoseTrajectory trajectory = makeStraightLine(10);
+    std::vector<double> distance = trajectory.cumulativeDistance();
+    BOOST_REQUIRE_EQUAL(10, distance.size());
+    for (size_t i = 0; i < distance.size(); ++i)
+        BOOST_CHECK_CLOSE(static_cast<double>(i), distance[i], 1e-9);
+    BOOST_CHECK_CLOSE(9.0, trajectory.length(), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(resample_interpolates_between_samples)
+{
+    PoseTrajectory trajectory = makeStraightLine(3);
+    PoseTrajectory resampled = trajectory.resample(Time::fromMilliseconds(500));
+    BOOST_REQUIRE_EQUAL(5, resampled.size());
+    BOOST_CHECK_CLOSE(1.5, resampled.positions[3].x(), 1e-9);
+    BOOST_CHECK_CLOSE(0.15, Eigen::AngleAxisd(resampled.orientations[3]).angle(), 1e-6);
+
+    std::vector<Time> query;
+    query.push_back(Time::fromSeconds(-1));
+    query.push_back(Time::fromSeconds(10));
+    resampled = trajectory.resample(query);
+    BOOST_CHECK(resampled.positions[0].isApprox(trajectory.positions.front()));
+    BOOST_CHECK(resampled.positions[1].isApprox(trajectory.positions.back()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
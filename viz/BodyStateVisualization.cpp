@@ -335,6 +335,40 @@ void BodyStateVisualization::displayCovarianceWithSamples(bool enable)
 bool BodyStateVisualization::isCovarianceDisplayedWithSamples() const
 { return covariance_with_samples; }
 
+void BodyStateVisualization::displayTrail(bool enable)
+{
+    trail.setEnabled(enable);
+    setDirty();
+    emit propertyChanged("displayTrail");
+}
+bool BodyStateVisualization::isTrailDisplayed() const
+{ return trail.isEnabled(); }
+
+void BodyStateVisualization::setTrailLength(int length)
+{
+    trail.setLength(length);
+    setDirty();
+    emit propertyChanged("trailLength");
+}
+int BodyStateVisualization::getTrailLength() const
+{ return trail.getLength(); }
+
+void BodyStateVisualization::setTrailMinDistance(double distance)
+{ trail.setMinDistance(distance); emit propertyChanged("trailMinDistance"); }
+double BodyStateVisualization::getTrailMinDistance() const
+{ return trail.getMinDistance(); }
+
+void BodyStateVisualization::setTrailMinAngle(double angle)
+{ trail.setMinAngle(angle); emit propertyChanged("trailMinAngle"); }
+double BodyStateVisualization::getTrailMinAngle() const
+{ return trail.getMinAngle(); }
+
+void BodyStateVisualization::clearTrail()
+{
+    trail.clear();
+    setDirty();
+}
+
 ref_ptr<Node> BodyStateVisualization::createMainNode()
 {
     Group* group = new Group;
@@ -344,6 +378,8 @@ ref_ptr<Node> BodyStateVisualization::createMainNode()
         resetModel(total_size);
     body_pose->addChild(body_model);
     group->addChild(body_pose);
+    // world-fixed, unlike the body
+    group->addChild(trail.createNode());
 
     texture = new osg::Texture2D;
     texture->setWrap(Texture::WRAP_S, Texture::REPEAT);
@@ -374,12 +410,12 @@ void BodyStateVisualization::updateMainNode(Node* node)
     // uncertainty child accordingly
     bool needs_uncertainty = covariance && state.hasValidPoseCovariance();
     Uncertainty* uncertainty = 0;
-    if (group->getNumChildren() > 1)
+    if (group->getNumChildren() > 2)
     {
         if (needs_uncertainty)
-            uncertainty = dynamic_cast<Uncertainty*>(group->getChild(1));
+            uncertainty = dynamic_cast<Uncertainty*>(group->getChild(2));
         else
-            group->removeChild(1);
+            group->removeChild(2);
     }
     else if (needs_uncertainty)
     {
@@ -397,6 +433,8 @@ void BodyStateVisualization::updateMainNode(Node* node)
     else if (body_node != body_model)
         body_pose->setChild(0, body_model);
 
+    trail.updateNode(osg::Vec4(color.x(), color.y(), color.z(), 1), translation);
+
     if (texture_dirty)
         updateTexture();
     if (bump_mapping_dirty)
@@ -429,6 +467,8 @@ void BodyStateVisualization::updateMainNode(Node* node)
 void BodyStateVisualization::updateDataIntern( const base::samples::BodyState& state )
 {
     this->state = state;
+    if (state.hasValidPose())
+        trail.update(state.getPose());
 }
 
 }
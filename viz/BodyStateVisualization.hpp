@@ -7,6 +7,7 @@
 
 #include <osg/Image>
 #include <osg/Texture2D>
+#include "PoseTrailNode.hpp"
 
 namespace osgFX
 {
@@ -23,6 +24,10 @@ class BodyStateVisualization : public Vizkit3DPlugin<base::samples::BodyState>
         Q_PROPERTY(double sphereSize READ getMainSphereSize WRITE setMainSphereSize)
         Q_PROPERTY(bool displayCovariance READ isCovarianceDisplayed WRITE displayCovariance)
         Q_PROPERTY(bool displayCovarianceWithSamples READ isCovarianceDisplayedWithSamples WRITE displayCovarianceWithSamples)
+        Q_PROPERTY(bool displayTrail READ isTrailDisplayed WRITE displayTrail)
+        Q_PROPERTY(int trailLength READ getTrailLength WRITE setTrailLength)
+        Q_PROPERTY(double trailMinDistance READ getTrailMinDistance WRITE setTrailMinDistance)
+        Q_PROPERTY(double trailMinAngle READ getTrailMinAngle WRITE setTrailMinAngle)
         Q_PROPERTY(bool forcePositionDisplay READ isPositionDisplayForced WRITE setPositionDisplayForceFlag)
         Q_PROPERTY(bool forceOrientationDisplay READ isOrientationDisplayForced WRITE setOrientationDisplayForceFlag)
         Q_PROPERTY(QString modelPath READ getModelPath WRITE loadModel)
@@ -78,6 +83,26 @@ class BodyStateVisualization : public Vizkit3DPlugin<base::samples::BodyState>
         void displayCovarianceWithSamples(bool enable);
         bool isCovarianceDisplayedWithSamples() const;
 
+        /** Displays the last positions of the body as a line, in the color
+         * of the body. The trail starts empty each time it is enabled */
+        void displayTrail(bool enable);
+        bool isTrailDisplayed() const;
+        /** Sets the maximum number of positions of the trail
+         *
+         * The default is 10000
+         */
+        void setTrailLength(int length);
+        int getTrailLength() const;
+        /** Sets the minimal distance, in meters, between two positions of
+         * the trail. The default is zero */
+        void setTrailMinDistance(double distance);
+        double getTrailMinDistance() const;
+        /** Sets the minimal rotation, in radians, between two positions of
+         * the trail. The default is zero */
+        void setTrailMinAngle(double angle);
+        double getTrailMinAngle() const;
+        void clearTrail();
+
         /** Sets the color of the default body model in R, G, B
          *
          * Values must be between 0 and 1
@@ -107,6 +132,8 @@ class BodyStateVisualization : public Vizkit3DPlugin<base::samples::BodyState>
     private:
         bool covariance;
         bool covariance_with_samples;
+
+        PoseTrailController trail;
         base::Vector3d color;
         double total_size;
         double main_size;
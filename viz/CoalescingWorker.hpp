@@ -0,0 +1,219 @@
+#ifndef COALESCING_WORKER_HPP
+#define COALESCING_WORKER_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <boost/noncopyable.hpp>
+
+namespace vizkit3d
+{
+
+/**
+ * Processes samples on a worker thread, keeping only the latest one
+ *
+ * push() stores a copy of the sample and returns immediately. If the worker
+ * has not started processing the previously pushed sample yet, that sample
+ * is dropped, so that bursts of samples are coalesced and the worker never
+ * lags behind the producer.
+ *
+ * The worker processes into its own output, which is then handed over to
+ * the consumer by fetch(), by swapping. Outputs are therefore reused across
+ * samples, and should be cheap to swap (e.g. hold their data in
+ * std::vector).
+ *
+ * Exceptions thrown by the processing function are forwarded to the
+ * consumer, and rethrown by the next fetch().
+ *
+ * The optional notification function is called from the worker thread
+ * each time a result or an error is available, e.g. to mark a plugin as
+ * dirty so that it fetches the result on its next update.
+ */
+template<typename Input, typename Output>
+class CoalescingWorker : boost::noncopyable
+{
+public:
+    typedef std::function<void (Input const&, Output&)> Process;
+    typedef std::function<void ()> Notify;
+
+    explicit CoalescingWorker(Process process, Notify notify = Notify())
+        : process(process)
+        , notify(notify)
+        , write_slot(0)
+        , has_input(false)
+        , has_pending(false)
+        , busy(false)
+        , has_result(false)
+        , stopping(false)
+        , dropped(0)
+        , processed(0)
+    {
+        thread = std::thread(&CoalescingWorker::run, this);
+    }
+
+    ~CoalescingWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        thread.join();
+    }
+
+    /** Queues a sample for processing, replacing the one that is queued
+     * if there is one */
+    void push(Input const& input)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // the worker only reads the other slot
+            slots[write_slot] = input;
+            if (has_pending)
+                ++dropped;
+            has_input = true;
+            has_pending = true;
+        }
+        wakeup.notify_all();
+    }
+
+    /** Queues the last pushed sample again, e.g. because a parameter of the
+     * processing changed
+     *
+     * Does nothing if no sample has been pushed yet, or if a sample is
+     * already queued, as it will be processed with the new parameters
+     * anyway.
+     */
+    void repeat()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (has_pending || !has_input)
+                return;
+            // the last sample is in the slot that is not written to. If
+            // the worker is still processing it, it is only read on both
+            // sides
+            if (busy)
+                slots[write_slot] = slots[1 - write_slot];
+            else
+                write_slot = 1 - write_slot;
+            has_pending = true;
+        }
+        wakeup.notify_all();
+    }
+
+    /** Gives the latest result to the consumer, by swapping it with @a
+     * output
+     *
+     * @return true if there was a new result, false otherwise (output is
+     *   then left untouched)
+     */
+    bool fetch(Output& output)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error)
+        {
+            std::exception_ptr e = error;
+            error = std::exception_ptr();
+            std::rethrow_exception(e);
+        }
+        if (!has_result)
+            return false;
+        using std::swap;
+        swap(output, result);
+        has_result = false;
+        return true;
+    }
+
+    /** Waits until the queued sample, if any, has been processed */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (has_pending || busy)
+            idle.wait(lock);
+    }
+
+    /** Number of samples that have been replaced before being processed */
+    size_t getDroppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped;
+    }
+
+    /** Number of samples that have been processed */
+    size_t getProcessedCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return processed;
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            while (!has_pending && !stopping)
+                wakeup.wait(lock);
+            if (stopping)
+                return;
+
+            const int read_slot = write_slot;
+            write_slot = 1 - write_slot;
+            has_pending = false;
+            busy = true;
+            lock.unlock();
+
+            std::exception_ptr process_error;
+            try { process(slots[read_slot], working); }
+            catch (...) { process_error = std::current_exception(); }
+
+            lock.lock();
+            if (process_error)
+                error = process_error;
+            else
+            {
+                using std::swap;
+                swap(working, result);
+                has_result = true;
+                ++processed;
+            }
+            busy = false;
+            idle.notify_all();
+
+            if (notify)
+            {
+                lock.unlock();
+                notify();
+                lock.lock();
+            }
+        }
+    }
+
+    Process process;
+    Notify notify;
+    Input slots[2];
+    int write_slot;
+    bool has_input;
+    Output working;
+    Output result;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable idle;
+    bool has_pending;
+    bool busy;
+    bool has_result;
+    bool stopping;
+    std::exception_ptr error;
+    size_t dropped;
+    size_t processed;
+
+    std::thread thread;
+};
+
+}
+#endif
@@ -0,0 +1,207 @@
+#include "DepthMapGeometry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace vizkit3d
+{
+
+const float DepthMapGeometry::SLOPE_MAX_RATIO = 1.3f;
+
+namespace
+{
+    /** Gives access to the projection tables of a depth map, which are
+     * computed by protected methods. Only the projection fields are copied */
+    struct DepthMapProjection : public base::samples::DepthMap
+    {
+        typedef Eigen::Transform<float, 3, Eigen::Affine> Transform;
+
+        explicit DepthMapProjection(base::samples::DepthMap const& depth_map)
+        {
+            vertical_projection = depth_map.vertical_projection;
+            horizontal_projection = depth_map.horizontal_projection;
+            vertical_interval = depth_map.vertical_interval;
+            horizontal_interval = depth_map.horizontal_interval;
+            vertical_size = depth_map.vertical_size;
+            horizontal_size = depth_map.horizontal_size;
+        }
+
+        void compute(base::aligned::vector<Transform>& rows2column,
+                     base::aligned::vector<Transform>& columns2pointcloud) const
+        {
+            computeLocalTransformations(rows2column, columns2pointcloud);
+        }
+    };
+
+    /** Same as DepthMap::isMeasurementValid(scalar), which is not inline */
+    inline bool isValid(float distance)
+    {
+        return distance > 0 && distance <= std::numeric_limits<float>::max();
+    }
+}
+
+DepthMapGeometry::DepthMapGeometry(unsigned row_stride, unsigned col_stride)
+    : row_stride(1)
+    , col_stride(1)
+    , rows(0)
+    , cols(0)
+    , cached(false)
+    , vertical_projection(base::samples::DepthMap::POLAR)
+    , horizontal_projection(base::samples::DepthMap::POLAR)
+    , vertical_size(0)
+    , horizontal_size(0)
+    , projection_updates(0)
+{
+    setStride(row_stride, col_stride);
+}
+
+void DepthMapGeometry::setStride(unsigned row_stride, unsigned col_stride)
+{
+    if (row_stride == 0 || col_stride == 0)
+        throw std::invalid_argument("DepthMapGeometry: strides must be strictly positive");
+    if (row_stride != this->row_stride || col_stride != this->col_stride)
+        cached = false;
+    this->row_stride = row_stride;
+    this->col_stride = col_stride;
+}
+
+bool DepthMapGeometry::isProjectionCached(base::samples::DepthMap const& depth_map) const
+{
+    return cached
+        && vertical_size == depth_map.vertical_size
+        && horizontal_size == depth_map.horizontal_size
+        && vertical_projection == depth_map.vertical_projection
+        && horizontal_projection == depth_map.horizontal_projection
+        && vertical_interval == depth_map.vertical_interval
+        && horizontal_interval == depth_map.horizontal_interval;
+}
+
+void DepthMapGeometry::updateProjection(base::samples::DepthMap const& depth_map)
+{
+    cached = false;
+    base::aligned::vector<DepthMapProjection::Transform> rows2column;
+    base::aligned::vector<DepthMapProjection::Transform> columns2pointcloud;
+    DepthMapProjection(depth_map).compute(rows2column, columns2pointcloud);
+
+    rows = (depth_map.vertical_size + row_stride - 1) / row_stride;
+    cols = (depth_map.horizontal_size + col_stride - 1) / col_stride;
+    directions.resize(3 * (size_t)rows * cols);
+    offsets.resize(3 * (size_t)rows * cols);
+
+    // a measurement is the point (distance, 0, 0) in the row frame, see
+    // DepthMap::convertSingleRow
+    size_t cell = 0;
+    for (unsigned r = 0; r < rows; ++r)
+    {
+        const DepthMapProjection::Transform& row2column = rows2column[r * row_stride];
+        const Eigen::Vector3f row_axis = row2column.linear().col(0);
+        const Eigen::Vector3f row_offset = row2column.translation();
+        for (unsigned c = 0; c < cols; ++c, ++cell)
+        {
+            const DepthMapProjection::Transform& column2pointcloud = columns2pointcloud[c * col_stride];
+            Eigen::Map<Eigen::Vector3f> direction(&directions[3 * cell]);
+            Eigen::Map<Eigen::Vector3f> offset(&offsets[3 * cell]);
+            direction = column2pointcloud.linear() * row_axis;
+            offset = column2pointcloud * row_offset;
+        }
+    }
+
+    vertical_projection = depth_map.vertical_projection;
+    horizontal_projection = depth_map.horizontal_projection;
+    vertical_interval = depth_map.vertical_interval;
+    horizontal_interval = depth_map.horizontal_interval;
+    vertical_size = depth_map.vertical_size;
+    horizontal_size = depth_map.horizontal_size;
+    cached = true;
+    ++projection_updates;
+}
+
+void DepthMapGeometry::update(base::samples::DepthMap const& depth_map, bool compute_slopes)
+{
+    if ((size_t)depth_map.vertical_size * depth_map.horizontal_size != depth_map.distances.size())
+        throw std::out_of_range("Number of rows and columns does not match the distance array size.");
+
+    if (!isProjectionCached(depth_map))
+        updateProjection(depth_map);
+
+    const size_t cell_count = (size_t)rows * cols;
+    vertices.resize(3 * cell_count);
+    source_indices.resize(cell_count);
+    vertex_indices.resize(cell_count);
+
+    const float* distances = depth_map.distances.empty() ? 0 : &depth_map.distances[0];
+    size_t vertex = 0;
+    size_t cell = 0;
+    for (unsigned r = 0; r < rows; ++r)
+    {
+        const size_t row_index = (size_t)r * row_stride * depth_map.horizontal_size;
+        for (unsigned c = 0; c < cols; ++c, ++cell)
+        {
+            const size_t index = row_index + (size_t)c * col_stride;
+            const float distance = distances[index];
+            if (!isValid(distance))
+            {
+                vertex_indices[cell] = -1;
+                continue;
+            }
+
+            const float* direction = &directions[3 * cell];
+            const float* offset = &offsets[3 * cell];
+            float* v = &vertices[3 * vertex];
+            v[0] = distance * direction[0] + offset[0];
+            v[1] = distance * direction[1] + offset[1];
+            v[2] = distance * direction[2] + offset[2];
+            source_indices[vertex] = index;
+            vertex_indices[cell] = vertex;
+            ++vertex;
+        }
+    }
+    vertices.resize(3 * vertex);
+    source_indices.resize(vertex);
+
+    slope_vertices.clear();
+    slope_angles.clear();
+    if (compute_slopes)
+        computeSlopes(depth_map);
+}
+
+void DepthMapGeometry::computeSlopes(base::samples::DepthMap const& depth_map)
+{
+    if (rows < 2)
+        return;
+
+    // sized for the worst case, and shrunk afterwards
+    slope_vertices.resize(6 * (size_t)(rows - 1) * cols);
+    slope_angles.resize((size_t)(rows - 1) * cols);
+    size_t line = 0;
+    for (unsigned r = 0; r + 1 < rows; ++r)
+    {
+        const int* upper = &vertex_indices[(size_t)r * cols];
+        const int* lower = upper + cols;
+        for (unsigned c = 0; c < cols; ++c)
+        {
+            if (upper[c] < 0 || lower[c] < 0)
+                continue;
+
+            const float d1 = depth_map.distances[source_indices[upper[c]]];
+            const float d2 = depth_map.distances[source_indices[lower[c]]];
+            if (std::min(d1, d2) * SLOPE_MAX_RATIO < std::max(d1, d2))
+                continue;
+
+            const float* p1 = &vertices[3 * upper[c]];
+            const float* p2 = &vertices[3 * lower[c]];
+            std::copy(p1, p1 + 3, &slope_vertices[6 * line]);
+            std::copy(p2, p2 + 3, &slope_vertices[6 * line + 3]);
+
+            const float dx = p2[0] - p1[0];
+            const float dy = p2[1] - p1[1];
+            slope_angles[line] = std::abs(std::atan2(std::sqrt(dx * dx + dy * dy), p2[2] - p1[2]));
+            ++line;
+        }
+    }
+    slope_vertices.resize(6 * line);
+    slope_angles.resize(line);
+}
+
+}
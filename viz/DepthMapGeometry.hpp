@@ -0,0 +1,108 @@
+#ifndef DEPTH_MAP_GEOMETRY_HPP
+#define DEPTH_MAP_GEOMETRY_HPP
+
+#include <vector>
+#include <base/samples/DepthMap.hpp>
+
+namespace vizkit3d
+{
+
+/**
+ * Decimated point and slope geometry of a depth map, independent of OSG
+ *
+ * Only every row_stride-th row and col_stride-th column of the depth map is
+ * converted. The projection of a measurement (v, h) of distance d is
+ *
+ *   columns2pointcloud[h] * (rows2column[v] * (d, 0, 0))
+ *
+ * which is cached as a direction and an offset per decimated measurement,
+ * reducing the conversion to d * direction + offset. The tables are only
+ * recomputed when the projection of the depth map (sizes, intervals and
+ * projection types) or the strides change.
+ *
+ * The vertices are single precision, with the layout of osg::Vec3Array, and
+ * only contain the valid measurements. The validity mask maps each decimated
+ * measurement to its vertex, and is used by the slope pass instead of
+ * checking the measurements again.
+ */
+class DepthMapGeometry
+{
+public:
+    /** Maximum distance ratio between two neighbouring measurements to be
+     * connected by a slope line */
+    static const float SLOPE_MAX_RATIO;
+
+    DepthMapGeometry(unsigned row_stride = 1, unsigned col_stride = 1);
+
+    /** Sets the decimation. Throws std::invalid_argument on zero strides */
+    void setStride(unsigned row_stride, unsigned col_stride);
+    unsigned getRowStride() const { return row_stride; }
+    unsigned getColStride() const { return col_stride; }
+
+    /** Converts the depth map
+     *
+     * @param compute_slopes whether the slope lines between vertically
+     *   neighbouring measurements should be computed as well
+     * @throw std::out_of_range if the size configuration of the depth map is
+     *   invalid, std::invalid_argument if its projection is invalid
+     */
+    void update(base::samples::DepthMap const& depth_map, bool compute_slopes = false);
+
+    /** Number of decimated rows and columns */
+    unsigned getRows() const { return rows; }
+    unsigned getCols() const { return cols; }
+
+    /** Vertices of the valid measurements, 3 floats per point */
+    std::vector<float> const& getVertices() const { return vertices; }
+    size_t getVertexCount() const { return vertices.size() / 3; }
+
+    /** Index of the measurement of each vertex in DepthMap::distances, e.g.
+     * to look up the remissions */
+    std::vector<size_t> const& getSourceIndices() const { return source_indices; }
+
+    /** Validity mask: index of the vertex of each decimated measurement, in
+     * row-major order, or -1 if the measurement is invalid */
+    std::vector<int> const& getVertexIndices() const { return vertex_indices; }
+
+    /** Slope lines, as pairs of vertices (6 floats per line) */
+    std::vector<float> const& getSlopeVertices() const { return slope_vertices; }
+
+    /** Angle of each slope line w.r.t. the z axis, in [0, pi] */
+    std::vector<float> const& getSlopeAngles() const { return slope_angles; }
+
+    /** Number of times the projection tables have been computed */
+    size_t getProjectionUpdates() const { return projection_updates; }
+
+private:
+    bool isProjectionCached(base::samples::DepthMap const& depth_map) const;
+    void updateProjection(base::samples::DepthMap const& depth_map);
+    void computeSlopes(base::samples::DepthMap const& depth_map);
+
+    unsigned row_stride;
+    unsigned col_stride;
+    unsigned rows;
+    unsigned cols;
+
+    /** Projection for which the tables have been computed */
+    bool cached;
+    base::samples::DepthMap::PROJECTION_TYPE vertical_projection;
+    base::samples::DepthMap::PROJECTION_TYPE horizontal_projection;
+    std::vector<double> vertical_interval;
+    std::vector<double> horizontal_interval;
+    unsigned vertical_size;
+    unsigned horizontal_size;
+    size_t projection_updates;
+
+    /** Direction and offset of each decimated measurement, 3 floats each */
+    std::vector<float> directions;
+    std::vector<float> offsets;
+
+    std::vector<float> vertices;
+    std::vector<size_t> source_indices;
+    std::vector<int> vertex_indices;
+    std::vector<float> slope_vertices;
+    std::vector<float> slope_angles;
+};
+
+}
+#endif
@@ -1,6 +1,8 @@
 #include "DepthMapVisualization.hpp"
 
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 #include <time.h>
 
 #include <osg/PositionAttitudeTransform>
@@ -16,15 +18,22 @@
 using namespace vizkit3d;
 
 DepthMapVisualization::DepthMapVisualization() : 
-    colorize_altitude(false), colorize_magnitude(false), colorize_interval(1.0), show_remission(false), show_slope(false)
+    colorize_altitude(false), colorize_magnitude(false), colorize_interval(1.0), show_remission(false), show_slope(false),
+    row_stride(1), column_stride(1)
 {
     scan_orientation = Eigen::Quaterniond::Identity();
     scan_position.setZero();
     default_feature_color = osg::Vec4f(1.0f,0.f,0.3f,0.8f);
+
+    worker.reset(new CoalescingWorker<base::samples::DepthMap, GeometryArrays>(
+                [this](base::samples::DepthMap const& sample, GeometryArrays& arrays) { buildGeometry(sample, arrays); },
+                [this]() { setDirty(); }));
 }
 
 DepthMapVisualization::~DepthMapVisualization()
 {
+    // join the worker thread, which uses the geometry, first
+    worker.reset();
 }
 
 osg::ref_ptr<osg::Node> DepthMapVisualization::createMainNode()
@@ -34,6 +43,8 @@ osg::ref_ptr<osg::Node> DepthMapVisualization::createMainNode()
     transformation_node->addChild(scan_node);
     
     scan_geom = new osg::Geometry();
+    // the arrays are swapped with the ones built by the worker on updates
+    scan_geom->setDataVariance(osg::Object::DYNAMIC);
 
     //setup normals
     osg::ref_ptr<osg::Vec3Array> normals = new osg::Vec3Array;
@@ -55,145 +66,169 @@ osg::ref_ptr<osg::Node> DepthMapVisualization::createMainNode()
     
     //setup slope geometry
     slope_geom = new osg::Geometry();
+    slope_geom->setDataVariance(osg::Object::DYNAMIC);
     slope_geom->getOrCreateStateSet()->setMode(GL_LIGHTING, osg::StateAttribute::OFF); 
     scan_node->addDrawable(slope_geom);
 
     return transformation_node;
 }
 
-void DepthMapVisualization::updateMainNode ( osg::Node* node )
+void DepthMapVisualization::buildGeometry(base::samples::DepthMap const& scan_sample, GeometryArrays& arrays)
 {
-    // apply transformation
-    transformation_node->setPosition(eigenVectorToOsgVec3(scan_position));
-    transformation_node->setAttitude(eigenQuatToOsgQuat(scan_orientation));
-    
-    // convert depth map to point cloud
-    std::vector<Eigen::Vector3d> points;
-    scan_sample.convertDepthMapToPointCloud(points, true, false);
-    
+    bool colorize_altitude, colorize_magnitude, show_remission, show_slope;
+    double colorize_interval;
+    osg::Vec4f default_feature_color;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        colorize_altitude = this->colorize_altitude;
+        colorize_magnitude = this->colorize_magnitude;
+        colorize_interval = this->colorize_interval;
+        show_remission = this->show_remission;
+        show_slope = this->show_slope;
+        default_feature_color = this->default_feature_color;
+        geometry.setStride(row_stride, column_stride);
+    }
+
+    // convert the decimated depth map, the projection tables are only
+    // recomputed if the projection or the strides changed
+    geometry.update(scan_sample, show_slope);
+    const size_t vertex_count = geometry.getVertexCount();
+    const std::vector<size_t>& source_indices = geometry.getSourceIndices();
+
+    // the arrays are reused. Arrays handed back by fetch() have been
+    // replaced in the geometries by updateMainNode, which is not concurrent
+    // with the drawing of the (dynamic) geometries
+    if(!arrays.vertices)
+    {
+        arrays.vertices = new osg::Vec3Array;
+        arrays.colors = new osg::Vec4Array;
+        arrays.slope_vertices = new osg::Vec3Array;
+        arrays.slope_colors = new osg::Vec4Array;
+    }
+    osg::Vec4Array& colors = *arrays.colors;
+
     //set color binding
-    osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array();
-    if(show_remission && !scan_sample.remissions.empty() && scan_sample.remissions.size() != points.size())
+    if(show_remission && !scan_sample.remissions.empty() && scan_sample.remissions.size() != scan_sample.distances.size())
     {
         throw std::runtime_error("Remission and depth image sizes are incompatible");
     }
     if(colorize_magnitude || colorize_altitude)
     {
-        for(unsigned i = 0; i < points.size(); i++)
+        colors.resize(vertex_count);
+        const float* vertices = vertex_count ? &geometry.getVertices()[0] : 0;
+        for(unsigned i = 0; i < vertex_count; i++)
         {
-	    if(scan_sample.isIndexValid(i))
-	    {
-		double hue = 0.0;
-		if(colorize_altitude)
-		    hue = (points[i].z() - std::floor(points[i].z() / colorize_interval) * colorize_interval) / colorize_interval;
-		else
-		    hue = (points[i].norm() - std::floor(points[i].norm() / colorize_interval) * colorize_interval) / colorize_interval;
-		float remission = (show_remission && !scan_sample.remissions.empty()) ? scan_sample.remissions[i] : 0.5;
-		osg::Vec4 color( 1.0, 1.0, 1.0, 1.0 );
-		hslToRgb(hue, 1.0, remission, color.r(), color.g(), color.b());
-		colors->push_back(color);
-	    }
+            const Eigen::Map<const Eigen::Vector3f> point(vertices + 3 * i);
+            double hue = 0.0;
+            if(colorize_altitude)
+                hue = (point.z() - std::floor(point.z() / colorize_interval) * colorize_interval) / colorize_interval;
+            else
+                hue = (point.norm() - std::floor(point.norm() / colorize_interval) * colorize_interval) / colorize_interval;
+            float remission = (show_remission && !scan_sample.remissions.empty()) ? scan_sample.remissions[source_indices[i]] : 0.5;
+            osg::Vec4& color = colors[i];
+            color = osg::Vec4( 1.0, 1.0, 1.0, 1.0 );
+            hslToRgb(hue, 1.0, remission, color.r(), color.g(), color.b());
         }
-        
-	#if OSG_MIN_VERSION_REQUIRED(3,1,8)
-	    slope_geom->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
-	#else
-	    slope_geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-	    slope_geom->setColorArray(colors);
-	#endif
+        arrays.per_vertex_colors = true;
     }
     else if(show_remission && !scan_sample.remissions.empty())
     {
-        for(unsigned i = 0; i < points.size(); i++)
+        colors.resize(vertex_count);
+        for(unsigned i = 0; i < vertex_count; i++)
         {
-	    if(scan_sample.isIndexValid(i))
-	    {
-	        float re = scan_sample.remissions[i];
-	        osg::Vec4f color = default_feature_color * re;
-	        color.w() = default_feature_color.w();
-		colors->push_back(color);
-	    }
+            float re = scan_sample.remissions[source_indices[i]];
+            osg::Vec4f color = default_feature_color * re;
+            color.w() = default_feature_color.w();
+            colors[i] = color;
         }
-
-	#if OSG_MIN_VERSION_REQUIRED(3,1,8)
-	    slope_geom->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
-	#else
-	    slope_geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-	    slope_geom->setColorArray(colors);
-	#endif
+        arrays.per_vertex_colors = true;
     }
     else
     {
-        colors->push_back(default_feature_color);
-	
-	#if OSG_MIN_VERSION_REQUIRED(3,1,8)
-	    slope_geom->setColorArray(colors, osg::Array::BIND_OVERALL);
-	#else
-	    slope_geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-	    slope_geom->setColorArray(colors);
-	#endif
+        colors.resize(1);
+        colors[0] = default_feature_color;
+        arrays.per_vertex_colors = false;
     }
 
-    // convert points to osg
-    osg::Vec3Array *scan_vertices = new osg::Vec3Array();
-    scan_vertices->reserve(points.size());
-    for(unsigned i = 0; i < points.size(); i++)
+    // copy the vertices, which have the memory layout of a Vec3Array
+    arrays.vertices->resize(vertex_count);
+    if(vertex_count)
+        std::memcpy(&(*arrays.vertices)[0], &geometry.getVertices()[0], 3 * sizeof(float) * vertex_count);
+
+    //build slope geometry
+    arrays.show_slope = show_slope;
+    if(show_slope)
     {
-	if(scan_sample.isIndexValid(i))
-	    scan_vertices->push_back(eigenVectorToOsgVec3(points[i]));
+        const std::vector<float>& slope_angles = geometry.getSlopeAngles();
+        const size_t line_count = slope_angles.size();
+        osg::Vec3Array& slope_vertices = *arrays.slope_vertices;
+        osg::Vec4Array& slope_colors = *arrays.slope_colors;
+        slope_vertices.resize(2 * line_count);
+        slope_colors.resize(2 * line_count);
+        if(line_count)
+            std::memcpy(&slope_vertices[0], &geometry.getSlopeVertices()[0], 6 * sizeof(float) * line_count);
+        for(size_t i = 0; i < line_count; i++)
+        {
+            osg::Vec4 color( 1.0, 1.0, 1.0, 1.0 );
+            hslToRgb(slope_angles[i]/M_PI, 1.0, 0.5, color.r(), color.g(), color.b());
+            slope_colors[2 * i] = color;
+            slope_colors[2 * i + 1] = color;
+        }
     }
-    slope_geom->setVertexArray(scan_vertices);
+}
 
-    while(!slope_geom->getPrimitiveSetList().empty())
-        slope_geom->removePrimitiveSet(0);
+void DepthMapVisualization::updateMainNode ( osg::Node* node )
+{
+    // apply transformation
+    transformation_node->setPosition(eigenVectorToOsgVec3(scan_position));
+    transformation_node->setAttitude(eigenQuatToOsgQuat(scan_orientation));
 
-    slope_geom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POINTS,0,scan_vertices->size()));
+    try
+    {
+        if(!worker->fetch(displayed))
+            return;
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "DepthMapVisualization: cannot display depth map: " << e.what() << std::endl;
+        return;
+    }
+
+    #if OSG_MIN_VERSION_REQUIRED(3,1,8)
+        scan_geom->setColorArray(displayed.colors, displayed.per_vertex_colors ? osg::Array::BIND_PER_VERTEX : osg::Array::BIND_OVERALL);
+    #else
+        scan_geom->setColorBinding(displayed.per_vertex_colors ? osg::Geometry::BIND_PER_VERTEX : osg::Geometry::BIND_OVERALL);
+        scan_geom->setColorArray(displayed.colors);
+    #endif
+    scan_geom->setVertexArray(displayed.vertices);
+    displayed.vertices->dirty();
+    displayed.colors->dirty();
+
+    while(!scan_geom->getPrimitiveSetList().empty())
+        scan_geom->removePrimitiveSet(0);
+    scan_geom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POINTS,0,displayed.vertices->size()));
 
     //draw slope geometry
-    if(show_slope)
+    while(!slope_geom->getPrimitiveSetList().empty())
+        slope_geom->removePrimitiveSet(0);
+    if(displayed.show_slope)
     {
-        osg::ref_ptr<osg::Vec3Array> slope_vertices = new osg::Vec3Array();
-        osg::ref_ptr<osg::Vec4Array> slope_colors = new osg::Vec4Array();
-
-        base::samples::DepthMap::DepthMatrixMapConst depth_map = scan_sample.getDistanceMatrixMapConst();
-	for(unsigned row = 0; row < depth_map.rows()-1; row++)
-	{
-	    for(unsigned col = 0; col < depth_map.cols(); col++)
-	    {
-		if(scan_sample.isMeasurementValid(row, col) && scan_sample.isMeasurementValid(row+1, col) &&
-		    (std::min(depth_map(row, col), depth_map(row+1, col)) * 1.3) >= std::max(depth_map(row, col), depth_map(row+1, col)))
-		{
-		    Eigen::Vector3d point1 = points[scan_sample.getIndex(row,col)];
-		    Eigen::Vector3d point2 = points[scan_sample.getIndex(row+1,col)];
-		    
-                    slope_vertices->push_back(eigenVectorToOsgVec3(point1));
-                    slope_vertices->push_back(eigenVectorToOsgVec3(point2));
-                    
-                    Eigen::Vector3d v_diff = point2 - point1;
-                    double v_angle = std::abs(std::atan2(v_diff.head<2>().norm(), v_diff.z()));
-                    
-                    osg::Vec4 color( 1.0, 1.0, 1.0, 1.0 );
-                    hslToRgb(v_angle/M_PI, 1.0, 0.5, color.r(), color.g(), color.b());
-                    slope_colors->push_back(color);
-                    slope_colors->push_back(color);
-		}
-	    }
-	}
-        
         #if OSG_MIN_VERSION_REQUIRED(3,1,8)
-	    slope_geom->setColorArray(slope_colors, osg::Array::BIND_PER_VERTEX);
+	    slope_geom->setColorArray(displayed.slope_colors, osg::Array::BIND_PER_VERTEX);
         #else
-	    slope_geom->setColorArray(slope_colors);
+	    slope_geom->setColorArray(displayed.slope_colors);
 	    slope_geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
 	#endif
-        slope_geom->setVertexArray(slope_vertices);
-        slope_geom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::LINES, 0, slope_vertices->size()));
+        slope_geom->setVertexArray(displayed.slope_vertices);
+        displayed.slope_vertices->dirty();
+        displayed.slope_colors->dirty();
+        slope_geom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::LINES, 0, displayed.slope_vertices->size()));
     }
 }
 
 void DepthMapVisualization::updateDataIntern(base::samples::DepthMap const& sample)
 {
-    scan_sample = sample;
+    worker->push(sample);
 }
 
 void DepthMapVisualization::updateDataIntern(const base::samples::RigidBodyState& sample)
@@ -211,7 +246,11 @@ void DepthMapVisualization::setColorizeInterval(double value)
 {
     if(value != 0.0)
     {
-        colorize_interval = value;
+        {
+            std::lock_guard<std::mutex> lock(settings_mutex);
+            colorize_interval = value;
+        }
+        worker->repeat();
         emit propertyChanged("ColorizeInterval");
     }
 }
@@ -223,7 +262,11 @@ bool DepthMapVisualization::isColorizeAltitudeEnabled() const
 
 void DepthMapVisualization::setColorizeAltitude(bool value)
 {
-    colorize_altitude = value;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        colorize_altitude = value;
+    }
+    worker->repeat();
     emit propertyChanged("ColorizeAltitude");
 }
 
@@ -234,7 +277,11 @@ bool DepthMapVisualization::isColorizeMagnitudeEnabled() const
 
 void DepthMapVisualization::setColorizeMagnitude(bool value)
 {
-    colorize_magnitude = value;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        colorize_magnitude = value;
+    }
+    worker->repeat();
     emit propertyChanged("ColorizeMagnitude");
 }
 
@@ -245,7 +292,11 @@ bool DepthMapVisualization::isShowRemissionEnabled() const
 
 void DepthMapVisualization::setShowRemission(bool value)
 {
-    show_remission = value;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        show_remission = value;
+    }
+    worker->repeat();
     emit propertyChanged("ShowRemission");
 }
 
@@ -256,10 +307,44 @@ bool DepthMapVisualization::isShowSlopeEnabled() const
 
 void DepthMapVisualization::setShowSlope(bool value)
 {
-    show_slope = value;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        show_slope = value;
+    }
+    worker->repeat();
     emit propertyChanged("ShowSlope");
 }
 
+int DepthMapVisualization::getRowStride() const
+{
+    return row_stride;
+}
+
+void DepthMapVisualization::setRowStride(int value)
+{
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        row_stride = std::max(value, 1);
+    }
+    worker->repeat();
+    emit propertyChanged("RowStride");
+}
+
+int DepthMapVisualization::getColumnStride() const
+{
+    return column_stride;
+}
+
+void DepthMapVisualization::setColumnStride(int value)
+{
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        column_stride = std::max(value, 1);
+    }
+    worker->repeat();
+    emit propertyChanged("ColumnStride");
+}
+
 QColor DepthMapVisualization::getDefaultFeatureColor()
 {
     QColor color;
@@ -269,9 +354,13 @@ QColor DepthMapVisualization::getDefaultFeatureColor()
 
 void DepthMapVisualization::setDefaultFeatureColor(QColor color)
 {
-    default_feature_color.x() = color.redF();
-    default_feature_color.y() = color.greenF();
-    default_feature_color.z() = color.blueF();
-    default_feature_color.w() = color.alphaF();
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        default_feature_color.x() = color.redF();
+        default_feature_color.y() = color.greenF();
+        default_feature_color.z() = color.blueF();
+        default_feature_color.w() = color.alphaF();
+    }
+    worker->repeat();
     emit propertyChanged("defaultFeatureColor");
 }
@@ -1,14 +1,27 @@
 #ifndef __DEPTH_MAP_VISUALIZATION_HPP__
 #define __DEPTH_MAP_VISUALIZATION_HPP__
 
+#include <mutex>
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <vizkit3d/Vizkit3DPlugin.hpp>
 #include <base/samples/DepthMap.hpp>
 #include <base/samples/RigidBodyState.hpp>
 #include <osg/Geode>
+#include "DepthMapGeometry.hpp"
+#include "CoalescingWorker.hpp"
 
 namespace vizkit3d
 {
+    /**
+     * Displays depth maps as points, colored by altitude, distance or
+     * remission, and optionally the slopes between neighbouring
+     * measurements
+     *
+     * The geometry is built on a worker thread (see CoalescingWorker), which
+     * only converts the latest depth map when they arrive faster than they
+     * can be converted. The render thread only swaps in the built arrays.
+     */
     class DepthMapVisualization
         : public vizkit3d::Vizkit3DPlugin<base::samples::DepthMap>
         , public vizkit3d::VizPluginAddType<base::samples::RigidBodyState>
@@ -21,6 +34,8 @@ namespace vizkit3d
     Q_PROPERTY(double ColorizeInterval READ getColorizeInterval WRITE setColorizeInterval)
     Q_PROPERTY(bool ShowRemission READ isShowRemissionEnabled WRITE setShowRemission)
     Q_PROPERTY(bool ShowSlope READ isShowSlopeEnabled WRITE setShowSlope)
+    Q_PROPERTY(int RowStride READ getRowStride WRITE setRowStride)
+    Q_PROPERTY(int ColumnStride READ getColumnStride WRITE setColumnStride)
     Q_PROPERTY(QColor defaultFeatureColor READ getDefaultFeatureColor WRITE setDefaultFeatureColor)
     
     public:
@@ -49,6 +64,11 @@ namespace vizkit3d
         bool isShowRemissionEnabled() const;
         void setShowSlope(bool value);
         bool isShowSlopeEnabled() const;
+        /** Only every n-th row and column of the depth map is displayed */
+        void setRowStride(int value);
+        int getRowStride() const;
+        void setColumnStride(int value);
+        int getColumnStride() const;
         QColor getDefaultFeatureColor();
         void setDefaultFeatureColor(QColor color);
 
@@ -59,19 +79,43 @@ namespace vizkit3d
         virtual void updateDataIntern(const base::samples::RigidBodyState& sample);
         
     private:
-        base::samples::DepthMap scan_sample;
+        /** Geometry built by the worker, handed over to updateMainNode */
+        struct GeometryArrays
+        {
+            osg::ref_ptr<osg::Vec3Array> vertices;
+            osg::ref_ptr<osg::Vec4Array> colors;
+            bool per_vertex_colors;
+            osg::ref_ptr<osg::Vec3Array> slope_vertices;
+            osg::ref_ptr<osg::Vec4Array> slope_colors;
+            bool show_slope;
+
+            GeometryArrays() : per_vertex_colors(false), show_slope(false) {}
+        };
+
+        void buildGeometry(base::samples::DepthMap const& sample, GeometryArrays& arrays);
+
         Eigen::Vector3d scan_position;
         Eigen::Quaterniond scan_orientation;
         osg::ref_ptr< osg::PositionAttitudeTransform > transformation_node;
         osg::ref_ptr<osg::Geode> scan_node;
         osg::ref_ptr<osg::Geometry> scan_geom;
         osg::ref_ptr<osg::Geometry> slope_geom;
+        /** The arrays attached to the geometries */
+        GeometryArrays displayed;
+        boost::scoped_ptr< CoalescingWorker<base::samples::DepthMap, GeometryArrays> > worker;
+
+        /** Protects the properties read by the worker */
+        std::mutex settings_mutex;
         bool colorize_altitude;
         bool colorize_magnitude;
         double colorize_interval;
         bool show_remission;
         bool show_slope;
+        int row_stride;
+        int column_stride;
         osg::Vec4f default_feature_color;
+        /** Only used by the worker */
+        DepthMapGeometry geometry;
     };
 }
 #endif
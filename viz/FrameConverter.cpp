@@ -0,0 +1,173 @@
+#include "FrameConverter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using base::samples::frame::Frame;
+using namespace base::samples::frame;
+
+namespace vizkit3d
+{
+
+namespace
+{
+
+/** Reads 8 bit values from 8 bit or 16 bit little-endian channels */
+struct ChannelReader
+{
+    int bytes;
+    int shift;
+
+    explicit ChannelReader(Frame const& frame)
+        : bytes((frame.getDataDepth() + 7) / 8)
+        , shift(std::max<int>(0, frame.getDataDepth() - 8))
+    {
+        if (bytes != 1 && bytes != 2)
+            throw std::runtime_error("convertFrameToRGB: only 8 and 16 bit channels are supported");
+    }
+
+    uint8_t operator()(uint8_t const* channel, int index) const
+    {
+        if (bytes == 1)
+            return channel[index];
+        const unsigned value = channel[2 * index] | (channel[2 * index + 1] << 8);
+        return std::min(value >> shift, 255u);
+    }
+};
+
+}
+
+static inline uint8_t clampToByte(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static void convertChannels(Frame const& frame, RGBImage& image, int const* order, int channels)
+{
+    const ChannelReader read(frame);
+    const uint32_t row_size = frame.getRowSize();
+    uint8_t const* src = frame.getImageConstPtr();
+    uint8_t* dst = &image.data[0];
+    for (int y = 0; y < image.height; ++y)
+    {
+        uint8_t const* row = src + y * row_size;
+        for (int x = 0; x < image.width; ++x, dst += 3)
+        {
+            const int pixel = x * channels;
+            dst[0] = read(row, pixel + order[0]);
+            dst[1] = read(row, pixel + order[1]);
+            dst[2] = read(row, pixel + order[2]);
+        }
+    }
+}
+
+static void convertUYVY(Frame const& frame, RGBImage& image)
+{
+    // UYVY stores two pixels in four bytes (U Y0 V Y1)
+    if (frame.getPixelSize() != 2)
+        throw std::runtime_error("convertFrameToRGB: UYVY frames must have 2 bytes per pixel");
+    // the last pixel of odd rows would have no V sample
+    if (image.width % 2)
+        throw std::runtime_error("convertFrameToRGB: UYVY frames must have an even width");
+    const uint32_t row_size = frame.getRowSize();
+    uint8_t const* src = frame.getImageConstPtr();
+    uint8_t* dst = &image.data[0];
+    for (int y = 0; y < image.height; ++y)
+    {
+        uint8_t const* row = src + y * row_size;
+        for (int x = 0; x < image.width; ++x, dst += 3)
+        {
+            uint8_t const* pair = row + 4 * (x / 2);
+            // ITU-R BT.601, in fixed point with 8 fractional bits
+            const int c = 298 * (row[2 * x + 1] - 16);
+            const int d = pair[0] - 128;
+            const int e = pair[2] - 128;
+            dst[0] = clampToByte((c + 409 * e + 128) >> 8);
+            dst[1] = clampToByte((c - 100 * d - 208 * e + 128) >> 8);
+            dst[2] = clampToByte((c + 516 * d + 128) >> 8);
+        }
+    }
+}
+
+static void convertBayer(Frame const& frame, RGBImage& image)
+{
+    if (image.width < 2 || image.height < 2)
+        throw std::runtime_error("convertFrameToRGB: Bayer images must be at least 2x2 pixels");
+    if (frame.getDataDepth() > 8)
+        throw std::runtime_error("convertFrameToRGB: only 8 bit Bayer images are supported");
+
+    // position of the red pixel in the 2x2 block, the blue one is on the
+    // opposite corner
+    int red_x = 0, red_y = 0;
+    switch (frame.getFrameMode())
+    {
+        case MODE_BAYER_GRBG: red_x = 1; red_y = 0; break;
+        case MODE_BAYER_BGGR: red_x = 1; red_y = 1; break;
+        case MODE_BAYER_GBRG: red_x = 0; red_y = 1; break;
+        default: break;
+    }
+
+    const uint32_t row_size = frame.getRowSize();
+    uint8_t const* src = frame.getImageConstPtr();
+    for (int y = 0; y < image.height; ++y)
+    {
+        // the top-left corner of the block, clamped so that odd sizes reuse
+        // the last complete block
+        const int block_y = std::min(y, image.height - 2) & ~1;
+        uint8_t const* top = src + block_y * row_size;
+        uint8_t const* bottom = top + row_size;
+        uint8_t const* red_row = red_y ? bottom : top;
+        uint8_t const* blue_row = red_y ? top : bottom;
+        // the green pixels are on the other diagonal
+        const int top_green = red_y ? red_x : 1 - red_x;
+        uint8_t* dst = &image.data[3 * y * image.width];
+        for (int x = 0; x < image.width; ++x, dst += 3)
+        {
+            const int block_x = std::min(x, image.width - 2) & ~1;
+            dst[0] = red_row[block_x + red_x];
+            dst[1] = (top[block_x + top_green] + bottom[block_x + 1 - top_green] + 1) / 2;
+            dst[2] = blue_row[block_x + 1 - red_x];
+        }
+    }
+}
+
+void convertFrameToRGB(Frame const& frame, RGBImage& image)
+{
+    if (frame.isCompressed())
+        throw std::runtime_error("convertFrameToRGB: compressed frames are not supported");
+
+    const frame_mode_t mode = frame.getFrameMode();
+    const int width = frame.getWidth();
+    const int height = frame.getHeight();
+    if (frame.image.size() < static_cast<size_t>(frame.getRowSize()) * height)
+        throw std::runtime_error("convertFrameToRGB: the frame has less data than its size requires");
+
+    image.width = width;
+    image.height = height;
+    image.time = frame.time;
+    image.data.resize(3 * static_cast<size_t>(width) * height);
+    if (image.data.empty())
+        return;
+
+    static const int gray[] = { 0, 0, 0 };
+    static const int rgb[] = { 0, 1, 2 };
+    static const int bgr[] = { 2, 1, 0 };
+    switch (mode)
+    {
+        case MODE_GRAYSCALE: convertChannels(frame, image, gray, 1); break;
+        case MODE_RGB: convertChannels(frame, image, rgb, 3); break;
+        case MODE_BGR: convertChannels(frame, image, bgr, 3); break;
+        case MODE_RGB32: convertChannels(frame, image, rgb, 4); break;
+        case MODE_UYVY: convertUYVY(frame, image); break;
+        case MODE_BAYER:
+        case MODE_BAYER_RGGB:
+        case MODE_BAYER_GRBG:
+        case MODE_BAYER_BGGR:
+        case MODE_BAYER_GBRG:
+            convertBayer(frame, image);
+            break;
+        default:
+            throw std::runtime_error("convertFrameToRGB: unsupported frame mode");
+    }
+}
+
+}
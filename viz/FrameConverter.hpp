@@ -0,0 +1,57 @@
+#ifndef FRAME_CONVERTER_HPP
+#define FRAME_CONVERTER_HPP
+
+#include <vector>
+#include <stdint.h>
+#include <base/Time.hpp>
+#include <base/samples/Frame.hpp>
+
+namespace vizkit3d
+{
+
+/** An 8 bit RGB image, with rows stored from top to bottom and no padding
+ * between rows */
+struct RGBImage
+{
+    int width;
+    int height;
+    base::Time time;
+    /** The pixels, 3 bytes per pixel */
+    std::vector<uint8_t> data;
+
+    RGBImage()
+        : width(0), height(0) {}
+
+    void swap(RGBImage& other)
+    {
+        std::swap(width, other.width);
+        std::swap(height, other.height);
+        std::swap(time, other.time);
+        data.swap(other.data);
+    }
+};
+
+inline void swap(RGBImage& a, RGBImage& b) { a.swap(b); }
+
+/**
+ * Converts a frame to an 8 bit RGB image, e.g. to upload it as a texture
+ *
+ * Supported modes are grayscale, RGB, BGR and RGB32 with 8 or 16 bits per
+ * channel (16 bit values are little endian, and scaled down according to
+ * the frame's data depth), UYVY with 2 bytes per pixel (i.e. a data depth
+ * of 16, as Frame counts UYVY as a single channel) and an even width, and
+ * the Bayer patterns with 8 bits per channel. MODE_BAYER is interpreted as RGGB.
+ *
+ * Bayer images are demosaiced by using the 2x2 block that contains a pixel,
+ * which is cheap and good enough for display purposes.
+ *
+ * The output image is resized only if its size changes, so that converting
+ * frames of constant size into the same image does not allocate.
+ *
+ * @throw std::runtime_error if the frame is compressed, its mode is not
+ *   supported, or its data is smaller than its size requires
+ */
+void convertFrameToRGB(base::samples::frame::Frame const& frame, RGBImage& image);
+
+}
+#endif
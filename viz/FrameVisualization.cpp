@@ -0,0 +1,119 @@
+#include "FrameVisualization.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <osg/Geode>
+#include <osg/Texture2D>
+
+using namespace vizkit3d;
+
+FrameVisualization::FrameVisualization()
+    : image_width(1.0)
+{
+    worker.reset(new CoalescingWorker<base::samples::frame::Frame, RGBImage>(
+                convertFrameToRGB, [this]() { setDirty(); }));
+}
+
+FrameVisualization::~FrameVisualization()
+{
+    // join the worker thread, which notifies the plugin, first
+    worker.reset();
+}
+
+double FrameVisualization::getImageWidth() const
+{
+    return image_width;
+}
+
+void FrameVisualization::setImageWidth(double width)
+{
+    // applied on the next update, as the quad is only accessed from the
+    // update methods
+    image_width = width;
+    setDirty();
+    emit propertyChanged("ImageWidth");
+}
+
+osg::ref_ptr<osg::Node> FrameVisualization::createMainNode()
+{
+    image = new osg::Image;
+    image->setDataVariance(osg::Object::DYNAMIC);
+
+    osg::ref_ptr<osg::Texture2D> texture = new osg::Texture2D(image);
+    texture->setDataVariance(osg::Object::DYNAMIC);
+    texture->setResizeNonPowerOfTwoHint(false);
+    texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
+    texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
+    texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+    texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+
+    vertices = new osg::Vec3Array(4);
+    // the first row of the frame is the top of the image, and the first
+    // row of the texture
+    osg::ref_ptr<osg::Vec2Array> texcoords = new osg::Vec2Array;
+    texcoords->push_back(osg::Vec2(0, 1));
+    texcoords->push_back(osg::Vec2(1, 1));
+    texcoords->push_back(osg::Vec2(1, 0));
+    texcoords->push_back(osg::Vec2(0, 0));
+    osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array;
+    colors->push_back(osg::Vec4(1, 1, 1, 1));
+
+    quad = new osg::Geometry;
+    quad->setDataVariance(osg::Object::DYNAMIC);
+    quad->setUseDisplayList(false);
+    quad->setVertexArray(vertices);
+    quad->setTexCoordArray(0, texcoords);
+    quad->setColorArray(colors);
+    quad->setColorBinding(osg::Geometry::BIND_OVERALL);
+    quad->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::QUADS, 0, 4));
+
+    osg::StateSet* state = quad->getOrCreateStateSet();
+    state->setTextureAttributeAndModes(0, texture, osg::StateAttribute::ON);
+    state->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(quad);
+    geode->setNodeMask(0);
+    return geode;
+}
+
+void FrameVisualization::updateQuad()
+{
+    const double w = image_width / 2;
+    const double h = front.width > 0 ? w * front.height / front.width : 0;
+    (*vertices)[0] = osg::Vec3(-w, -h, 0);
+    (*vertices)[1] = osg::Vec3(w, -h, 0);
+    (*vertices)[2] = osg::Vec3(w, h, 0);
+    (*vertices)[3] = osg::Vec3(-w, h, 0);
+    vertices->dirty();
+    quad->dirtyBound();
+}
+
+void FrameVisualization::updateMainNode(osg::Node* node)
+{
+    bool updated = false;
+    try
+    {
+        updated = worker->fetch(front);
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "FrameVisualization: cannot display frame: " << e.what() << std::endl;
+    }
+
+    if(updated)
+    {
+        // the texture references the converted data directly, which stays
+        // valid until the next fetch
+        image->setImage(front.width, front.height, 1, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE,
+                front.data.empty() ? 0 : &front.data[0], osg::Image::NO_DELETE);
+        image->dirty();
+        node->setNodeMask(front.data.empty() ? 0 : ~0);
+    }
+    updateQuad();
+}
+
+void FrameVisualization::updateDataIntern(base::samples::frame::Frame const& data)
+{
+    worker->push(data);
+}
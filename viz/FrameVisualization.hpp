@@ -0,0 +1,65 @@
+#ifndef __FRAME_VISUALIZATION_HPP__
+#define __FRAME_VISUALIZATION_HPP__
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <vizkit3d/Vizkit3DPlugin.hpp>
+#include <base/samples/Frame.hpp>
+#include <osg/Geometry>
+#include <osg/Image>
+#include "CoalescingWorker.hpp"
+#include "FrameConverter.hpp"
+
+namespace vizkit3d
+{
+    /**
+     * Displays camera frames as a textured quad in the XY plane, centered
+     * on the origin of the plugin's frame
+     *
+     * The conversion of the frames to RGB (demosaicing, YUV and BGR
+     * conversion, 16 to 8 bit scaling) is done on a worker thread, so that
+     * neither the data nor the GUI thread are blocked by it. When frames
+     * arrive faster than they can be converted, only the latest one is
+     * converted and the others are dropped.
+     */
+    class FrameVisualization
+        : public vizkit3d::Vizkit3DPlugin<base::samples::frame::Frame>
+        , boost::noncopyable
+    {
+    Q_OBJECT
+    Q_PROPERTY(double ImageWidth READ getImageWidth WRITE setImageWidth)
+
+    public:
+        FrameVisualization();
+        ~FrameVisualization();
+
+        Q_INVOKABLE void updateData(base::samples::frame::Frame const& sample)
+        { vizkit3d::Vizkit3DPlugin<base::samples::frame::Frame>::updateData(sample); }
+        Q_INVOKABLE void updateFrame(base::samples::frame::Frame const& sample)
+        { updateData(sample); }
+
+    public slots:
+        /** Width of the displayed image in meters, the height follows from
+         * the aspect ratio of the frames */
+        double getImageWidth() const;
+        void setImageWidth(double width);
+
+    protected:
+        osg::ref_ptr<osg::Node> createMainNode();
+        void updateMainNode(osg::Node* node);
+        void updateDataIntern(base::samples::frame::Frame const& data);
+
+    private:
+        void updateQuad();
+
+        double image_width;
+        boost::scoped_ptr< CoalescingWorker<base::samples::frame::Frame, RGBImage> > worker;
+        /** The image currently referenced by the texture */
+        RGBImage front;
+
+        osg::ref_ptr<osg::Image> image;
+        osg::ref_ptr<osg::Geometry> quad;
+        osg::ref_ptr<osg::Vec3Array> vertices;
+    };
+}
+#endif
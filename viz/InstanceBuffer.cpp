@@ -0,0 +1,156 @@
+#include "InstanceBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace vizkit3d
+{
+
+InstanceBuffer::InstanceBuffer()
+    : origin(base::Vector3d::Zero())
+{
+    clear();
+}
+
+void InstanceBuffer::clear()
+{
+    origin.setZero();
+    positions.clear();
+    orientations.clear();
+    colors.clear();
+    dirty_begin = 0;
+    dirty_end = 0;
+    centers.setEmpty();
+    max_scale = 0;
+    changes = 0;
+}
+
+void InstanceBuffer::reserve(size_t count)
+{
+    positions.reserve(4 * count);
+    orientations.reserve(4 * count);
+    colors.reserve(4 * count);
+}
+
+void InstanceBuffer::push(Eigen::Vector3d const& position, Eigen::Quaterniond const& orientation,
+                          double scale, Eigen::Vector4f const& color)
+{
+    if (empty())
+        origin = position;
+
+    positions.resize(positions.size() + 4);
+    orientations.resize(orientations.size() + 4);
+    colors.resize(colors.size() + 4);
+    write(size() - 1, position, orientation, scale, color);
+}
+
+void InstanceBuffer::set(size_t instance, Eigen::Vector3d const& position, Eigen::Quaterniond const& orientation,
+                         double scale, Eigen::Vector4f const& color)
+{
+    write(instance, position, orientation, scale, color);
+    ++changes;
+}
+
+void InstanceBuffer::remove(size_t instance)
+{
+    const size_t last = size() - 1;
+    if (instance != last)
+    {
+        std::copy(&positions[4 * last], &positions[4 * last + 4], &positions[4 * instance]);
+        std::copy(&orientations[4 * last], &orientations[4 * last + 4], &orientations[4 * instance]);
+        std::copy(&colors[4 * last], &colors[4 * last + 4], &colors[4 * instance]);
+        markDirty(instance);
+    }
+    positions.resize(4 * last);
+    orientations.resize(4 * last);
+    colors.resize(4 * last);
+    dirty_end = std::min(dirty_end, last);
+    dirty_begin = std::min(dirty_begin, dirty_end);
+    ++changes;
+}
+
+void InstanceBuffer::write(size_t instance, Eigen::Vector3d const& position, Eigen::Quaterniond const& orientation,
+                           double scale, Eigen::Vector4f const& color)
+{
+    const Eigen::Vector3f relative = (position - origin).cast<float>();
+    float* p = &positions[4 * instance];
+    p[0] = relative.x();
+    p[1] = relative.y();
+    p[2] = relative.z();
+    p[3] = scale;
+
+    const Eigen::Quaterniond q = orientation.normalized();
+    float* o = &orientations[4 * instance];
+    o[0] = q.x();
+    o[1] = q.y();
+    o[2] = q.z();
+    o[3] = q.w();
+
+    std::copy(color.data(), color.data() + 4, &colors[4 * instance]);
+
+    centers.extend(relative);
+    max_scale = std::max(max_scale, std::abs(p[3]));
+    markDirty(instance);
+}
+
+void InstanceBuffer::markDirty(size_t instance)
+{
+    if (dirty_begin == dirty_end)
+    {
+        dirty_begin = instance;
+        dirty_end = instance + 1;
+    }
+    else
+    {
+        dirty_begin = std::min(dirty_begin, instance);
+        dirty_end = std::max(dirty_end, instance + 1);
+    }
+}
+
+InstanceBuffer::Range InstanceBuffer::getDirtyRange() const
+{
+    return Range(dirty_begin, dirty_end - dirty_begin);
+}
+
+void InstanceBuffer::clearDirty()
+{
+    dirty_begin = 0;
+    dirty_end = 0;
+}
+
+Eigen::Vector3f InstanceBuffer::transform(size_t instance, Eigen::Vector3f const& vertex) const
+{
+    const float* p = &positions[4 * instance];
+    const float* q = &orientations[4 * instance];
+
+    // v + 2 q.xyz x (q.xyz x v + q.w v), as in the vertex shader
+    const Eigen::Vector3f v = vertex * p[3];
+    const Eigen::Vector3f axis(q[0], q[1], q[2]);
+    const Eigen::Vector3f rotated = v + 2 * axis.cross(axis.cross(v) + q[3] * v);
+    return rotated + Eigen::Vector3f(p[0], p[1], p[2]);
+}
+
+void InstanceBuffer::updateBounds() const
+{
+    centers.setEmpty();
+    max_scale = 0;
+    for (size_t i = 0; i < size(); ++i)
+    {
+        const float* p = &positions[4 * i];
+        centers.extend(Eigen::Vector3f(p[0], p[1], p[2]));
+        max_scale = std::max(max_scale, std::abs(p[3]));
+    }
+    changes = 0;
+}
+
+Eigen::AlignedBox3f InstanceBuffer::getBounds(float mesh_radius) const
+{
+    if (changes > size())
+        updateBounds();
+    if (centers.isEmpty())
+        return centers;
+
+    const Eigen::Vector3f extent = Eigen::Vector3f::Constant(max_scale * std::abs(mesh_radius));
+    return Eigen::AlignedBox3f(centers.min() - extent, centers.max() + extent);
+}
+
+}
@@ -0,0 +1,114 @@
+#ifndef INSTANCE_BUFFER_HPP
+#define INSTANCE_BUFFER_HPP
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <base/Eigen.hpp>
+
+namespace vizkit3d
+{
+
+/**
+ * Per-instance attributes of an instanced geometry, independent of OSG
+ *
+ * Each instance of a mesh is drawn with three vec4 vertex attributes, stored
+ * in single precision arrays with the memory layout of osg::Vec4Array:
+ *
+ * - position: x, y, z of the instance and the scale of the mesh in w
+ * - orientation: quaternion in x, y, z, w order (as osg::Quat)
+ * - color: RGBA, multiplied with the color of the mesh
+ *
+ * A mesh vertex v is drawn at orientation * (scale * v) + position (see
+ * transform(), which is the CPU version of the vertex shader).
+ *
+ * The positions are stored relative to an origin, which is the position of
+ * the first instance added after clear(), so that world coordinates (e.g.
+ * UTM) do not lose precision once converted to floats. The geometry has to
+ * be translated by getOrigin().
+ *
+ * Instances can be overwritten and removed, which does not keep their
+ * order. The instances changed since the last clearDirty() are reported by
+ * getDirtyRange(), so that only those need to be copied to the geometry.
+ */
+class InstanceBuffer
+{
+public:
+    /** Range of instances */
+    struct Range
+    {
+        size_t first;
+        size_t count;
+
+        Range() : first(0), count(0) {}
+        Range(size_t first, size_t count) : first(first), count(count) {}
+    };
+
+    InstanceBuffer();
+
+    /** Removes all instances, and resets the origin */
+    void clear();
+    void reserve(size_t count);
+
+    /** Adds an instance */
+    void push(Eigen::Vector3d const& position, Eigen::Quaterniond const& orientation,
+              double scale, Eigen::Vector4f const& color);
+
+    /** Overwrites an instance */
+    void set(size_t instance, Eigen::Vector3d const& position, Eigen::Quaterniond const& orientation,
+             double scale, Eigen::Vector4f const& color);
+
+    /** Removes an instance by moving the last one in its place */
+    void remove(size_t instance);
+
+    size_t size() const { return colors.size() / 4; }
+    bool empty() const { return colors.empty(); }
+
+    /** Position of the instances, which is subtracted from the positions */
+    base::Vector3d const& getOrigin() const { return origin; }
+
+    /** Attribute arrays, 4 floats per instance */
+    float const* getPositions() const { return positions.empty() ? 0 : &positions[0]; }
+    float const* getOrientations() const { return orientations.empty() ? 0 : &orientations[0]; }
+    float const* getColors() const { return colors.empty() ? 0 : &colors[0]; }
+
+    /** Returns where a mesh vertex is drawn for the given instance, relative
+     * to the origin */
+    Eigen::Vector3f transform(size_t instance, Eigen::Vector3f const& vertex) const;
+
+    /** Bounding box of all instances, relative to the origin, for a mesh
+     * contained in a sphere of the given radius around its origin
+     *
+     * The box is extended as instances are written, and may therefore be
+     * larger than needed after instances are overwritten or removed. It is
+     * computed again once there were more changes than instances, which
+     * keeps the cost amortized O(1) per change.
+     */
+    Eigen::AlignedBox3f getBounds(float mesh_radius) const;
+
+    /** Instances written or moved since the last clearDirty() */
+    Range getDirtyRange() const;
+    void clearDirty();
+
+private:
+    void write(size_t instance, Eigen::Vector3d const& position, Eigen::Quaterniond const& orientation,
+               double scale, Eigen::Vector4f const& color);
+    void markDirty(size_t instance);
+    void updateBounds() const;
+
+    base::Vector3d origin;
+    std::vector<float> positions;
+    std::vector<float> orientations;
+    std::vector<float> colors;
+
+    size_t dirty_begin;
+    size_t dirty_end;
+
+    /** Box of the instance positions and largest scale, see getBounds */
+    mutable Eigen::AlignedBox3f centers;
+    mutable float max_scale;
+    mutable size_t changes;
+};
+
+}
+#endif
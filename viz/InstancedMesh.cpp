@@ -0,0 +1,129 @@
+#include "InstancedMesh.hpp"
+
+#include <cstring>
+#include <osg/Geode>
+#include <osg/Program>
+#include <osg/Shader>
+#include <osg/VertexAttribDivisor>
+#include <osg/Version>
+
+#include <vizkit3d/Vizkit3DHelper.hpp>
+
+namespace vizkit3d
+{
+
+// the rotation is v + 2 q.xyz x (q.xyz x v + q.w v), see
+// InstanceBuffer::transform
+static const char* vertex_shader_source =
+    "#version 120\n"
+    "attribute vec4 instance_position;\n"
+    "attribute vec4 instance_orientation;\n"
+    "attribute vec4 instance_color;\n"
+    "void main()\n"
+    "{\n"
+    "    vec3 v = gl_Vertex.xyz * instance_position.w;\n"
+    "    vec3 axis = instance_orientation.xyz;\n"
+    "    v = v + 2.0 * cross(axis, cross(axis, v) + instance_orientation.w * v);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(v + instance_position.xyz, 1.0);\n"
+    "    gl_FrontColor = gl_Color * instance_color;\n"
+    "}\n";
+
+static const char* fragment_shader_source =
+    "#version 120\n"
+    "void main()\n"
+    "{\n"
+    "    gl_FragColor = gl_Color;\n"
+    "}\n";
+
+static osg::Program* getInstancingProgram()
+{
+    static osg::ref_ptr<osg::Program> program;
+    if (!program)
+    {
+        program = new osg::Program;
+        program->addShader(new osg::Shader(osg::Shader::VERTEX, vertex_shader_source));
+        program->addShader(new osg::Shader(osg::Shader::FRAGMENT, fragment_shader_source));
+        program->addBindAttribLocation("instance_position", InstancedMesh::POSITION_ATTRIBUTE);
+        program->addBindAttribLocation("instance_orientation", InstancedMesh::ORIENTATION_ATTRIBUTE);
+        program->addBindAttribLocation("instance_color", InstancedMesh::COLOR_ATTRIBUTE);
+    }
+    return program.get();
+}
+
+static void setInstanceArray(osg::Geometry* mesh, unsigned int index, osg::Vec4Array* array)
+{
+    #if OSG_MIN_VERSION_REQUIRED(3,1,8)
+        mesh->setVertexAttribArray(index, array, osg::Array::BIND_PER_VERTEX);
+    #else
+        mesh->setVertexAttribArray(index, array);
+        mesh->setVertexAttribBinding(index, osg::Geometry::BIND_PER_VERTEX);
+    #endif
+    mesh->getOrCreateStateSet()->setAttribute(new osg::VertexAttribDivisor(index, 1));
+}
+
+static void copyInstanceArray(osg::Vec4Array* array, float const* data, size_t count,
+                              InstanceBuffer::Range const& dirty)
+{
+    array->resize(count);
+    if (dirty.count)
+        std::memcpy(&(*array)[dirty.first], data + 4 * dirty.first, 4 * sizeof(float) * dirty.count);
+    array->dirty();
+}
+
+InstancedMesh::InstancedMesh(osg::Geometry* mesh, float mesh_radius)
+    : mesh_radius(mesh_radius)
+    , mesh(mesh)
+{
+    positions = new osg::Vec4Array;
+    orientations = new osg::Vec4Array;
+    colors = new osg::Vec4Array;
+
+    // the attribute arrays are only valid as VBOs with a divisor
+    mesh->setUseDisplayList(false);
+    mesh->setUseVertexBufferObjects(true);
+    setInstanceArray(mesh, POSITION_ATTRIBUTE, positions);
+    setInstanceArray(mesh, ORIENTATION_ATTRIBUTE, orientations);
+    setInstanceArray(mesh, COLOR_ATTRIBUTE, colors);
+
+    osg::StateSet* state = mesh->getOrCreateStateSet();
+    state->setAttributeAndModes(getInstancingProgram(), osg::StateAttribute::ON);
+    state->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(mesh);
+    transform = new osg::PositionAttitudeTransform;
+    transform->addChild(geode);
+}
+
+void InstancedMesh::update(InstanceBuffer const& instances)
+{
+    const size_t count = instances.size();
+    const InstanceBuffer::Range dirty = instances.getDirtyRange();
+    copyInstanceArray(positions, instances.getPositions(), count, dirty);
+    copyInstanceArray(orientations, instances.getOrientations(), count, dirty);
+    copyInstanceArray(colors, instances.getColors(), count, dirty);
+
+    osg::Geometry::PrimitiveSetList& primitives = mesh->getPrimitiveSetList();
+    for (size_t i = 0; i < primitives.size(); ++i)
+    {
+        primitives[i]->setNumInstances(count);
+        primitives[i]->dirty();
+    }
+
+    // the bound computed by OSG only covers the mesh at the origin
+    osg::BoundingBox bound;
+    if (count)
+    {
+        const Eigen::AlignedBox3f box = instances.getBounds(mesh_radius);
+        bound.set(box.min().x(), box.min().y(), box.min().z(),
+                  box.max().x(), box.max().y(), box.max().z());
+    }
+    mesh->setInitialBound(bound);
+    mesh->dirtyBound();
+
+    // zero instances would draw the mesh once
+    transform->setNodeMask(count ? ~0u : 0u);
+    transform->setPosition(eigenVectorToOsgVec3(instances.getOrigin()));
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef INSTANCED_MESH_HPP
+#define INSTANCED_MESH_HPP
+
+#include <osg/Geometry>
+#include <osg/PositionAttitudeTransform>
+#include "InstanceBuffer.hpp"
+
+namespace vizkit3d
+{
+
+/**
+ * Draws a mesh once per instance of an InstanceBuffer, with a single
+ * geometry
+ *
+ * The instance attributes are given to a vertex shader as per-instance
+ * vertex attributes (divisor 1), so that the scene graph does not grow with
+ * the number of instances. The mesh must have a vertex array, optionally a
+ * per-vertex color array, and DrawElements or DrawArrays primitive sets.
+ */
+class InstancedMesh
+{
+public:
+    /** Vertex attribute locations of the instance attributes */
+    enum Attributes
+    {
+        POSITION_ATTRIBUTE = 5,
+        ORIENTATION_ATTRIBUTE = 6,
+        COLOR_ATTRIBUTE = 7
+    };
+
+    /**
+     * @param mesh the mesh, which is modified to draw the instances
+     * @param mesh_radius the radius of a sphere around the origin of the
+     *   mesh that contains it, used for the bounding box
+     */
+    InstancedMesh(osg::Geometry* mesh, float mesh_radius);
+
+    /** The node to add to the scene graph */
+    osg::ref_ptr<osg::Node> getNode() const { return transform; }
+
+    /** Copies the instance attributes that changed since the last call
+     *
+     * Only the dirty range of @a instances is copied, the caller is
+     * expected to call InstanceBuffer::clearDirty() afterwards. A mesh must
+     * therefore always be updated from the same buffer.
+     */
+    void update(InstanceBuffer const& instances);
+
+private:
+    float mesh_radius;
+    osg::ref_ptr<osg::Geometry> mesh;
+    osg::ref_ptr<osg::PositionAttitudeTransform> transform;
+    osg::ref_ptr<osg::Vec4Array> positions;
+    osg::ref_ptr<osg::Vec4Array> orientations;
+    osg::ref_ptr<osg::Vec4Array> colors;
+};
+
+}
+#endif
@@ -0,0 +1,104 @@
+#include "LaserScanConverter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vizkit3d
+{
+
+LaserScanConverter::LaserScanConverter()
+    : y_forward(false)
+    , interval_mm(200)
+    , cached(false)
+    , start_angle(0)
+    , angular_resolution(0)
+    , beam_count(0)
+    , table_updates(0)
+{
+}
+
+void LaserScanConverter::setYForward(bool enabled)
+{
+    if (enabled != y_forward)
+        cached = false;
+    y_forward = enabled;
+}
+
+void LaserScanConverter::setColorizeInterval(double interval)
+{
+    interval_mm = std::max(1, static_cast<int>(interval * 1000));
+}
+
+void LaserScanConverter::setPalette(base::aligned::vector<Eigen::Vector4f> const& palette)
+{
+    this->palette = palette;
+}
+
+void LaserScanConverter::updateTable(base::samples::LaserScan const& scan)
+{
+    start_angle = scan.start_angle;
+    angular_resolution = scan.angular_resolution;
+    beam_count = scan.ranges.size();
+
+    directions.resize(3 * beam_count);
+    forward.resize(beam_count);
+    for (size_t i = 0; i < beam_count; ++i)
+    {
+        // same angle as LaserScan::getPointFromScanBeamXForward
+        const double angle = start_angle + i * angular_resolution;
+        const double c = std::cos(angle) / 1000.0;
+        const double s = std::sin(angle) / 1000.0;
+        // the Y-forward mode is a rotation by +90 degrees around Z
+        directions[3 * i] = y_forward ? -s : c;
+        directions[3 * i + 1] = y_forward ? c : s;
+        directions[3 * i + 2] = 0;
+        forward[i] = std::cos(angle);
+    }
+    cached = true;
+    ++table_updates;
+}
+
+size_t LaserScanConverter::convert(base::samples::LaserScan const& scan, float* vertices, float* colors)
+{
+    if (colors && palette.empty())
+        throw std::logic_error("LaserScanConverter::convert: colorizing requires a palette");
+
+    if (!cached || start_angle != scan.start_angle || angular_resolution != scan.angular_resolution
+            || beam_count != scan.ranges.size())
+        updateTable(scan);
+
+    const base::samples::LaserScan::uint32_t min_range =
+        std::max<base::samples::LaserScan::uint32_t>(scan.minRange, base::samples::END_LASER_RANGE_ERRORS);
+    const base::samples::LaserScan::uint32_t max_range = scan.maxRange;
+    const float palette_scale = static_cast<float>(palette.size()) / interval_mm;
+
+    size_t count = 0;
+    for (size_t i = 0; i < beam_count; ++i)
+    {
+        // same test as LaserScan::isRangeValid
+        const base::samples::LaserScan::uint32_t range = scan.ranges[i];
+        if (range < min_range || range > max_range)
+            continue;
+
+        const float r = range;
+        float* v = vertices + 3 * count;
+        v[0] = r * directions[3 * i];
+        v[1] = r * directions[3 * i + 1];
+        v[2] = 0;
+
+        if (colors)
+        {
+            // the forward distance in millimeters, modulo the interval,
+            // wrapped to positive values for points behind the scanner
+            int cycle = static_cast<int>(range * forward[i]) % interval_mm;
+            if (cycle < 0)
+                cycle += interval_mm;
+            const size_t index = std::min(static_cast<size_t>(cycle * palette_scale), palette.size() - 1);
+            std::copy(palette[index].data(), palette[index].data() + 4, colors + 4 * count);
+        }
+        ++count;
+    }
+    return count;
+}
+
+}
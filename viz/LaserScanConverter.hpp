@@ -0,0 +1,85 @@
+#ifndef LASER_SCAN_CONVERTER_HPP
+#define LASER_SCAN_CONVERTER_HPP
+
+#include <vector>
+#include <Eigen/Core>
+#include <base/Eigen.hpp>
+#include <base/samples/LaserScan.hpp>
+
+namespace vizkit3d
+{
+
+/**
+ * Converts laser scans to vertices and colors, independent of OSG
+ *
+ * The direction of each beam, including the optional Y-forward rotation and
+ * the conversion from millimeters, is computed once per scan geometry
+ * (start_angle, angular_resolution and number of beams), so that a point is
+ * a multiplication of its range by a cached direction.
+ *
+ * When colorizing, the forward distance of a point (its x coordinate in the
+ * scanner frame) modulo the colorize interval selects a color in a palette,
+ * which replaces a trigonometric and an HSL conversion per beam by a table
+ * lookup.
+ *
+ * The output has the memory layout of osg::Vec3Array (3 floats per vertex)
+ * and osg::Vec4Array (4 floats per color), and can be written directly into
+ * these arrays.
+ */
+class LaserScanConverter
+{
+public:
+    LaserScanConverter();
+
+    /** If true, the points are rotated by 90 degrees around Z, for scanners
+     * whose forward axis is Y */
+    void setYForward(bool enabled);
+    bool isYForward() const { return y_forward; }
+
+    /** Length of the color cycle along the forward axis, in meters. Values
+     * below one millimeter are set to one millimeter */
+    void setColorizeInterval(double interval);
+    double getColorizeInterval() const { return interval_mm / 1000.0; }
+
+    /** Colors of one color cycle, as RGBA. The color of a point is
+     * palette[(x mod interval) / interval * palette.size()] */
+    void setPalette(base::aligned::vector<Eigen::Vector4f> const& palette);
+    base::aligned::vector<Eigen::Vector4f> const& getPalette() const { return palette; }
+
+    /**
+     * Converts the valid beams of a scan
+     *
+     * @param vertices output vertices, with room for scan.ranges.size()
+     *   points
+     * @param colors output colors, with room for scan.ranges.size() colors,
+     *   or NULL if the points should not be colorized. The palette must not
+     *   be empty then
+     * @return the number of points, i.e. of valid beams
+     */
+    size_t convert(base::samples::LaserScan const& scan, float* vertices, float* colors = 0);
+
+    /** Number of times the beam directions have been computed */
+    size_t getTableUpdates() const { return table_updates; }
+
+private:
+    void updateTable(base::samples::LaserScan const& scan);
+
+    bool y_forward;
+    int interval_mm;
+    base::aligned::vector<Eigen::Vector4f> palette;
+
+    /** Scan geometry of the table */
+    bool cached;
+    double start_angle;
+    double angular_resolution;
+    size_t beam_count;
+    size_t table_updates;
+
+    /** Per beam: direction in meters per millimeter (3 floats) and cosine of
+     * the beam angle */
+    std::vector<float> directions;
+    std::vector<float> forward;
+};
+
+}
+#endif
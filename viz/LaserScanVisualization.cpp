@@ -10,20 +10,75 @@
 
 using namespace vizkit3d;
 
+/** Number of colors of the colorize palette */
+static const int PALETTE_SIZE = 256;
+
 vizkit3d::LaserScanVisualization::LaserScanVisualization()
     : mYForward(false),colorize(false),show_polygon(true),colorize_interval(0.2)
 {
     scanOrientation = Eigen::Quaterniond::Identity();
     scanPosition.setZero();
+
+    // the hue cycles along the forward axis, see LaserScanConverter
+    base::aligned::vector<Eigen::Vector4f> palette(PALETTE_SIZE, Eigen::Vector4f::Ones());
+    for(int i = 0; i < PALETTE_SIZE; i++)
+        hslToRgb(float(i) / PALETTE_SIZE, 1.0, 0.5, palette[i][0], palette[i][1], palette[i][2]);
+    converter.setPalette(palette);
+
+    worker.reset(new CoalescingWorker<base::samples::LaserScan, ScanArrays>(
+                [this](base::samples::LaserScan const& scan, ScanArrays& arrays) { convertScan(scan, arrays); },
+                [this]() { setDirty(); }));
 }
 
 vizkit3d::LaserScanVisualization::~LaserScanVisualization()
 {
+    // join the worker thread, which uses the converter, first
+    worker.reset();
 }
 
 void vizkit3d::LaserScanVisualization::updateDataIntern(const base::samples::LaserScan& data)
 {
-    scan = data;
+    worker->push(data);
+}
+
+void vizkit3d::LaserScanVisualization::convertScan(base::samples::LaserScan const& scan, ScanArrays& arrays)
+{
+    bool colorized;
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        converter.setYForward(mYForward);
+        converter.setColorizeInterval(colorize_interval);
+        colorized = colorize;
+    }
+
+    // the arrays are reused. Arrays handed back by fetch() have been
+    // replaced in the geometry by updateMainNode, which is not concurrent
+    // with the drawing of the (dynamic) geometry
+    if(!arrays.vertices)
+        arrays.vertices = new osg::Vec3Array;
+    if(!arrays.colors)
+        arrays.colors = new osg::Vec4Array;
+    arrays.colorized = colorized;
+
+    // the origin of the polygon, then the points, written in place. The
+    // Y-forward rotation is part of the beam directions of the converter
+    osg::Vec3Array& vertices = *arrays.vertices;
+    osg::Vec4Array& colors = *arrays.colors;
+    const size_t max_points = scan.ranges.size();
+    vertices.resize(max_points + 1);
+    vertices[0] = osg::Vec3(0,0,0);
+    size_t count = 0;
+    if(colorized)
+    {
+        colors.resize(max_points + 1);
+        colors[0] = osg::Vec4(0.0,0.0,0.0,0.0);
+        if(max_points)
+            count = converter.convert(scan, vertices[1].ptr(), colors[1].ptr());
+        colors.resize(count + 1);
+    }
+    else if(max_points)
+        count = converter.convert(scan, vertices[1].ptr());
+    vertices.resize(count + 1);
 }
 
 void vizkit3d::LaserScanVisualization::updateDataIntern(const base::samples::RigidBodyState& data)
@@ -39,6 +94,15 @@ osg::ref_ptr< osg::Node > vizkit3d::LaserScanVisualization::createMainNode()
     transformNode->addChild(scanNode);
 
     scanGeom = new osg::Geometry();
+    // the arrays are swapped with the ones converted by the worker on
+    // updates
+    scanGeom->setDataVariance(osg::Object::DYNAMIC);
+    fixedColors = new osg::Vec4Array();
+    fixedColors->push_back(osg::Vec4(0,0,0.3,0.5));
+    fixedColors->push_back(osg::Vec4(1,0,0,1));
+    scanGeom->setVertexArray(new osg::Vec3Array());
+    polygonPrimitive = new osg::DrawArrays(osg::PrimitiveSet::POLYGON, 0, 0);
+    pointsPrimitive = new osg::DrawArrays(osg::PrimitiveSet::POINTS, 0, 0);
 
     //setup normals
     osg::ref_ptr<osg::Vec3Array> normals = new osg::Vec3Array;
@@ -65,61 +129,44 @@ void vizkit3d::LaserScanVisualization::updateMainNode(osg::Node* node)
 {
     transformNode->setPosition(eigenVectorToOsgVec3(scanPosition));
     transformNode->setAttitude(eigenQuatToOsgQuat(scanOrientation));
-    
-    osg::Vec3Array *scanVertices = new osg::Vec3Array();
 
-    std::vector<Eigen::Vector3d> points;
-    scan.convertScanToPointCloud(points);
-    if (mYForward)
+    bool updated = false;
+    try
     {
-        base::Quaterniond rot;
-        rot = Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitZ());
-        for(std::vector<Eigen::Vector3d>::iterator it = points.begin(); it != points.end(); it++)
-            *it = rot * (*it);
+        updated = worker->fetch(displayed);
+    }
+    catch(std::exception const& e)
+    {
+        std::cerr << "LaserScanVisualization: cannot display laser scan: " << e.what() << std::endl;
     }
 
-    if(colorize)    
+    if(updated)
     {
-        osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array;
-        colors->push_back(osg::Vec4(0.0,0.0,0.0,0.0));
-        float col;
-        int interval = colorize_interval*1000;
-        double angle = scan.start_angle;
-        for(std::vector<uint32_t>::const_iterator it = scan.ranges.begin(); it != scan.ranges.end(); it++,angle+=scan.angular_resolution)
+        scanGeom->setVertexArray(displayed.vertices.get());
+        if(displayed.colorized)
         {
-            if(scan.isRangeValid(*it))
-            {
-                col  = ((float)(((int)(*it*cos(angle))%interval)))/interval;
-                osg::Vec4 color( 1.0, 1.0, 1.0, 1.0 );
-                hslToRgb(col, 1.0, 0.5, color.r(), color.g(), color.b());
-                colors->push_back(color);
-            }
+            displayed.colors->dirty();
+            scanGeom->setColorArray(displayed.colors.get());
+            scanGeom->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
         }
-        scanGeom->setColorArray(colors.get());
-        scanGeom->setColorBinding( osg::Geometry::BIND_PER_VERTEX );
-    }
-    else
-    {
-        osg::Vec4Array *colors = new osg::Vec4Array();
-        colors->push_back(osg::Vec4(0,0,0.3,0.5));
-        colors->push_back(osg::Vec4(1,0,0,1));
-        scanGeom->setColorArray(colors);
-        scanGeom->setColorBinding(osg::Geometry::BIND_PER_PRIMITIVE_SET);
+        else
+        {
+            scanGeom->setColorArray(fixedColors.get());
+            scanGeom->setColorBinding(osg::Geometry::BIND_PER_PRIMITIVE_SET);
+        }
+        displayed.vertices->dirty();
+        polygonPrimitive->setCount(displayed.vertices->size());
+        pointsPrimitive->setCount(displayed.vertices->size());
+        scanGeom->dirtyBound();
     }
 
-    scanVertices->reserve(points.size()+1);
-    scanVertices->push_back(osg::Vec3(0,0,0));
-
-    for(std::vector<Eigen::Vector3d>::const_iterator it = points.begin(); it != points.end(); it++)
-	scanVertices->push_back(eigenVectorToOsgVec3(*it));
-    scanGeom->setVertexArray(scanVertices);
-
     while(!scanGeom->getPrimitiveSetList().empty())
 	scanGeom->removePrimitiveSet(0);
-   
+    if(!displayed.vertices)
+        return;
     if(show_polygon)
-        scanGeom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POLYGON,0,scanVertices->size()));
-    scanGeom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POINTS,0,scanVertices->size()));
+        scanGeom->addPrimitiveSet(polygonPrimitive);
+    scanGeom->addPrimitiveSet(pointsPrimitive);
 }
 
 //display only points  
@@ -151,13 +198,37 @@ osg::ref_ptr<osg::Node> LaserScanVisualization::cloneCurrentViz()
 }
 
 bool LaserScanVisualization::isYForwardModeEnabled() const { return mYForward; }
-void LaserScanVisualization::setYForwardMode(bool enabled) { mYForward = enabled; emit propertyChanged("YForward"); }
+void LaserScanVisualization::setYForwardMode(bool enabled)
+{
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        mYForward = enabled;
+    }
+    worker->repeat();
+    emit propertyChanged("YForward");
+}
 
-void LaserScanVisualization::setColorize(bool value){colorize = value;emit propertyChanged("Colorize");}
+void LaserScanVisualization::setColorize(bool value)
+{
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        colorize = value;
+    }
+    worker->repeat();
+    emit propertyChanged("Colorize");
+}
 bool LaserScanVisualization::isColorizeEnabled()const { return colorize; }
 
-void LaserScanVisualization::setShowPolygon(bool value){show_polygon = value;emit propertyChanged("ShowPolygon");}
+void LaserScanVisualization::setShowPolygon(bool value){show_polygon = value;setDirty();emit propertyChanged("ShowPolygon");}
 bool LaserScanVisualization::isShowPolygonEnabled()const { return show_polygon; }
 
-void LaserScanVisualization::setColorizeInterval(double value){colorize_interval = value;emit propertyChanged("ColorizeInterval");}
+void LaserScanVisualization::setColorizeInterval(double value)
+{
+    {
+        std::lock_guard<std::mutex> lock(settings_mutex);
+        colorize_interval = value;
+    }
+    worker->repeat();
+    emit propertyChanged("ColorizeInterval");
+}
 double LaserScanVisualization::getColorizeInterval()const { return colorize_interval; }
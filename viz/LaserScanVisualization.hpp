@@ -4,6 +4,12 @@
 #include <base/samples/LaserScan.hpp>
 #include <base/samples/RigidBodyState.hpp>
 #include <vizkit3d/Vizkit3DPlugin.hpp>
+#include <osg/Array>
+#include <osg/PrimitiveSet>
+#include <boost/scoped_ptr.hpp>
+#include <mutex>
+#include "LaserScanConverter.hpp"
+#include "CoalescingWorker.hpp"
 
 namespace osg {
     class Geometry;
@@ -11,6 +17,13 @@ namespace osg {
 
 namespace vizkit3d {
 
+/**
+ * Displays laser scans as points, and optionally as the polygon they enclose
+ *
+ * The scans are converted on a worker thread (see CoalescingWorker), which
+ * only converts the latest scan when they arrive faster than they can be
+ * converted. The render thread only swaps in the converted arrays.
+ */
 class LaserScanVisualization : public Vizkit3DPlugin<base::samples::LaserScan>, public VizPluginAddType<base::samples::RigidBodyState>
 {
     Q_OBJECT
@@ -56,13 +69,36 @@ protected:
     osg::ref_ptr<osg::Node> cloneCurrentViz();
 
 private:
-    base::samples::LaserScan scan;
+    /** Converted scan, handed over from the worker to updateMainNode */
+    struct ScanArrays
+    {
+        /** The origin of the polygon, then the points */
+        osg::ref_ptr<osg::Vec3Array> vertices;
+        /** Colors of the vertices, only used when colorized */
+        osg::ref_ptr<osg::Vec4Array> colors;
+        bool colorized;
+
+        ScanArrays() : colorized(false) {}
+    };
+
+    void convertScan(base::samples::LaserScan const& scan, ScanArrays& arrays);
+
     Eigen::Vector3d scanPosition;
     Eigen::Quaterniond scanOrientation;
     osg::ref_ptr< osg::PositionAttitudeTransform > transformNode;
     osg::ref_ptr<osg::Geode> scanNode;
     osg::ref_ptr<osg::Geometry> scanGeom;
+    osg::ref_ptr<osg::Vec4Array> fixedColors;
+    osg::ref_ptr<osg::DrawArrays> polygonPrimitive;
+    osg::ref_ptr<osg::DrawArrays> pointsPrimitive;
+    /** Only used by the worker */
+    LaserScanConverter converter;
+    /** The arrays attached to the geometry */
+    ScanArrays displayed;
+    boost::scoped_ptr< CoalescingWorker<base::samples::LaserScan, ScanArrays> > worker;
 
+    /** Protects the properties read by the worker */
+    std::mutex settings_mutex;
     bool colorize;
     bool show_polygon;
     double colorize_interval;   // 1/distance 
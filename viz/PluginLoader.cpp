@@ -4,12 +4,15 @@
 #include "MotionCommandVisualization.hpp"
 #include "TrajectoryVisualization.hpp"
 #include "RigidBodyStateVisualization.hpp"
+#include "RigidBodyStateCollectionVisualization.hpp"
 #include "BodyStateVisualization.hpp"
 #include "SonarGroundDistanceVisualization.hpp"
 #include "PointcloudVisualization.hpp"
 #include "SonarBeamVisualization.hpp"
 #include "DepthMapVisualization.hpp"
 #include "DistanceImageVisualization.hpp"
+#include "FrameVisualization.hpp"
+#include "SonarVisualization.hpp"
 
 namespace vizkit3d {
     class QtPluginVizkitBase : public vizkit3d::VizkitPluginFactory {
@@ -30,6 +33,7 @@ namespace vizkit3d {
 	    pluginNames->push_back("TrajectoryVisualization");
 	    pluginNames->push_back("MotionCommandVisualization");
 	    pluginNames->push_back("RigidBodyStateVisualization");
+	    pluginNames->push_back("RigidBodyStateCollectionVisualization");
 	    pluginNames->push_back("BodyStateVisualization");
 	    pluginNames->push_back("LaserScanVisualization");
 	    pluginNames->push_back("SonarGroundDistanceVisualization");
@@ -37,6 +41,8 @@ namespace vizkit3d {
 	    pluginNames->push_back("SonarBeamVisualization");
 	    pluginNames->push_back("DepthMapVisualization");
 	    pluginNames->push_back("DistanceImageVisualization");
+	    pluginNames->push_back("FrameVisualization");
+	    pluginNames->push_back("SonarVisualization");
 	    return pluginNames;
 	}
 	
@@ -59,6 +65,10 @@ namespace vizkit3d {
 	    {
 		    plugin = new vizkit3d::RigidBodyStateVisualization();
 	    }
+	    else if (pluginName == "RigidBodyStateCollectionVisualization")
+	    {
+		    plugin = new vizkit3d::RigidBodyStateCollectionVisualization();
+	    }
 	    else if (pluginName == "BodyStateVisualization")
 	    {
     		plugin = new vizkit3d::BodyStateVisualization();
@@ -87,6 +97,14 @@ namespace vizkit3d {
 	    {
 		plugin = new vizkit3d::DistanceImageVisualization();
 	    }
+	    else if (pluginName == "FrameVisualization")
+	    {
+		plugin = new vizkit3d::FrameVisualization();
+	    }
+	    else if (pluginName == "SonarVisualization")
+	    {
+		plugin = new vizkit3d::SonarVisualization();
+	    }
 
 	    if (plugin) 
 	    {
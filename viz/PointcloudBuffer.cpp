@@ -0,0 +1,158 @@
+#include "PointcloudBuffer.hpp"
+#include <algorithm>
+
+namespace vizkit3d
+{
+
+typedef Eigen::Map< const Eigen::Matrix<double, 3, Eigen::Dynamic> > PointMapConst;
+typedef Eigen::Map< const Eigen::Matrix<double, 4, Eigen::Dynamic> > ColorMapConst;
+typedef Eigen::Map< Eigen::Matrix<float, 3, Eigen::Dynamic> > VertexMap;
+typedef Eigen::Map< Eigen::Matrix<float, 4, Eigen::Dynamic> > FloatColorMap;
+
+PointcloudBuffer::PointcloudBuffer(size_t history_size)
+    : history_size(std::max<size_t>(history_size, 1))
+    , default_color(1, 1, 1, 1)
+    , capacity(0)
+{
+    clear();
+}
+
+void PointcloudBuffer::setHistorySize(size_t history_size)
+{
+    this->history_size = std::max<size_t>(history_size, 1);
+    while (clouds.size() > this->history_size)
+        clouds.pop_front();
+}
+
+void PointcloudBuffer::clear()
+{
+    clouds.clear();
+    head = 0;
+    dirty_begin = dirty_end = 0;
+    reallocated = false;
+}
+
+size_t PointcloudBuffer::getPointCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < clouds.size(); ++i)
+        count += clouds[i].count;
+    return count;
+}
+
+long PointcloudBuffer::findSpace(size_t count) const
+{
+    // start of the oldest live points, which must not be overwritten
+    size_t tail = 0;
+    bool has_live = false;
+    for (size_t i = 0; i < clouds.size() && !has_live; ++i)
+    {
+        if (clouds[i].count)
+        {
+            tail = clouds[i].first;
+            has_live = true;
+        }
+    }
+
+    if (!has_live)
+        return count <= capacity ? 0 : -1;
+    if (head > tail)
+    {
+        if (head + count <= capacity)
+            return head;
+        if (count <= tail)
+            return 0;
+        return -1;
+    }
+    if (head + count <= tail)
+        return head;
+    return -1;
+}
+
+void PointcloudBuffer::grow(size_t count)
+{
+    const size_t live = getPointCount();
+    const size_t new_capacity = std::max(2 * capacity, live + count);
+    std::vector<float> new_vertices(3 * new_capacity);
+    std::vector<float> new_colors(4 * new_capacity);
+
+    size_t position = 0;
+    for (size_t i = 0; i < clouds.size(); ++i)
+    {
+        Range& cloud = clouds[i];
+        std::copy(vertices.begin() + 3 * cloud.first, vertices.begin() + 3 * (cloud.first + cloud.count),
+                  new_vertices.begin() + 3 * position);
+        std::copy(colors.begin() + 4 * cloud.first, colors.begin() + 4 * (cloud.first + cloud.count),
+                  new_colors.begin() + 4 * position);
+        cloud.first = position;
+        position += cloud.count;
+    }
+
+    vertices.swap(new_vertices);
+    colors.swap(new_colors);
+    capacity = new_capacity;
+    head = position;
+    reallocated = true;
+    markDirty(0, position);
+}
+
+void PointcloudBuffer::markDirty(size_t first, size_t count)
+{
+    if (!count)
+        return;
+    if (dirty_begin == dirty_end)
+    {
+        dirty_begin = first;
+        dirty_end = first + count;
+    }
+    else
+    {
+        dirty_begin = std::min(dirty_begin, first);
+        dirty_end = std::max(dirty_end, first + count);
+    }
+}
+
+void PointcloudBuffer::push(base::samples::Pointcloud const& cloud)
+{
+    while (clouds.size() >= history_size)
+        clouds.pop_front();
+
+    const size_t count = cloud.points.size();
+    long position = findSpace(count);
+    if (position < 0)
+    {
+        grow(count);
+        position = head;
+    }
+
+    if (count)
+    {
+        VertexMap(&vertices[3 * position], 3, count) =
+            PointMapConst(cloud.points.front().data(), 3, count).cast<float>();
+
+        FloatColorMap color_map(&colors[4 * position], 4, count);
+        if (cloud.colors.size() == count)
+            color_map = ColorMapConst(cloud.colors.front().data(), 4, count).cast<float>();
+        else
+            color_map.colwise() = default_color;
+    }
+
+    clouds.push_back(Range(position, count));
+    head = position + count;
+    markDirty(position, count);
+}
+
+PointcloudBuffer::Range PointcloudBuffer::getDirtyRange() const
+{
+    if (reallocated)
+        return Range(0, capacity);
+    return Range(dirty_begin, dirty_end - dirty_begin);
+}
+
+void PointcloudBuffer::clearDirty()
+{
+    dirty_begin = dirty_end = 0;
+    reallocated = false;
+}
+
+}
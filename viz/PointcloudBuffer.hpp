@@ -0,0 +1,109 @@
+#ifndef POINTCLOUD_BUFFER_HPP
+#define POINTCLOUD_BUFFER_HPP
+
+#include <vector>
+#include <deque>
+#include <Eigen/Core>
+#include <base/samples/Pointcloud.hpp>
+
+namespace vizkit3d
+{
+
+/**
+ * Vertex and color storage for the last N point clouds, independent of OSG
+ *
+ * The points are converted in bulk into single precision arrays (3 floats
+ * per vertex, 4 per color), with the memory layout of osg::Vec3Array and
+ * osg::Vec4Array, so that they can be copied to the GPU-side arrays with a
+ * memcpy.
+ *
+ * The arrays are used as a ring buffer: a new cloud is written after the
+ * previous one, or at the beginning when it does not fit at the end, and the
+ * oldest cloud is dropped when the history is full. Only the part of the
+ * arrays written since the last clearDirty() has to be copied. The arrays
+ * only grow (doubling) when the live clouds do not fit anymore, in which case
+ * they are compacted and entirely dirty.
+ */
+class PointcloudBuffer
+{
+public:
+    /** Range of vertices, in number of points */
+    struct Range
+    {
+        size_t first;
+        size_t count;
+
+        Range() : first(0), count(0) {}
+        Range(size_t first, size_t count) : first(first), count(count) {}
+    };
+
+    /**
+     * @param history_size the number of clouds that are kept
+     */
+    explicit PointcloudBuffer(size_t history_size = 1);
+
+    /** Changes the number of clouds that are kept, dropping the oldest
+     * ones if needed */
+    void setHistorySize(size_t history_size);
+    size_t getHistorySize() const { return history_size; }
+
+    /** Color of the points of clouds without colors, as RGBA */
+    void setDefaultColor(Eigen::Vector4f const& color) { default_color = color; }
+    Eigen::Vector4f getDefaultColor() const { return default_color; }
+
+    /** Removes all clouds */
+    void clear();
+
+    /** Appends a cloud, dropping the oldest one if the history is full */
+    void push(base::samples::Pointcloud const& cloud);
+
+    /** Returns the vertex ranges of the live clouds, oldest first */
+    std::deque<Range> const& getClouds() const { return clouds; }
+
+    /** Total number of live points */
+    size_t getPointCount() const;
+
+    /** Size of the arrays, in points */
+    size_t getCapacity() const { return capacity; }
+
+    /** Vertices, 3 floats per point, for getCapacity() points */
+    float const* getVertices() const { return vertices.empty() ? 0 : &vertices[0]; }
+
+    /** Colors, 4 floats per point, for getCapacity() points */
+    float const* getColors() const { return colors.empty() ? 0 : &colors[0]; }
+
+    /** Range of the points modified since the last clearDirty() */
+    Range getDirtyRange() const;
+
+    /** True if the capacity changed since the last clearDirty(). The whole
+     * arrays are dirty then */
+    bool isReallocated() const { return reallocated; }
+
+    void clearDirty();
+
+private:
+    /** Returns the position where @a count points can be written without
+     * overwriting live clouds, or -1 if there is none */
+    long findSpace(size_t count) const;
+
+    /** Grows the arrays so that @a count more points fit, and moves the live
+     * clouds to their beginning */
+    void grow(size_t count);
+
+    void markDirty(size_t first, size_t count);
+
+    size_t history_size;
+    /** Unaligned, as the buffer is a member of heap-allocated plugins */
+    Eigen::Matrix<float, 4, 1, Eigen::DontAlign> default_color;
+    std::vector<float> vertices;
+    std::vector<float> colors;
+    std::deque<Range> clouds;
+    size_t capacity;
+    size_t head;
+    size_t dirty_begin;
+    size_t dirty_end;
+    bool reallocated;
+};
+
+}
+#endif
@@ -1,6 +1,8 @@
 #include "PointcloudVisualization.hpp"
 #include <osg/Geode>
 #include <osg/Point>
+#include <cstring>
+#include <algorithm>
 
 namespace vizkit3d
 {
@@ -9,6 +11,7 @@ const double DEFAULT_POINT_SIZE = 2.0;
 PointcloudVisualization::PointcloudVisualization()
 {
     newPoints = false;
+    history_size = 1;
     default_feature_color = osg::Vec4f(1.0f, 1.0f, 1.0f, 1.0f);
 }
 
@@ -23,14 +26,14 @@ osg::ref_ptr< osg::Node > PointcloudVisualization::createMainNode()
 
     // set up point cloud
     pointGeom = new osg::Geometry;
+    pointGeom->setUseDisplayList(false);
+    pointGeom->setUseVertexBufferObjects(true);
     pointsOSG = new osg::Vec3Array;
     pointGeom->setVertexArray(pointsOSG);
     color = new osg::Vec4Array;
     pointGeom->setColorArray(color);
     pointGeom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
     pointGeom->getOrCreateStateSet()->setMode(GL_LIGHTING, osg::StateAttribute::OFF); 
-    drawArrays = new osg::DrawArrays( osg::PrimitiveSet::POINTS, 0, pointsOSG->size() );
-    pointGeom->addPrimitiveSet(drawArrays.get());
 
     osg::ref_ptr<osg::Geode> geode = new osg::Geode;
     geode->addDrawable(pointGeom.get());
@@ -67,6 +70,20 @@ void PointcloudVisualization::setPointSize(double size)
     emit propertyChanged("pointSize");
 }
 
+int PointcloudVisualization::getHistorySize()
+{
+    return history_size;
+}
+
+void PointcloudVisualization::setHistorySize(int size)
+{
+    // applied on the next update, as the buffer is only accessed from the
+    // update methods
+    history_size = std::max(size, 1);
+    setDirty();
+    emit propertyChanged("historySize");
+}
+
 double PointcloudVisualization::getPointSize()
 {
     if(pointGeom.valid())
@@ -85,41 +102,57 @@ double PointcloudVisualization::getPointSize()
  */
 void PointcloudVisualization::updateDataIntern(const base::samples::Pointcloud& data)
 {
-    pointCloud = data;
+    buffer.setHistorySize(history_size);
+    buffer.setDefaultColor(Eigen::Vector4f(default_feature_color.x(), default_feature_color.y(),
+                default_feature_color.z(), default_feature_color.w()));
+    buffer.push(data);
     newPoints = true;
 }
 
 /**
  * Main callback method of osg to update all drawings.
- * The method updates the position if there is a new one and
- * adds new sonar beams if there are new ones. If a wall 
- * estimatior is connected the position of the wall will 
- * be updated too.
+ * Copies the vertices of the clouds received since the last update to the
+ * geometry, and draws the clouds of the history.
  * 
  * @param node osg main node
  */
 void PointcloudVisualization::updateMainNode(osg::Node* node)
 {
-    if(newPoints)
+    const int history = history_size;
+    if(static_cast<int>(buffer.getHistorySize()) != history)
+    {
+        buffer.setHistorySize(history);
+        newPoints = true;
+    }
+    if(!newPoints)
+        return;
+    newPoints = false;
+
+    const size_t capacity = buffer.getCapacity();
+    if(pointsOSG->size() != capacity)
+    {
+        pointsOSG->resize(capacity);
+        color->resize(capacity);
+    }
+
+    // osg::Vec3Array and osg::Vec4Array have the layout of the buffer arrays
+    PointcloudBuffer::Range dirty = buffer.getDirtyRange();
+    if(dirty.count)
+    {
+        std::memcpy(&(*pointsOSG)[dirty.first], buffer.getVertices() + 3 * dirty.first, 3 * sizeof(float) * dirty.count);
+        std::memcpy(&(*color)[dirty.first], buffer.getColors() + 4 * dirty.first, 4 * sizeof(float) * dirty.count);
+        pointsOSG->dirty();
+        color->dirty();
+    }
+    buffer.clearDirty();
+
+    pointGeom->removePrimitiveSet(0, pointGeom->getNumPrimitiveSets());
+    const std::deque<PointcloudBuffer::Range>& clouds = buffer.getClouds();
+    for(size_t i = 0; i < clouds.size(); ++i)
     {
-        newPoints = false;
-        pointsOSG->clear();
-        color->clear();
-        bool use_colors = pointCloud.colors.size() == pointCloud.points.size();
-        for(size_t i=0; i<pointCloud.points.size(); i++)
-        {
-            osg::Vec3d vec(pointCloud.points[i][0], pointCloud.points[i][1], pointCloud.points[i][2]);
-            pointsOSG->push_back(vec);
-            if(use_colors)
-            {
-                color->push_back(osg::Vec4f(pointCloud.colors[i][0], pointCloud.colors[i][1], pointCloud.colors[i][2], pointCloud.colors[i][3]));
-            }else{
-                color->push_back(default_feature_color);
-            }
-        }
-        drawArrays->setCount(pointsOSG->size());
-        pointGeom->setVertexArray(pointsOSG);
-        pointGeom->setColorArray(color);
+        if(clouds[i].count)
+            pointGeom->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POINTS, clouds[i].first, clouds[i].count));
     }
+    pointGeom->dirtyBound();
 }
 }
@@ -3,9 +3,11 @@
 
 #include <vizkit3d/Vizkit3DPlugin.hpp>
 #include <base/samples/Pointcloud.hpp>
+#include "PointcloudBuffer.hpp"
 
 #include <osg/Node>
 #include <osg/Geometry>
+#include <atomic>
 
 namespace vizkit3d
 {
@@ -13,12 +15,16 @@ namespace vizkit3d
 /**
  * Vizkit plugin to visualize Pointcloudes.
  * 
+ * The last historySize clouds are displayed (only the last one by default).
+ * The clouds are converted to the vertex arrays when they are received, and
+ * only the vertices of the new clouds are copied to the geometry.
  */
 class PointcloudVisualization : public vizkit3d::Vizkit3DPlugin< base::samples::Pointcloud >
 {    
     Q_OBJECT
     Q_PROPERTY(QColor defaultFeatureColor READ getDefaultFeatureColor WRITE setDefaultFeatureColor)
     Q_PROPERTY(double pointSize READ getPointSize WRITE setPointSize)
+    Q_PROPERTY(int historySize READ getHistorySize WRITE setHistorySize)
     
     public:
         PointcloudVisualization();
@@ -35,16 +41,20 @@ class PointcloudVisualization : public vizkit3d::Vizkit3DPlugin< base::samples::
         double getPointSize();
         void setPointSize(double size);
 
+        int getHistorySize();
+        void setHistorySize(int size);
+
     protected:
         virtual osg::ref_ptr<osg::Node> createMainNode();
         virtual void updateMainNode( osg::Node* node );
         void updateDataIntern ( const base::samples::Pointcloud& data );
         
     private:
-        base::samples::Pointcloud pointCloud;
+        PointcloudBuffer buffer;
+        /** Written by the Qt thread, read by the update methods */
+        std::atomic<int> history_size;
         osg::Vec4f default_feature_color;
         osg::ref_ptr<osg::Vec3Array> pointsOSG;
-        osg::ref_ptr<osg::DrawArrays> drawArrays;
         osg::ref_ptr<osg::Geometry> pointGeom;
         osg::ref_ptr<osg::Vec4Array> color;
         bool newPoints;
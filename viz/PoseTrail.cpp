@@ -0,0 +1,84 @@
+#include "PoseTrail.hpp"
+
+namespace vizkit3d
+{
+
+PoseTrail::PoseTrail(size_t max_points)
+    : threshold(0, 0)
+    , points(max_points, false)
+    , origin(base::Vector3d::Zero())
+    , last_pose(Eigen::Affine3d::Identity())
+    , dropped(0)
+{
+    bounds.setEmpty();
+}
+
+void PoseTrail::setMaxPoints(size_t max_points)
+{
+    const size_t count = size();
+    points.setMaxPoints(max_points);
+    if (size() < count)
+        updateBounds();
+}
+
+void PoseTrail::setThreshold(base::PoseUpdateThreshold const& threshold)
+{
+    this->threshold = threshold;
+}
+
+void PoseTrail::clear()
+{
+    points.clear();
+    origin.setZero();
+    last_pose.setIdentity();
+    bounds.setEmpty();
+    dropped = 0;
+}
+
+bool PoseTrail::update(Eigen::Affine3d const& pose)
+{
+    if (!empty() && !threshold.test(last_pose, pose))
+        return false;
+
+    last_pose = pose;
+    push(pose.translation());
+    return true;
+}
+
+bool PoseTrail::update(Eigen::Vector3d const& position)
+{
+    // the last orientation is kept for the next update(pose)
+    if (!empty() && !((position - last_pose.translation()).norm() > threshold.distance))
+        return false;
+
+    last_pose.translation() = position;
+    push(position);
+    return true;
+}
+
+void PoseTrail::push(Eigen::Vector3d const& position)
+{
+    if (empty())
+        origin = position;
+    const Eigen::Vector3f relative = (position - origin).cast<float>();
+    if (size() == getMaxPoints())
+        ++dropped;
+    points.push(relative);
+    bounds.extend(relative);
+    if (dropped >= size())
+        updateBounds();
+}
+
+void PoseTrail::updateBounds()
+{
+    bounds.setEmpty();
+    if (!empty())
+    {
+        Eigen::Map<const Eigen::Matrix3Xf> live(points.getVertices(), 3, size());
+        bounds.extend(Eigen::Vector3f(live.rowwise().minCoeff()));
+        bounds.extend(Eigen::Vector3f(live.rowwise().maxCoeff()));
+    }
+    dropped = 0;
+}
+
+}
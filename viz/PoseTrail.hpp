@@ -0,0 +1,91 @@
+#ifndef POSE_TRAIL_HPP
+#define POSE_TRAIL_HPP
+
+#include <Eigen/Geometry>
+#include <base/Eigen.hpp>
+#include <base/Pose.hpp>
+#include "TrajectoryPointBuffer.hpp"
+
+namespace vizkit3d
+{
+
+/**
+ * The last positions of a moving body, independent of OSG
+ *
+ * The positions are stored in a TrajectoryPointBuffer of fixed capacity,
+ * without colors as the trail has a single one, so that adding a pose is
+ * O(1) and the oldest positions are dropped once the trail is full. A new
+ * position is only added if the body moved more than the threshold since
+ * the last one, which avoids filling the trail with the same position when
+ * the body does not move.
+ *
+ * As in InstanceBuffer, the positions are stored relative to an origin, the
+ * first position added after clear(), to keep the single precision of the
+ * vertices.
+ */
+class PoseTrail
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    /** @param max_points the number of positions that are kept */
+    explicit PoseTrail(size_t max_points = 10000);
+
+    /** Changes the number of positions that are kept, dropping the oldest
+     * ones if needed */
+    void setMaxPoints(size_t max_points);
+    size_t getMaxPoints() const { return points.getMaxPoints(); }
+
+    /** Minimal motion, in distance or angle, between two positions of the
+     * trail. The default (zero) keeps every pose that moved */
+    void setThreshold(base::PoseUpdateThreshold const& threshold);
+    base::PoseUpdateThreshold const& getThreshold() const { return threshold; }
+
+    /** Removes all positions, and resets the origin */
+    void clear();
+
+    /** Adds the position of a pose if it moved enough since the last one
+     *
+     * @return true if the position was added
+     */
+    bool update(Eigen::Affine3d const& pose);
+
+    /** Same as update(pose), for bodies with an unknown orientation. Only
+     * the distance threshold is tested */
+    bool update(Eigen::Vector3d const& position);
+
+    size_t size() const { return points.size(); }
+    bool empty() const { return points.empty(); }
+
+    base::Vector3d const& getOrigin() const { return origin; }
+
+    /** Bounds of the positions, relative to the origin
+     *
+     * The box is conservative: it contains all the live positions, but may
+     * still contain dropped ones. It is computed again from the live
+     * positions once as many positions were dropped as there are live
+     * ones, which keeps adding a position amortized O(1).
+     */
+    Eigen::AlignedBox3f const& getBounds() const { return bounds; }
+
+    /** The positions, relative to the origin */
+    TrajectoryPointBuffer const& getPoints() const { return points; }
+
+    /** Clears the dirty range of the points, once they have been copied */
+    void clearDirty() { points.clearDirty(); }
+
+private:
+    void push(Eigen::Vector3d const& position);
+    void updateBounds();
+
+    base::PoseUpdateThreshold threshold;
+    TrajectoryPointBuffer points;
+    base::Vector3d origin;
+    Eigen::Affine3d last_pose;
+    Eigen::AlignedBox3f bounds;
+    /** Positions dropped since the bounds were last computed */
+    size_t dropped;
+};
+
+}
+#endif
@@ -0,0 +1,167 @@
+#include "PoseTrailNode.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <osg/Geode>
+
+using namespace vizkit3d;
+
+namespace
+{
+    /** Bounding box of the trail, which avoids going through the whole
+     * vertex array each time a position is added */
+    struct TrailBound : public osg::Drawable::ComputeBoundingBoxCallback
+    {
+        osg::BoundingBox box;
+
+        osg::BoundingBox computeBound(osg::Drawable const&) const
+        { return box; }
+    };
+}
+
+PoseTrailNode::PoseTrailNode()
+{
+    vertices = new osg::Vec3Array;
+    colors = new osg::Vec4Array;
+    colors->push_back(osg::Vec4(1, 1, 1, 1));
+    strip = new osg::DrawArrays(osg::PrimitiveSet::LINE_STRIP, 0, 0);
+
+    geometry = new osg::Geometry;
+    geometry->setDataVariance(osg::Object::DYNAMIC);
+    geometry->setUseDisplayList(false);
+    geometry->setUseVertexBufferObjects(true);
+    geometry->setVertexArray(vertices);
+    geometry->setColorArray(colors);
+    geometry->setColorBinding(osg::Geometry::BIND_OVERALL);
+    geometry->addPrimitiveSet(strip);
+    geometry->setComputeBoundingBoxCallback(new TrailBound);
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(geometry);
+    geode->getOrCreateStateSet()->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+    addChild(geode);
+}
+
+void PoseTrailNode::setColor(osg::Vec4 const& color)
+{
+    if ((*colors)[0] == color)
+        return;
+    (*colors)[0] = color;
+    colors->dirty();
+}
+
+void PoseTrailNode::update(PoseTrail& trail, osg::Vec3 const& offset)
+{
+    TrajectoryPointBuffer const& points = trail.getPoints();
+    float const* buffer = points.getBufferVertices();
+    if (points.isReallocated())
+    {
+        vertices->resize(points.getCapacity());
+        std::memcpy(&(*vertices)[0], buffer, 3 * sizeof(float) * points.getCapacity());
+        vertices->dirty();
+    }
+    else
+    {
+        // every point is stored twice, see TrajectoryPointBuffer
+        TrajectoryPointBuffer::Range dirty = points.getDirtyRange();
+        if (dirty.count)
+        {
+            for (size_t copy = 0; copy < 2; ++copy)
+            {
+                const size_t first = dirty.first + copy * points.getMaxPoints();
+                std::memcpy(&(*vertices)[first], buffer + 3 * first, 3 * sizeof(float) * dirty.count);
+            }
+            vertices->dirty();
+        }
+    }
+    trail.clearDirty();
+
+    if (strip->getFirst() != static_cast<GLint>(points.getFirst())
+            || strip->getCount() != static_cast<GLsizei>(points.size()))
+    {
+        strip->setFirst(points.getFirst());
+        strip->setCount(points.size());
+        strip->dirty();
+    }
+
+    Eigen::AlignedBox3f const& bounds = trail.getBounds();
+    TrailBound* bound = static_cast<TrailBound*>(geometry->getComputeBoundingBoxCallback());
+    if (bounds.isEmpty())
+        bound->box.init();
+    else
+        bound->box.set(bounds.min().x(), bounds.min().y(), bounds.min().z(),
+                bounds.max().x(), bounds.max().y(), bounds.max().z());
+    geometry->dirtyBound();
+
+    base::Vector3d const& origin = trail.getOrigin();
+    setPosition(osg::Vec3d(origin.x(), origin.y(), origin.z()) + offset);
+}
+
+PoseTrailController::PoseTrailController()
+    : enabled(false)
+    , clear_requested(false)
+    , length(10000)
+    , threshold(0, 0)
+    // allocated when the trail gets enabled
+    , trail(1)
+{
+}
+
+void PoseTrailController::setEnabled(bool enable)
+{
+    if (!enable)
+        clear_requested = true;
+    enabled = enable;
+}
+
+void PoseTrailController::setLength(int length)
+{
+    this->length = std::max(length, 1);
+}
+
+PoseTrailNode* PoseTrailController::createNode()
+{
+    node = new PoseTrailNode;
+    node->setNodeMask(0);
+    return node.get();
+}
+
+void PoseTrailController::applySettings()
+{
+    if (clear_requested)
+    {
+        trail.clear();
+        clear_requested = false;
+    }
+    trail.setMaxPoints(length);
+    trail.setThreshold(threshold);
+}
+
+void PoseTrailController::update(Eigen::Affine3d const& pose)
+{
+    if (!enabled)
+        return;
+    applySettings();
+    trail.update(pose);
+}
+
+void PoseTrailController::update(Eigen::Vector3d const& position)
+{
+    if (!enabled)
+        return;
+    applySettings();
+    trail.update(position);
+}
+
+void PoseTrailController::updateNode(osg::Vec4 const& color, osg::Vec3 const& offset)
+{
+    if (!enabled)
+    {
+        node->setNodeMask(0);
+        return;
+    }
+    applySettings();
+    node->setColor(color);
+    node->update(trail, offset);
+    node->setNodeMask(~0);
+}
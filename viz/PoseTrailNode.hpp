@@ -0,0 +1,93 @@
+#ifndef POSE_TRAIL_NODE_HPP
+#define POSE_TRAIL_NODE_HPP
+
+#include <osg/PositionAttitudeTransform>
+#include <osg/Geometry>
+#include "PoseTrail.hpp"
+
+namespace vizkit3d
+{
+
+/**
+ * Displays a PoseTrail as a line strip
+ *
+ * The vertex array mirrors the storage arrays of the trail, and the strip is
+ * drawn from the oldest live position. Updating the node therefore only
+ * copies the positions added since the last update, and never moves the
+ * others. The node is placed at the origin of the trail.
+ */
+class PoseTrailNode : public osg::PositionAttitudeTransform
+{
+public:
+    PoseTrailNode();
+
+    void setColor(osg::Vec4 const& color);
+
+    /** Copies the positions added to the trail since the last call, and
+     * clears the dirty range of the trail
+     *
+     * @param offset added to the origin of the trail, e.g. the translation
+     *   applied to the body
+     */
+    void update(PoseTrail& trail, osg::Vec3 const& offset = osg::Vec3());
+
+private:
+    osg::ref_ptr<osg::Geometry> geometry;
+    osg::ref_ptr<osg::Vec3Array> vertices;
+    osg::ref_ptr<osg::Vec4Array> colors;
+    osg::ref_ptr<osg::DrawArrays> strip;
+};
+
+/**
+ * The trail of a body plugin: the PoseTrail, its PoseTrailNode and the
+ * trail properties of the plugin
+ *
+ * The setters only store the settings. The trail itself is only accessed
+ * from update() and updateNode(), i.e. from the update methods of the
+ * plugin, which apply the settings.
+ */
+class PoseTrailController
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    PoseTrailController();
+
+    /** The trail starts empty each time it is enabled */
+    void setEnabled(bool enable);
+    bool isEnabled() const { return enabled; }
+    /** The length is at least one position */
+    void setLength(int length);
+    int getLength() const { return length; }
+    void setMinDistance(double distance) { threshold.distance = distance; }
+    double getMinDistance() const { return threshold.distance; }
+    void setMinAngle(double angle) { threshold.angle = angle; }
+    double getMinAngle() const { return threshold.angle; }
+    void clear() { clear_requested = true; }
+
+    /** Creates the node, hidden until the trail is enabled. It is meant to
+     * be world-fixed, i.e. not below the transform of the body */
+    PoseTrailNode* createNode();
+
+    /** Adds the position of a pose to the trail, if it is enabled */
+    void update(Eigen::Affine3d const& pose);
+    /** Same as update(pose), for bodies with an unknown orientation */
+    void update(Eigen::Vector3d const& position);
+
+    /** Copies the new positions to the node, or hides it if the trail is
+     * disabled */
+    void updateNode(osg::Vec4 const& color, osg::Vec3 const& offset);
+
+private:
+    void applySettings();
+
+    bool enabled;
+    bool clear_requested;
+    int length;
+    base::PoseUpdateThreshold threshold;
+    PoseTrail trail;
+    osg::ref_ptr<PoseTrailNode> node;
+};
+
+}
+#endif
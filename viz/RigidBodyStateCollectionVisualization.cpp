@@ -0,0 +1,348 @@
+#include "RigidBodyStateCollectionVisualization.hpp"
+#include "InstancedMesh.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <osg/Geode>
+#include <osg/Group>
+
+using namespace vizkit3d;
+
+/** Unit axes, colored per vertex */
+static osg::ref_ptr<osg::Geometry> createFrameMesh()
+{
+    osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+    osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        osg::Vec3 end(0, 0, 0);
+        end[axis] = 1;
+        osg::Vec4 color(0, 0, 0, 1);
+        color[axis] = 1;
+        vertices->push_back(osg::Vec3(0, 0, 0));
+        vertices->push_back(end);
+        colors->push_back(color);
+        colors->push_back(color);
+    }
+
+    osg::ref_ptr<osg::Geometry> mesh = new osg::Geometry;
+    mesh->setVertexArray(vertices);
+    mesh->setColorArray(colors);
+    mesh->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
+    mesh->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::LINES, 0, vertices->size()));
+    return mesh;
+}
+
+RigidBodyStateCollectionVisualization::RigidBodyStateCollectionVisualization()
+    : size(0.3), max_poses(10000), do_clear(false), needs_rebuild(true)
+    , covariance(false), covariance_with_samples(false)
+    , evicted(0), first_pose(0)
+{
+}
+
+RigidBodyStateCollectionVisualization::~RigidBodyStateCollectionVisualization()
+{
+}
+
+void RigidBodyStateCollectionVisualization::clear()
+{
+    // applied on the next update, as the poses are only accessed from the
+    // update methods
+    do_clear = true;
+    setDirty();
+}
+
+double RigidBodyStateCollectionVisualization::getSize() const
+{
+    return size;
+}
+
+void RigidBodyStateCollectionVisualization::setSize(double size)
+{
+    this->size = size;
+    needs_rebuild = true;
+    setDirty();
+    emit propertyChanged("size");
+}
+
+int RigidBodyStateCollectionVisualization::getMaxPoses() const
+{
+    return max_poses;
+}
+
+void RigidBodyStateCollectionVisualization::setMaxPoses(int count)
+{
+    max_poses = std::max(count, 1);
+    needs_rebuild = true;
+    setDirty();
+    emit propertyChanged("MaxPoses");
+}
+
+bool RigidBodyStateCollectionVisualization::isCovarianceDisplayed() const
+{
+    return covariance;
+}
+
+void RigidBodyStateCollectionVisualization::displayCovariance(bool enable)
+{
+    covariance = enable;
+    needs_rebuild = true;
+    setDirty();
+    emit propertyChanged("displayCovariance");
+}
+
+bool RigidBodyStateCollectionVisualization::isCovarianceDisplayedWithSamples() const
+{
+    return covariance_with_samples;
+}
+
+void RigidBodyStateCollectionVisualization::displayCovarianceWithSamples(bool enable)
+{
+    covariance_with_samples = enable;
+    needs_rebuild = true;
+    setDirty();
+    emit propertyChanged("displayCovarianceWithSamples");
+}
+
+/** Geometry drawing the given vertices, with the uncertainty color */
+static osg::ref_ptr<osg::Geometry> createUncertaintyGeometry(osg::Vec3Array* vertices, osg::DrawArrays* primitives)
+{
+    osg::ref_ptr<osg::Vec4Array> color = new osg::Vec4Array;
+    color->push_back(osg::Vec4(0, 1, 1, 1));
+
+    osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+    geometry->setDataVariance(osg::Object::DYNAMIC);
+    geometry->setUseDisplayList(false);
+    geometry->setVertexArray(vertices);
+    geometry->setColorArray(color);
+    geometry->setColorBinding(osg::Geometry::BIND_OVERALL);
+    geometry->addPrimitiveSet(primitives);
+    geometry->getOrCreateStateSet()->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+    return geometry;
+}
+
+/** Copies the vertices of the given range of items, which have @a item_size
+ * floats each */
+static void copyVertices(osg::Vec3Array* array, std::vector<float> const& vertices,
+                         size_t item_size, UncertaintyBatch::Range const& dirty)
+{
+    array->resize(vertices.size() / 3);
+    if(dirty.count && item_size)
+        std::memcpy(&(*array)[dirty.first * item_size / 3], &vertices[dirty.first * item_size],
+                dirty.count * item_size * sizeof(float));
+    array->dirty();
+}
+
+osg::ref_ptr<osg::Node> RigidBodyStateCollectionVisualization::createMainNode()
+{
+    mesh.reset(new InstancedMesh(createFrameMesh(), 1.0));
+    osg::ref_ptr<osg::Group> group = new osg::Group;
+    group->addChild(mesh->getNode());
+
+    // all covariance ellipses share one geometry, and all samples another
+    // one, each mirroring an array of the UncertaintyBatch
+    uncertainty_ellipse_vertices = new osg::Vec3Array;
+    uncertainty_ellipse_vertices->setDataVariance(osg::Object::DYNAMIC);
+    uncertainty_sample_vertices = new osg::Vec3Array;
+    uncertainty_sample_vertices->setDataVariance(osg::Object::DYNAMIC);
+    uncertainty_ellipses = new osg::DrawArrays(osg::PrimitiveSet::LINES, 0, 0);
+    uncertainty_samples = new osg::DrawArrays(osg::PrimitiveSet::POINTS, 0, 0);
+    uncertainty_ellipse_geometry = createUncertaintyGeometry(uncertainty_ellipse_vertices, uncertainty_ellipses);
+    uncertainty_sample_geometry = createUncertaintyGeometry(uncertainty_sample_vertices, uncertainty_samples);
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(uncertainty_ellipse_geometry);
+    geode->addDrawable(uncertainty_sample_geometry);
+    uncertainty_node = new osg::PositionAttitudeTransform;
+    uncertainty_node->addChild(geode);
+    uncertainty_node->setNodeMask(0);
+    group->addChild(uncertainty_node);
+
+    // the new geometries need all the poses
+    needs_rebuild = true;
+    return group;
+}
+
+void RigidBodyStateCollectionVisualization::addPose(base::samples::RigidBodyState const& pose,
+        std::vector<size_t>& free_instances, std::vector<size_t>& free_uncertainties)
+{
+    Slots pose_slots = { -1, -1 };
+    const size_t sequence = first_pose + slots.size();
+    if(pose.hasValidPosition())
+    {
+        const Eigen::Quaterniond orientation = pose.hasValidOrientation() ?
+            Eigen::Quaterniond(pose.orientation) : Eigen::Quaterniond::Identity();
+        const Eigen::Vector4f white(1, 1, 1, 1);
+        if(free_instances.empty())
+        {
+            pose_slots.instance = static_cast<int>(instances.size());
+            instances.push(pose.position, orientation, size, white);
+            instance_owners.push_back(sequence);
+        }
+        else
+        {
+            pose_slots.instance = free_instances.back();
+            free_instances.pop_back();
+            instances.set(pose_slots.instance, pose.position, orientation, size, white);
+            instance_owners[pose_slots.instance] = sequence;
+        }
+
+        if(covariance && pose.hasValidPositionCovariance())
+        {
+            if(free_uncertainties.empty())
+            {
+                pose_slots.uncertainty = static_cast<int>(uncertainties.size());
+                uncertainties.push(pose.position, pose.cov_position);
+                uncertainty_owners.push_back(sequence);
+            }
+            else
+            {
+                pose_slots.uncertainty = free_uncertainties.back();
+                free_uncertainties.pop_back();
+                uncertainties.set(pose_slots.uncertainty, pose.position, pose.cov_position);
+                uncertainty_owners[pose_slots.uncertainty] = sequence;
+            }
+        }
+    }
+    slots.push_back(pose_slots);
+}
+
+template<typename Buffer>
+void RigidBodyStateCollectionVisualization::releaseSlots(std::vector<size_t>& free, Buffer& buffer,
+        std::vector<size_t>& owners, int Slots::*slot)
+{
+    // Buffer::remove moves the last entry in the removed one, so remove the
+    // highest slots first: the last entry is then never a free one
+    std::sort(free.begin(), free.end(), std::greater<size_t>());
+    for(size_t i = 0; i < free.size(); ++i)
+    {
+        const size_t last = owners.size() - 1;
+        buffer.remove(free[i]);
+        if(free[i] != last)
+        {
+            owners[free[i]] = owners[last];
+            slots[owners[last] - first_pose].*slot = static_cast<int>(free[i]);
+        }
+        owners.pop_back();
+    }
+}
+
+void RigidBodyStateCollectionVisualization::rebuild()
+{
+    needs_rebuild = false;
+    evicted = 0;
+    slots.clear();
+    first_pose = 0;
+    instance_owners.clear();
+    uncertainty_owners.clear();
+
+    instances.clear();
+    instances.reserve(poses.size());
+    uncertainties.clear();
+    uncertainties.setSampleCount(covariance_with_samples ? 50 : 0);
+
+    std::vector<size_t> free_instances, free_uncertainties;
+    for(std::deque<base::samples::RigidBodyState>::const_iterator it = poses.begin(); it != poses.end(); ++it)
+        addPose(*it, free_instances, free_uncertainties);
+}
+
+void RigidBodyStateCollectionVisualization::appendPoses()
+{
+    // the slots of the evicted poses are reused by the new ones
+    std::vector<size_t> free_instances, free_uncertainties;
+    const size_t dropped = std::min(evicted, slots.size());
+    for(size_t i = 0; i < dropped; ++i)
+    {
+        if(slots.front().instance >= 0)
+            free_instances.push_back(slots.front().instance);
+        if(slots.front().uncertainty >= 0)
+            free_uncertainties.push_back(slots.front().uncertainty);
+        slots.pop_front();
+        ++first_pose;
+    }
+    evicted = 0;
+
+    // addPose takes the lowest free slots first, which keeps the dirty
+    // ranges contiguous when the poses go round the slots
+    std::sort(free_instances.begin(), free_instances.end(), std::greater<size_t>());
+    std::sort(free_uncertainties.begin(), free_uncertainties.end(), std::greater<size_t>());
+    for(size_t i = slots.size(); i < poses.size(); ++i)
+        addPose(poses[i], free_instances, free_uncertainties);
+
+    releaseSlots(free_instances, instances, instance_owners, &Slots::instance);
+    releaseSlots(free_uncertainties, uncertainties, uncertainty_owners, &Slots::uncertainty);
+}
+
+void RigidBodyStateCollectionVisualization::updateUncertainty()
+{
+    const UncertaintyBatch::Range dirty = uncertainties.getDirtyRange();
+    copyVertices(uncertainty_ellipse_vertices, uncertainties.getEllipseVertices(),
+            3 * uncertainties.getVerticesPerEllipsoid(), dirty);
+    copyVertices(uncertainty_sample_vertices, uncertainties.getSampleVertices(),
+            3 * uncertainties.getSampleCount(), dirty);
+    uncertainties.clearDirty();
+    if(uncertainties.empty())
+    {
+        uncertainty_node->setNodeMask(0);
+        return;
+    }
+
+    uncertainty_ellipses->setCount(uncertainty_ellipse_vertices->size());
+    uncertainty_samples->setCount(uncertainty_sample_vertices->size());
+    uncertainty_ellipses->dirty();
+    uncertainty_samples->dirty();
+
+    base::Vector3d const& origin = uncertainties.getOrigin();
+    uncertainty_node->setPosition(osg::Vec3d(origin.x(), origin.y(), origin.z()));
+    uncertainty_ellipse_geometry->dirtyBound();
+    uncertainty_sample_geometry->dirtyBound();
+    uncertainty_node->setNodeMask(~0);
+}
+
+void RigidBodyStateCollectionVisualization::updateMainNode(osg::Node* node)
+{
+    if(do_clear)
+    {
+        poses.clear();
+        do_clear = false;
+        needs_rebuild = true;
+    }
+    while(poses.size() > static_cast<size_t>(max_poses))
+    {
+        poses.pop_front();
+        ++evicted;
+    }
+
+    if(needs_rebuild)
+        rebuild();
+    else
+        appendPoses();
+
+    mesh->update(instances);
+    instances.clearDirty();
+    updateUncertainty();
+}
+
+void RigidBodyStateCollectionVisualization::updateDataIntern(std::vector<base::samples::RigidBodyState> const& data)
+{
+    do_clear = false;
+    needs_rebuild = true;
+    poses.assign(data.begin(), data.end());
+}
+
+void RigidBodyStateCollectionVisualization::updateDataIntern(base::samples::RigidBodyState const& data)
+{
+    if(do_clear)
+    {
+        poses.clear();
+        do_clear = false;
+        needs_rebuild = true;
+    }
+    poses.push_back(data);
+    while(poses.size() > static_cast<size_t>(max_poses))
+    {
+        poses.pop_front();
+        ++evicted;
+    }
+}
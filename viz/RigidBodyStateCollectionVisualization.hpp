@@ -0,0 +1,138 @@
+#ifndef __RIGID_BODY_STATE_COLLECTION_VISUALIZATION_HPP__
+#define __RIGID_BODY_STATE_COLLECTION_VISUALIZATION_HPP__
+
+#include <vector>
+#include <deque>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <vizkit3d/Vizkit3DPlugin.hpp>
+#include <base/samples/RigidBodyState.hpp>
+#include "InstanceBuffer.hpp"
+#include "UncertaintyBatch.hpp"
+#include <osg/Geometry>
+#include <osg/PositionAttitudeTransform>
+
+namespace vizkit3d
+{
+    class InstancedMesh;
+
+    /**
+     * Displays many poses as coordinate frames (x red, y green, z blue),
+     * e.g. the nodes of a pose graph or the poses of a trajectory
+     *
+     * All frames are drawn by a single instanced geometry, so that the
+     * scene graph does not grow with the number of poses. A vector of poses
+     * replaces the displayed ones, while single poses are appended, keeping
+     * at most MaxPoses of them. Poses without a valid position are skipped,
+     * and poses without a valid orientation are drawn with the identity.
+     *
+     * Optionally, the position covariances of the poses are displayed as
+     * ellipsoids, which are also all drawn by a single geometry (see
+     * UncertaintyBatch).
+     *
+     * Appending a single pose only writes that pose, in the slot of the
+     * pose it evicts if there is one, so that the cost of an update does
+     * not grow with MaxPoses. A vector of poses or a property change
+     * rebuild all of them.
+     */
+    class RigidBodyStateCollectionVisualization
+        : public vizkit3d::Vizkit3DPlugin< std::vector<base::samples::RigidBodyState> >
+        , public vizkit3d::VizPluginAddType<base::samples::RigidBodyState>
+        , boost::noncopyable
+    {
+    Q_OBJECT
+    Q_PROPERTY(double size READ getSize WRITE setSize)
+    Q_PROPERTY(int MaxPoses READ getMaxPoses WRITE setMaxPoses)
+    Q_PROPERTY(bool displayCovariance READ isCovarianceDisplayed WRITE displayCovariance)
+    Q_PROPERTY(bool displayCovarianceWithSamples READ isCovarianceDisplayedWithSamples WRITE displayCovarianceWithSamples)
+
+    public:
+        RigidBodyStateCollectionVisualization();
+        ~RigidBodyStateCollectionVisualization();
+
+        Q_INVOKABLE void updateData(std::vector<base::samples::RigidBodyState> const& sample)
+        { vizkit3d::Vizkit3DPlugin< std::vector<base::samples::RigidBodyState> >::updateData(sample); }
+        Q_INVOKABLE void updatePoses(std::vector<base::samples::RigidBodyState> const& sample)
+        { updateData(sample); }
+        Q_INVOKABLE void updateData(base::samples::RigidBodyState const& sample)
+        { vizkit3d::Vizkit3DPlugin< std::vector<base::samples::RigidBodyState> >::updateData(sample); }
+        Q_INVOKABLE void updateRigidBodyState(base::samples::RigidBodyState const& sample)
+        { updateData(sample); }
+
+        /** Removes all poses */
+        Q_INVOKABLE void clear();
+
+    public slots:
+        /** Length of the axes of the frames, in meters */
+        double getSize() const;
+        void setSize(double size);
+
+        /** Maximum number of poses kept when appending single poses */
+        int getMaxPoses() const;
+        void setMaxPoses(int count);
+
+        /** Displays the position covariance of the poses that have one */
+        bool isCovarianceDisplayed() const;
+        void displayCovariance(bool enable);
+        /** Adds samples of the distribution to the covariance ellipsoids */
+        bool isCovarianceDisplayedWithSamples() const;
+        void displayCovarianceWithSamples(bool enable);
+
+    protected:
+        osg::ref_ptr<osg::Node> createMainNode();
+        void updateMainNode(osg::Node* node);
+        void updateDataIntern(std::vector<base::samples::RigidBodyState> const& data);
+        void updateDataIntern(base::samples::RigidBodyState const& data);
+
+    private:
+        /** Slots of a displayed pose in the instances and uncertainties,
+         * or -1 */
+        struct Slots
+        {
+            int instance;
+            int uncertainty;
+        };
+
+        void rebuild();
+        void appendPoses();
+        void addPose(base::samples::RigidBodyState const& pose,
+                     std::vector<size_t>& free_instances, std::vector<size_t>& free_uncertainties);
+        template<typename Buffer>
+        void releaseSlots(std::vector<size_t>& free, Buffer& buffer,
+                          std::vector<size_t>& owners, int Slots::*slot);
+        void updateUncertainty();
+
+        std::deque<base::samples::RigidBodyState> poses;
+        double size;
+        int max_poses;
+        bool do_clear;
+        bool needs_rebuild;
+        bool covariance;
+        bool covariance_with_samples;
+
+        /** Slots of the displayed poses, which are the first slots.size()
+         * entries of poses */
+        std::deque<Slots> slots;
+        /** Number of displayed poses that were removed from poses since the
+         * last update */
+        size_t evicted;
+        /** Sequence number of slots.front(), and sequence number of the pose
+         * that uses each instance and uncertainty */
+        size_t first_pose;
+        std::vector<size_t> instance_owners;
+        std::vector<size_t> uncertainty_owners;
+
+        InstanceBuffer instances;
+        boost::scoped_ptr<InstancedMesh> mesh;
+
+        UncertaintyBatch uncertainties;
+        osg::ref_ptr<osg::PositionAttitudeTransform> uncertainty_node;
+        osg::ref_ptr<osg::Geometry> uncertainty_ellipse_geometry;
+        osg::ref_ptr<osg::Geometry> uncertainty_sample_geometry;
+        osg::ref_ptr<osg::Vec3Array> uncertainty_ellipse_vertices;
+        osg::ref_ptr<osg::Vec3Array> uncertainty_sample_vertices;
+        osg::ref_ptr<osg::DrawArrays> uncertainty_ellipses;
+        osg::ref_ptr<osg::DrawArrays> uncertainty_samples;
+    };
+}
+#endif
@@ -361,6 +361,40 @@ void RigidBodyStateVisualization::displayCovarianceWithSamples(bool enable)
 bool RigidBodyStateVisualization::isCovarianceDisplayedWithSamples() const
 { return covariance_with_samples; }
 
+void RigidBodyStateVisualization::displayTrail(bool enable)
+{
+    trail.setEnabled(enable);
+    setDirty();
+    emit propertyChanged("displayTrail");
+}
+bool RigidBodyStateVisualization::isTrailDisplayed() const
+{ return trail.isEnabled(); }
+
+void RigidBodyStateVisualization::setTrailLength(int length)
+{
+    trail.setLength(length);
+    setDirty();
+    emit propertyChanged("trailLength");
+}
+int RigidBodyStateVisualization::getTrailLength() const
+{ return trail.getLength(); }
+
+void RigidBodyStateVisualization::setTrailMinDistance(double distance)
+{ trail.setMinDistance(distance); emit propertyChanged("trailMinDistance"); }
+double RigidBodyStateVisualization::getTrailMinDistance() const
+{ return trail.getMinDistance(); }
+
+void RigidBodyStateVisualization::setTrailMinAngle(double angle)
+{ trail.setMinAngle(angle); emit propertyChanged("trailMinAngle"); }
+double RigidBodyStateVisualization::getTrailMinAngle() const
+{ return trail.getMinAngle(); }
+
+void RigidBodyStateVisualization::clearTrail()
+{
+    trail.clear();
+    setDirty();
+}
+
 ref_ptr<Node> RigidBodyStateVisualization::createMainNode()
 {
     Group* group = new Group;
@@ -370,6 +404,8 @@ ref_ptr<Node> RigidBodyStateVisualization::createMainNode()
         resetModel(total_size);
     body_pose->addChild(body_model);
     group->addChild(body_pose);
+    // world-fixed, unlike the body
+    group->addChild(trail.createNode());
 
     texture = new osg::Texture2D;
     texture->setWrap(Texture::WRAP_S, Texture::REPEAT);
@@ -400,12 +436,12 @@ void RigidBodyStateVisualization::updateMainNode(Node* node)
     // uncertainty child accordingly
     bool needs_uncertainty = covariance && state.hasValidPositionCovariance();
     Uncertainty* uncertainty = 0;
-    if (group->getNumChildren() > 1)
+    if (group->getNumChildren() > 2)
     {
         if (needs_uncertainty)
-            uncertainty = dynamic_cast<Uncertainty*>(group->getChild(1));
+            uncertainty = dynamic_cast<Uncertainty*>(group->getChild(2));
         else
-            group->removeChild(1);
+            group->removeChild(2);
     }
     else if (needs_uncertainty)
     {
@@ -423,6 +459,8 @@ void RigidBodyStateVisualization::updateMainNode(Node* node)
     else if (body_node != body_model)
         body_pose->setChild(0, body_model);
 
+    trail.updateNode(osg::Vec4(color.x(), color.y(), color.z(), 1), translation);
+
     if (texture_dirty)
         updateTexture();
     if (bump_mapping_dirty)
@@ -458,6 +496,13 @@ void RigidBodyStateVisualization::updateMainNode(Node* node)
 void RigidBodyStateVisualization::updateDataIntern( const base::samples::RigidBodyState& state )
 {
     this->state = state;
+    if (!state.hasValidPosition())
+        return;
+
+    if (state.hasValidOrientation())
+        trail.update(state.getTransform());
+    else
+        trail.update(static_cast<Eigen::Vector3d>(state.position));
 }
 
 }
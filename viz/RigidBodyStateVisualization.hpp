@@ -7,6 +7,7 @@
 
 #include <osg/Image>
 #include <osg/Texture2D>
+#include "PoseTrailNode.hpp"
 
 namespace osgFX
 {
@@ -24,6 +25,10 @@ class RigidBodyStateVisualization : public Vizkit3DPlugin<base::samples::RigidBo
         Q_PROPERTY(double textSize READ getTextSize WRITE setTextSize)
         Q_PROPERTY(bool displayCovariance READ isCovarianceDisplayed WRITE displayCovariance)
         Q_PROPERTY(bool displayCovarianceWithSamples READ isCovarianceDisplayedWithSamples WRITE displayCovarianceWithSamples)
+        Q_PROPERTY(bool displayTrail READ isTrailDisplayed WRITE displayTrail)
+        Q_PROPERTY(int trailLength READ getTrailLength WRITE setTrailLength)
+        Q_PROPERTY(double trailMinDistance READ getTrailMinDistance WRITE setTrailMinDistance)
+        Q_PROPERTY(double trailMinAngle READ getTrailMinAngle WRITE setTrailMinAngle)
         Q_PROPERTY(bool forcePositionDisplay READ isPositionDisplayForced WRITE setPositionDisplayForceFlag)
         Q_PROPERTY(bool forceOrientationDisplay READ isOrientationDisplayForced WRITE setOrientationDisplayForceFlag)
         Q_PROPERTY(QString modelPath READ getModelPath WRITE loadModel)
@@ -86,6 +91,26 @@ class RigidBodyStateVisualization : public Vizkit3DPlugin<base::samples::RigidBo
         void displayCovarianceWithSamples(bool enable);
         bool isCovarianceDisplayedWithSamples() const;
 
+        /** Displays the last positions of the body as a line, in the color
+         * of the body. The trail starts empty each time it is enabled */
+        void displayTrail(bool enable);
+        bool isTrailDisplayed() const;
+        /** Sets the maximum number of positions of the trail
+         *
+         * The default is 10000
+         */
+        void setTrailLength(int length);
+        int getTrailLength() const;
+        /** Sets the minimal distance, in meters, between two positions of
+         * the trail. The default is zero */
+        void setTrailMinDistance(double distance);
+        double getTrailMinDistance() const;
+        /** Sets the minimal rotation, in radians, between two positions of
+         * the trail. The default is zero */
+        void setTrailMinAngle(double angle);
+        double getTrailMinAngle() const;
+        void clearTrail();
+
         /** Sets the color of the default body model in R, G, B
          *
          * Values must be between 0 and 1
@@ -115,6 +140,8 @@ class RigidBodyStateVisualization : public Vizkit3DPlugin<base::samples::RigidBo
     private:
         bool covariance;
         bool covariance_with_samples;
+
+        PoseTrailController trail;
         base::Vector3d color;
         double total_size;
         double main_size;
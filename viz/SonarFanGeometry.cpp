@@ -0,0 +1,121 @@
+#include "SonarFanGeometry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vizkit3d
+{
+
+SonarFanGeometry::SonarFanGeometry()
+    : bin_count(0)
+    , speed_of_sound(0)
+    , beam_width(0)
+    , range(0)
+    , mesh_updates(0)
+{
+}
+
+bool SonarFanGeometry::isSameGeometry(base::samples::Sonar const& sonar) const
+{
+    if (mesh_updates == 0 || sonar.bin_count != bin_count || sonar.bin_duration != bin_duration
+            || sonar.speed_of_sound != speed_of_sound || sonar.bearings.size() != bearings.size())
+        return false;
+    if (bearings.size() == 1 && sonar.beam_width.getRad() != beam_width)
+        return false;
+    for (size_t i = 0; i < bearings.size(); ++i)
+    {
+        if (sonar.bearings[i].getRad() != bearings[i])
+            return false;
+    }
+    return true;
+}
+
+bool SonarFanGeometry::update(base::samples::Sonar const& sonar)
+{
+    // same checks as Sonar::validate, which is not const
+    if (sonar.bins.size() != static_cast<size_t>(sonar.bin_count) * sonar.beam_count)
+        throw std::logic_error("SonarFanGeometry: the number of elements in 'bins' does not match the bin and beam counts");
+    if (sonar.bearings.size() != sonar.beam_count)
+        throw std::logic_error("SonarFanGeometry: the number of elements in 'bearings' does not match the beam count");
+
+    if (isSameGeometry(sonar))
+        return false;
+
+    const size_t beam_count = sonar.beam_count;
+    bin_count = sonar.bin_count;
+    bin_duration = sonar.bin_duration;
+    speed_of_sound = sonar.speed_of_sound;
+    beam_width = sonar.beam_width.getRad();
+    range = sonar.getBinStartDistance(bin_count);
+    bearings.resize(beam_count);
+    for (size_t i = 0; i < beam_count; ++i)
+        bearings[i] = sonar.bearings[i].getRad();
+
+    // unwrap the bearings, so that fans that cross +/- PI stay continuous
+    std::vector<double> unwrapped(beam_count);
+    for (size_t i = 0; i < beam_count; ++i)
+    {
+        unwrapped[i] = (i == 0) ? bearings[0] :
+            unwrapped[i - 1] + (sonar.bearings[i] - sonar.bearings[i - 1]).getRad();
+    }
+
+    const size_t edge_count = beam_count ? beam_count + 1 : 0;
+    std::vector<double> edges(edge_count);
+    for (size_t edge = 0; edge < edge_count; ++edge)
+    {
+        if (beam_count == 1)
+            edges[edge] = unwrapped[0] + (edge ? 0.5 : -0.5) * beam_width;
+        else if (edge == 0)
+            edges[edge] = unwrapped[0] - (unwrapped[1] - unwrapped[0]) / 2;
+        else if (edge == beam_count)
+            edges[edge] = unwrapped[beam_count - 1] + (unwrapped[beam_count - 1] - unwrapped[beam_count - 2]) / 2;
+        else
+            edges[edge] = (unwrapped[edge - 1] + unwrapped[edge]) / 2;
+    }
+
+    vertices.resize(3 * 3 * beam_count);
+    texcoords.resize(3 * 2 * beam_count);
+    for (size_t beam = 0; beam < beam_count; ++beam)
+    {
+        float* v = &vertices[9 * beam];
+        v[0] = v[1] = v[2] = 0;
+        for (size_t side = 0; side < 2; ++side)
+        {
+            const double angle = edges[beam + side];
+            float* outer = v + 3 * (side + 1);
+            outer[0] = range * std::cos(angle);
+            outer[1] = range * std::sin(angle);
+            outer[2] = 0;
+        }
+
+        // s is the distance, t the center of the beam's row
+        const float t = (beam + 0.5f) / beam_count;
+        float* tex = &texcoords[6 * beam];
+        tex[0] = 0;
+        tex[2] = tex[4] = 1;
+        tex[1] = tex[3] = tex[5] = t;
+    }
+
+    ++mesh_updates;
+    return true;
+}
+
+void scaleSonarBins(std::vector<float> const& bins, float max_intensity, std::vector<float>& result)
+{
+    result.resize(bins.size());
+    if (bins.empty())
+        return;
+    if (!(max_intensity > 0))
+        max_intensity = *std::max_element(bins.begin(), bins.end());
+
+    if (!(max_intensity > 0))
+    {
+        std::fill(result.begin(), result.end(), 0);
+        return;
+    }
+    const float scale = 1 / max_intensity;
+    for (size_t i = 0; i < bins.size(); ++i)
+        result[i] = std::max(0.0f, std::min(bins[i] * scale, 1.0f));
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef SONAR_FAN_GEOMETRY_HPP
+#define SONAR_FAN_GEOMETRY_HPP
+
+#include <vector>
+#include <base/samples/Sonar.hpp>
+
+namespace vizkit3d
+{
+
+/**
+ * Polar mesh of a sonar fan, independent of OSG
+ *
+ * The fan is drawn with the sonar's bins as a texture, whose columns are the
+ * bins and whose rows are the beams, i.e. the memory layout of
+ * Sonar::bins. The polar-to-texture mapping is done by the texture
+ * coordinates of the mesh, so that once the mesh has been built for a given
+ * sonar geometry (bearings, bin count, bin duration and speed of sound),
+ * displaying a new ping only requires uploading its bins.
+ *
+ * The mesh is made of one triangle per beam (GL_TRIANGLES), from the
+ * sonar to the end of the last bin, between the edges of the beam. The edges
+ * are halfway between the bearings of neighbouring beams, and the outer
+ * edges of the fan are extrapolated from the neighbouring beam or, for
+ * single-beam sonars, half a beam width away from the bearing. Bearings are
+ * around the Z axis, with zero along X.
+ *
+ * The vertices are not shared between beams, so that the whole triangle of
+ * a beam samples the center of its texture row (t = (beam + 0.5) /
+ * beam_count). Linear filtering then only interpolates along the bins, and
+ * never blends neighbouring beams.
+ *
+ * The output has the memory layout of osg::Vec3Array (3 floats per vertex)
+ * and osg::Vec2Array (2 floats per texture coordinate).
+ */
+class SonarFanGeometry
+{
+public:
+    SonarFanGeometry();
+
+    /** Rebuilds the mesh if the geometry of the sonar changed
+     *
+     * @return true if the mesh has been rebuilt
+     * @throw std::logic_error if the sizes of bins and bearings do not match
+     *   bin_count and beam_count
+     */
+    bool update(base::samples::Sonar const& sonar);
+
+    std::vector<float> const& getVertices() const { return vertices; }
+    std::vector<float> const& getTexCoords() const { return texcoords; }
+    size_t getVertexCount() const { return vertices.size() / 3; }
+
+    unsigned int getBinCount() const { return bin_count; }
+    unsigned int getBeamCount() const { return bearings.size(); }
+    /** The distance of the end of the last bin, in meters */
+    float getRange() const { return range; }
+
+    /** Number of times the mesh has been built */
+    size_t getMeshUpdates() const { return mesh_updates; }
+
+private:
+    bool isSameGeometry(base::samples::Sonar const& sonar) const;
+
+    /** Geometry of the mesh */
+    std::vector<double> bearings;
+    unsigned int bin_count;
+    base::Time bin_duration;
+    float speed_of_sound;
+    double beam_width;
+
+    float range;
+    size_t mesh_updates;
+    std::vector<float> vertices;
+    std::vector<float> texcoords;
+};
+
+/** Scales sonar bins to the [0, 1] range of a texture
+ *
+ * @param max_intensity the bin value displayed as full intensity. If it is
+ *   not strictly positive, the largest bin of @a bins is used, i.e. each
+ *   ping is normalized on its own
+ * @param result the scaled bins, resized to the size of @a bins. They are
+ *   clamped to [0, 1]
+ */
+void scaleSonarBins(std::vector<float> const& bins, float max_intensity, std::vector<float>& result);
+
+}
+#endif
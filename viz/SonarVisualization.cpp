@@ -0,0 +1,136 @@
+#include "SonarVisualization.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <osg/Geode>
+#include <osg/Texture2D>
+
+using namespace vizkit3d;
+
+SonarVisualization::SonarVisualization()
+    : has_sonar(false)
+    , max_intensity(0)
+    , intensity_changed(false)
+{
+}
+
+SonarVisualization::~SonarVisualization()
+{
+}
+
+double SonarVisualization::getMaxIntensity() const
+{
+    return max_intensity;
+}
+
+void SonarVisualization::setMaxIntensity(double value)
+{
+    // applied on the next update, as the texture is only accessed from the
+    // update methods
+    max_intensity = value;
+    intensity_changed = true;
+    setDirty();
+    emit propertyChanged("MaxIntensity");
+}
+
+osg::ref_ptr<osg::Node> SonarVisualization::createMainNode()
+{
+    image = new osg::Image;
+    image->setDataVariance(osg::Object::DYNAMIC);
+
+    osg::ref_ptr<osg::Texture2D> texture = new osg::Texture2D(image);
+    texture->setDataVariance(osg::Object::DYNAMIC);
+    texture->setResizeNonPowerOfTwoHint(false);
+    // the fan samples the center of the beam rows (see SonarFanGeometry),
+    // so linear filtering only interpolates along the bins. OpenGL has no
+    // per-axis filter mode
+    texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
+    texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
+    texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+    texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+
+    vertices = new osg::Vec3Array;
+    texcoords = new osg::Vec2Array;
+    osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array;
+    colors->push_back(osg::Vec4(1, 1, 1, 1));
+    triangles = new osg::DrawArrays(osg::PrimitiveSet::TRIANGLES, 0, 0);
+
+    geometry = new osg::Geometry;
+    geometry->setDataVariance(osg::Object::DYNAMIC);
+    geometry->setUseDisplayList(false);
+    geometry->setVertexArray(vertices);
+    geometry->setTexCoordArray(0, texcoords);
+    geometry->setColorArray(colors);
+    geometry->setColorBinding(osg::Geometry::BIND_OVERALL);
+    geometry->addPrimitiveSet(triangles);
+
+    osg::StateSet* state = geometry->getOrCreateStateSet();
+    state->setTextureAttributeAndModes(0, texture, osg::StateAttribute::ON);
+    state->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(geometry);
+    geode->setNodeMask(0);
+    return geode;
+}
+
+void SonarVisualization::updateMainNode(osg::Node* node)
+{
+    if(has_sonar)
+    {
+        has_sonar = false;
+        // recycle the previous ping for the next one
+        std::swap(sonar, displayed);
+
+        try
+        {
+            if(fan.update(displayed))
+            {
+                const size_t count = fan.getVertexCount();
+                vertices->resize(count);
+                texcoords->resize(count);
+                if(count)
+                {
+                    std::memcpy(&(*vertices)[0], &fan.getVertices()[0], count * 3 * sizeof(float));
+                    std::memcpy(&(*texcoords)[0], &fan.getTexCoords()[0], count * 2 * sizeof(float));
+                }
+                vertices->dirty();
+                texcoords->dirty();
+                triangles->setCount(count);
+                triangles->dirty();
+                geometry->dirtyBound();
+            }
+        }
+        catch(std::logic_error const& e)
+        {
+            std::cerr << "SonarVisualization: invalid sonar sample: " << e.what() << std::endl;
+            displayed.bins.clear();
+            node->setNodeMask(0);
+            return;
+        }
+    }
+    else if(!intensity_changed)
+        return;
+    intensity_changed = false;
+
+    if(displayed.bins.empty())
+    {
+        node->setNodeMask(0);
+        return;
+    }
+
+    // the texture has the layout of Sonar::bins
+    scaleSonarBins(displayed.bins, max_intensity, intensities);
+    image->setImage(displayed.bin_count, displayed.beam_count, 1,
+            GL_LUMINANCE, GL_LUMINANCE, GL_FLOAT,
+            reinterpret_cast<unsigned char*>(&intensities[0]), osg::Image::NO_DELETE);
+    image->dirty();
+    node->setNodeMask(~0);
+}
+
+void SonarVisualization::updateDataIntern(base::samples::Sonar const& data)
+{
+    sonar = data;
+    has_sonar = true;
+}
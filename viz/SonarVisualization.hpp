@@ -0,0 +1,68 @@
+#ifndef __SONAR_VISUALIZATION_HPP__
+#define __SONAR_VISUALIZATION_HPP__
+
+#include <boost/noncopyable.hpp>
+#include <vizkit3d/Vizkit3DPlugin.hpp>
+#include <base/samples/Sonar.hpp>
+#include <osg/Geometry>
+#include <osg/Image>
+#include "SonarFanGeometry.hpp"
+
+namespace vizkit3d
+{
+    /**
+     * Displays the pings of a sonar (base::samples::Sonar) as a fan in the
+     * XY plane, with the intensity of the bins as gray levels
+     *
+     * The fan mesh only depends on the geometry of the sonar and is rebuilt
+     * only when it changes. For each ping, the bins are scaled to [0, 1]
+     * (see MaxIntensity) and uploaded as a texture with one row per beam.
+     */
+    class SonarVisualization
+        : public vizkit3d::Vizkit3DPlugin<base::samples::Sonar>
+        , boost::noncopyable
+    {
+    Q_OBJECT
+    Q_PROPERTY(double MaxIntensity READ getMaxIntensity WRITE setMaxIntensity)
+
+    public:
+        SonarVisualization();
+        ~SonarVisualization();
+
+        Q_INVOKABLE void updateData(base::samples::Sonar const& sample)
+        { vizkit3d::Vizkit3DPlugin<base::samples::Sonar>::updateData(sample); }
+        Q_INVOKABLE void updateSonar(base::samples::Sonar const& sample)
+        { updateData(sample); }
+
+    public slots:
+        /** Bin value displayed as full intensity. Zero (the default)
+         * normalizes each ping by its largest bin */
+        double getMaxIntensity() const;
+        void setMaxIntensity(double value);
+
+    protected:
+        osg::ref_ptr<osg::Node> createMainNode();
+        void updateMainNode(osg::Node* node);
+        void updateDataIntern(base::samples::Sonar const& data);
+
+    private:
+        /** The last received ping */
+        base::samples::Sonar sonar;
+        bool has_sonar;
+        /** The ping referenced by the texture, which is only changed by
+         * updateMainNode */
+        base::samples::Sonar displayed;
+        SonarFanGeometry fan;
+        double max_intensity;
+        bool intensity_changed;
+        /** The scaled bins of the displayed ping, referenced by the texture */
+        std::vector<float> intensities;
+
+        osg::ref_ptr<osg::Image> image;
+        osg::ref_ptr<osg::Geometry> geometry;
+        osg::ref_ptr<osg::Vec3Array> vertices;
+        osg::ref_ptr<osg::Vec2Array> texcoords;
+        osg::ref_ptr<osg::DrawArrays> triangles;
+    };
+}
+#endif
@@ -0,0 +1,170 @@
+#include "TrajectoryPointBuffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vizkit3d
+{
+
+TrajectoryPointBuffer::TrajectoryPointBuffer(size_t max_points, bool with_colors)
+    : max_points(0)
+    , with_colors(with_colors)
+    , head(0)
+    , count(0)
+    , dirty_begin(0)
+    , dirty_end(0)
+    , reallocated(true)
+{
+    setMaxPoints(max_points);
+}
+
+void TrajectoryPointBuffer::setMaxPoints(size_t max_points)
+{
+    max_points = std::max<size_t>(max_points, 1);
+    if (max_points == this->max_points)
+        return;
+
+    // keep the newest points, in order
+    const size_t kept = std::min(count, max_points);
+    std::vector<float> old_vertices, old_colors;
+    if (kept)
+    {
+        old_vertices.assign(getVertices() + 3 * (count - kept), getVertices() + 3 * count);
+        if (with_colors)
+            old_colors.assign(getColors() + 4 * (count - kept), getColors() + 4 * count);
+    }
+
+    this->max_points = max_points;
+    vertices.assign(6 * max_points, 0);
+    if (with_colors)
+        colors.assign(8 * max_points, 0);
+    reallocated = true;
+    clear();
+    for (size_t i = 0; i < kept; ++i)
+    {
+        const Eigen::Map<const Eigen::Vector3f> point(&old_vertices[3 * i]);
+        if (with_colors)
+            push(point, Eigen::Map<const Eigen::Vector4f>(&old_colors[4 * i]));
+        else
+            push(point);
+    }
+}
+
+void TrajectoryPointBuffer::clear()
+{
+    head = 0;
+    count = 0;
+}
+
+size_t TrajectoryPointBuffer::getFirst() const
+{
+    // the live points end at head - 1, possibly in the second copy
+    return head >= count ? head - count : head + max_points - count;
+}
+
+void TrajectoryPointBuffer::push(Eigen::Vector3f const& point, Eigen::Vector4f const& color)
+{
+    for (size_t copy = 0; copy < 2; ++copy)
+    {
+        const size_t position = head + copy * max_points;
+        std::copy(point.data(), point.data() + 3, &vertices[3 * position]);
+        if (with_colors)
+            std::copy(color.data(), color.data() + 4, &colors[4 * position]);
+    }
+    markDirty(head, 1);
+    head = (head + 1) % max_points;
+    count = std::min(count + 1, max_points);
+}
+
+void TrajectoryPointBuffer::push(float const* points, size_t count, Eigen::Vector4f const& color)
+{
+    // only the last max_points points survive
+    if (count > max_points)
+    {
+        points += 3 * (count - max_points);
+        count = max_points;
+    }
+
+    while (count)
+    {
+        const size_t chunk = std::min(count, max_points - head);
+        for (size_t copy = 0; copy < 2; ++copy)
+        {
+            const size_t first = head + copy * max_points;
+            std::copy(points, points + 3 * chunk, &vertices[3 * first]);
+            if (with_colors)
+                Eigen::Map< Eigen::Matrix<float, 4, Eigen::Dynamic> >(&colors[4 * first], 4, chunk).colwise() = color;
+        }
+        markDirty(head, chunk);
+        points += 3 * chunk;
+        count -= chunk;
+        head = (head + chunk) % max_points;
+        this->count = std::min(this->count + chunk, max_points);
+    }
+}
+
+void TrajectoryPointBuffer::markDirty(size_t first, size_t count)
+{
+    if (dirty_begin == dirty_end)
+    {
+        dirty_begin = first;
+        dirty_end = first + count;
+    }
+    else
+    {
+        dirty_begin = std::min(dirty_begin, first);
+        dirty_end = std::max(dirty_end, first + count);
+    }
+}
+
+TrajectoryPointBuffer::Range TrajectoryPointBuffer::getDirtyRange() const
+{
+    if (reallocated)
+        return Range(0, max_points);
+    return Range(dirty_begin, dirty_end - dirty_begin);
+}
+
+void TrajectoryPointBuffer::clearDirty()
+{
+    dirty_begin = dirty_end = 0;
+    reallocated = false;
+}
+
+void resampleByArcLength(float const* points, size_t count, double step, std::vector<float>& result)
+{
+    if (!(step > 0))
+        throw std::invalid_argument("resampleByArcLength: step must be strictly positive");
+
+    result.clear();
+    if (!count)
+        return;
+
+    typedef Eigen::Map<const Eigen::Vector3f> PointMap;
+    result.insert(result.end(), points, points + 3);
+
+    // distance from the last emitted sample to the start of the current
+    // segment
+    double travelled = 0;
+    for (size_t i = 1; i < count; ++i)
+    {
+        const PointMap start(points + 3 * (i - 1));
+        const PointMap end(points + 3 * i);
+        const double length = (end - start).norm();
+        double position = step - travelled;
+        for (; position < length; position += step)
+        {
+            const Eigen::Vector3f p = start + (end - start) * static_cast<float>(position / length);
+            result.insert(result.end(), p.data(), p.data() + 3);
+        }
+        travelled = length - (position - step);
+    }
+
+    // always end on the last point, replacing a sample that is too close
+    const PointMap last(points + 3 * (count - 1));
+    if (result.size() > 3 && (PointMap(&result[result.size() - 3]) - last).norm() < 0.5 * step)
+        result.resize(result.size() - 3);
+    if (count > 1)
+        result.insert(result.end(), last.data(), last.data() + 3);
+}
+
+}
@@ -0,0 +1,130 @@
+#ifndef TRAJECTORY_POINT_BUFFER_HPP
+#define TRAJECTORY_POINT_BUFFER_HPP
+
+#include <vector>
+#include <Eigen/Core>
+
+namespace vizkit3d
+{
+
+/**
+ * Storage for the last N points of a line strip, independent of OSG
+ *
+ * The points are kept in single precision arrays (3 floats per vertex, 4 per
+ * color), with the memory layout of osg::Vec3Array and osg::Vec4Array. The
+ * colors are optional, for strips drawn with a single color.
+ *
+ * The arrays are a ring buffer in which every point is written twice, at i
+ * and i + N. The live points are therefore always contiguous, and can be
+ * drawn as one strip or copied with a single memcpy, while adding a point
+ * never moves the others.
+ *
+ * The whole storage arrays can also be mirrored in OSG arrays and drawn
+ * from getFirst(). Only the points written since the last clearDirty() then
+ * need to be copied, which is amortized O(1) per point.
+ */
+class TrajectoryPointBuffer
+{
+public:
+    /** Range of points, as indexes in [0, getMaxPoints()) */
+    struct Range
+    {
+        size_t first;
+        size_t count;
+
+        Range() : first(0), count(0) {}
+        Range(size_t first, size_t count) : first(first), count(count) {}
+    };
+
+    /**
+     * @param max_points the number of points that are kept
+     * @param with_colors whether a color is stored per point. Otherwise,
+     *   the colors given to push are ignored
+     */
+    explicit TrajectoryPointBuffer(size_t max_points = 1800, bool with_colors = true);
+
+    /** True if a color is stored per point */
+    bool hasColors() const { return with_colors; }
+
+    /** Changes the number of points that are kept, dropping the oldest ones
+     * if needed */
+    void setMaxPoints(size_t max_points);
+    size_t getMaxPoints() const { return max_points; }
+
+    /** Removes all points */
+    void clear();
+
+    /** Appends a point, dropping the oldest one if the buffer is full */
+    void push(Eigen::Vector3f const& point, Eigen::Vector4f const& color = Eigen::Vector4f::Ones());
+
+    /** Appends @a count points of the same color, 3 floats each */
+    void push(float const* points, size_t count, Eigen::Vector4f const& color = Eigen::Vector4f::Ones());
+
+    /** Number of live points */
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /** Vertices of the live points, oldest first, 3 floats per point */
+    float const* getVertices() const { return count ? &vertices[3 * getFirst()] : 0; }
+
+    /** Colors of the live points, oldest first, 4 floats per point. Null
+     * if the buffer has no colors */
+    float const* getColors() const { return count && with_colors ? &colors[4 * getFirst()] : 0; }
+
+    /** Number of points in the storage arrays, i.e. twice getMaxPoints() */
+    size_t getCapacity() const { return 2 * max_points; }
+
+    /** The storage arrays, for getCapacity() points */
+    float const* getBufferVertices() const { return &vertices[0]; }
+    float const* getBufferColors() const { return with_colors ? &colors[0] : 0; }
+
+    /** Position of the oldest live point in the storage arrays */
+    size_t getFirst() const;
+
+    /** Points written since the last clearDirty()
+     *
+     * Each point i of the range is stored at i and i + getMaxPoints(). When
+     * the writes wrapped around, the range spans the whole buffer.
+     */
+    Range getDirtyRange() const;
+
+    /** True if the storage arrays changed size since the last clearDirty().
+     * They are then entirely dirty */
+    bool isReallocated() const { return reallocated; }
+
+    void clearDirty();
+
+private:
+    void markDirty(size_t first, size_t count);
+
+    size_t max_points;
+    bool with_colors;
+    std::vector<float> vertices;
+    std::vector<float> colors;
+    /** Position of the next point, in [0, max_points) */
+    size_t head;
+    size_t count;
+
+    size_t dirty_begin;
+    size_t dirty_end;
+    bool reallocated;
+};
+
+/**
+ * Resamples a polyline at a constant arc length
+ *
+ * The first and last points are kept, and the intermediate ones are
+ * interpolated linearly along the polyline every @a step. This turns the
+ * uniform parameter sampling of a curve, whose points get denser where the
+ * curve is slower, into a sampling that is uniform in length.
+ *
+ * @param points the polyline, 3 floats per point
+ * @param count the number of points of the polyline
+ * @param result the resampled polyline, 3 floats per point. It is cleared
+ *   first
+ * @throw std::invalid_argument if step is not strictly positive
+ */
+void resampleByArcLength(float const* points, size_t count, double step, std::vector<float>& result);
+
+}
+#endif
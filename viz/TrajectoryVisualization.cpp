@@ -2,12 +2,16 @@
 #include <osg/Geometry>
 #include <osg/Geode>
 #include <osg/LineWidth>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 
 namespace vizkit3d 
 {
 
 TrajectoryVisualization::TrajectoryVisualization()
-    : doClear(false), max_number_of_points(1800), line_width( 1.0 ), color(1., 0., 0., 1.), backwardColor(1., 0., 1., 1.)
+    : doClear(false), max_number_of_points(1800), line_width( 1.0 ), color(1., 0., 0., 1.), backwardColor(1., 0., 1., 1.),
+    points(max_number_of_points)
 {
     VizPluginRubyMethod(TrajectoryVisualization, base::Vector3d, setColor);
 }
@@ -57,42 +61,66 @@ void TrajectoryVisualization::updateMainNode( osg::Node* node )
     osg::StateSet* stategeode = geode->getOrCreateStateSet();
     stategeode->setMode( GL_LIGHTING, osg::StateAttribute::OFF );
     
-    pointsOSG->clear();
-    colorArray->clear();
-    for(std::deque<Point>::iterator it = points.begin(); it != points.end(); it++)
+    // the live points are contiguous in the buffer, and have the memory
+    // layout of the OSG arrays
+    points.setMaxPoints(max_number_of_points);
+    const size_t count = points.size();
+    pointsOSG->resize(count);
+    colorArray->resize(count);
+    if(count)
     {
-        pointsOSG->push_back(it->point);
-        colorArray->push_back(it->color);
+        std::memcpy(&(*pointsOSG)[0], points.getVertices(), 3 * sizeof(float) * count);
+        std::memcpy(&(*colorArray)[0], points.getColors(), 4 * sizeof(float) * count);
     }
+    pointsOSG->dirty();
+    colorArray->dirty();
     
     geom->setVertexArray(pointsOSG);
-    drawArrays->setCount(pointsOSG->size());
+    drawArrays->setCount(count);
     geom->setColorArray(colorArray);
     geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
+    geom->dirtyBound();
 }
 
 void TrajectoryVisualization::addSpline(const base::geometry::Spline3& data,
-                                        const osg::Vec4& color)
+                                        const osg::Vec4& color, size_t cache_index)
 {
-    //needs a copy as getCurveLength is not const
-    base::geometry::Spline3 spline = data; 
-    
     if(!data.getSISLCurve())
 	return;
     
-    //a point every 5 cm
-    double stepSize = (spline.getEndParam() - spline.getStartParam()) / (spline.getCurveLength() / 0.05);
-    for(double param = spline.getStartParam(); param <= spline.getEndParam(); param += stepSize )
+    if(spline_cache.size() <= cache_index)
+        spline_cache.resize(cache_index + 1);
+    SampledSpline& sampled = spline_cache[cache_index];
+    
+    std::vector<double> knots = data.getKnots();
+    std::vector<double> coordinates = data.getCoordinates();
+    if(sampled.order != data.getCurveOrder() || sampled.knots != knots || sampled.coordinates != coordinates)
     {
-        const Eigen::Vector3d splinePoint = spline.getPoint(param);
-        Point p;
-        p.point = osg::Vec3(splinePoint.x(), splinePoint.y(), splinePoint.z());
-        p.color = color;
-        points.push_back(p);
+        // sample twice as dense as needed in the parameter, and resample
+        // every 5 cm along the curve, as the parameter is not uniform in
+        // length
+        const double step = 0.05;
+        const double start = data.getStartParam();
+        const double end = data.getEndParam();
+        const size_t count = std::max<size_t>(2, std::ceil(2 * data.getCurveLength() / step) + 1);
+        std::vector<float> dense(3 * count);
+        for(size_t i = 0; i < count; i++)
+        {
+            const Eigen::Vector3d point = data.getPoint(start + (end - start) * i / (count - 1));
+            Eigen::Map<Eigen::Vector3f> dense_point(&dense[3 * i]);
+            dense_point = point.cast<float>();
+        }
+        resampleByArcLength(&dense[0], count, step, sampled.points);
+        
+        sampled.order = data.getCurveOrder();
+        sampled.knots.swap(knots);
+        sampled.coordinates.swap(coordinates);
     }
-
-    while(points.size() > max_number_of_points)
-        points.pop_front();
+    
+    points.setMaxPoints(max_number_of_points);
+    if(!sampled.points.empty())
+        points.push(&sampled.points[0], sampled.points.size() / 3,
+                    Eigen::Vector4f(color.r(), color.g(), color.b(), color.a()));
 }
 
 void TrajectoryVisualization::updateDataIntern(const base::geometry::Spline3& data)
@@ -100,7 +128,8 @@ void TrajectoryVisualization::updateDataIntern(const base::geometry::Spline3& da
     //delete old trajectory
     points.clear();
 
-    addSpline(data, color);
+    addSpline(data, color, 0);
+    spline_cache.resize(1);
 }
 
 void TrajectoryVisualization::updateDataIntern(const std::vector<base::Trajectory>& data)
@@ -108,10 +137,11 @@ void TrajectoryVisualization::updateDataIntern(const std::vector<base::Trajector
     //delete old trajectory
     points.clear();
 
-    for(std::vector<base::Trajectory>::const_iterator it = data.begin(); it != data.end(); it++)
+    for(size_t i = 0; i < data.size(); i++)
     {
-        addSpline(it->spline, it->speed >= 0? color : backwardColor);
+        addSpline(data[i].spline, data[i].speed >= 0? color : backwardColor, i);
     }
+    spline_cache.resize(data.size());
 }
 
 
@@ -122,12 +152,17 @@ void TrajectoryVisualization::updateDataIntern( const base::Vector3d& data )
         points.clear();
         doClear = false;
     }
-    Point p;
-    p.point = osg::Vec3(data.x(), data.y(), data.z());
-    p.color = color;
-    points.push_back(p);
-    while(points.size() > max_number_of_points)
-        points.pop_front();
+    points.setMaxPoints(max_number_of_points);
+    points.push(data.cast<float>(), Eigen::Vector4f(color.r(), color.g(), color.b(), color.a()));
+}
+
+void TrajectoryVisualization::setMaxNumberOfPoints(int points)
+{
+    // applied on the next update, as the buffer is only accessed from the
+    // update methods
+    max_number_of_points = std::max(points, 1);
+    setDirty();
+    emit propertyChanged("MaxPoints");
 }
 
 void TrajectoryVisualization::setColor(QColor color)
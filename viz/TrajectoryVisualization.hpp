@@ -2,10 +2,11 @@
 #define TRAJECTORYVISUALISATION_H
 #include <Eigen/Geometry>
 #include <osg/Geometry>
-#include <deque>
+#include <vector>
 #include <vizkit3d/Vizkit3DPlugin.hpp>
 #include <base/geometry/Spline.hpp>
 #include <base/Trajectory.hpp>
+#include "TrajectoryPointBuffer.hpp"
 
 namespace vizkit3d 
 {
@@ -43,7 +44,7 @@ class TrajectoryVisualization: public Vizkit3DPlugin<base::Vector3d>
 
     public slots:
         int getMaxNumberOfPoints(){return max_number_of_points;};
-        void setMaxNumberOfPoints(int points){max_number_of_points = points; emit propertyChanged("MaxPoints");};
+        void setMaxNumberOfPoints(int points);
         double getLineWidth();
         void setLineWidth(double line_width);
         void setColor(QColor color);
@@ -52,7 +53,7 @@ class TrajectoryVisualization: public Vizkit3DPlugin<base::Vector3d>
         QColor getBackwardColor() const;
 
     protected:
-        void addSpline(const base::geometry::Spline3& data, const osg::Vec4& color);
+        void addSpline(const base::geometry::Spline3& data, const osg::Vec4& color, size_t cache_index);
         virtual osg::ref_ptr<osg::Node> createMainNode();
         virtual void updateMainNode( osg::Node* node );
         virtual void updateDataIntern( const  base::Vector3d& data );
@@ -67,13 +68,22 @@ class TrajectoryVisualization: public Vizkit3DPlugin<base::Vector3d>
         osg::Vec4 color;
         osg::Vec4 backwardColor;
         
-        struct Point
+        /** Points of a spline, sampled every 5 cm along the curve. The
+         * definition of the spline is kept to detect changes, as the
+         * sampling is expensive */
+        struct SampledSpline
         {
-            osg::Vec3 point;
-            osg::Vec4 color;
+            int order;
+            std::vector<double> knots;
+            std::vector<double> coordinates;
+            std::vector<float> points;
+
+            SampledSpline() : order(0) {}
         };
-        
-        std::deque<Point> points;
+        /** One entry per spline of the last trajectory */
+        std::vector<SampledSpline> spline_cache;
+
+        TrajectoryPointBuffer points;
         osg::ref_ptr<osg::Vec4Array> colorArray; 
         osg::ref_ptr<osg::Vec3Array> pointsOSG;
         osg::ref_ptr<osg::DrawArrays> drawArrays;
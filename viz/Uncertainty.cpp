@@ -1,4 +1,5 @@
 #include "Uncertainty.hpp"
+#include "UncertaintyBatch.hpp"
 
 #include <osg/Group>
 #include <osg/Geode>
@@ -20,8 +21,8 @@ template <class Scalar>
 osg::Quat eigen2osg( const typename Eigen::Quaternion<Scalar> &q ) { return osg::Quat( q.x(), q.y(), q.z(), q.w() ); }
 
 Uncertainty::Uncertainty()
-    : rand_gen(42u), rand_norm(rand_gen, boost::normal_distribution<>(0,1.0) ),
-    m_showSamples( false ), num_samples( 500 ), dim(0)
+    : m_showSamples( false ), num_samples( 500 ), dim(0),
+    samples_count(0), samples_dim(0), last_cov_dim(0)
 {
     geode = new osg::Geode();
     osg::StateSet* stategeode = geode->getOrCreateStateSet();
@@ -46,8 +47,36 @@ void Uncertainty::setMean( const Eigen::Vector3d& mean )
     redraw(3);
 }
 
+void Uncertainty::showSamples()
+{
+    m_showSamples = true;
+    updateSamples();
+}
+
+void Uncertainty::hideSamples()
+{
+    m_showSamples = false;
+    updateSamples();
+}
+
+void Uncertainty::setNumSamples(size_t samples)
+{
+    num_samples = samples;
+    updateSamples();
+}
+
 void Uncertainty::setCovariance( const Eigen::Matrix2d& cov )
 {
+    // the covariance of a pose rarely changes between two updates, in
+    // which case the transform is still valid
+    if( last_cov_dim == 2 && last_cov.topLeftCorner<2,2>() == cov )
+    {
+	redraw(2);
+	return;
+    }
+    last_cov.topLeftCorner<2,2>() = cov;
+    last_cov_dim = 2;
+
     // get the rotation and scaling of the ellipsoid from the covariance matrix
     Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> ev( cov );
     Eigen::Rotation2D<double> rm(0);
@@ -66,38 +95,21 @@ void Uncertainty::setCovariance( const Eigen::Matrix2d& cov )
 
 void Uncertainty::setCovariance( const Eigen::Matrix3d& cov )
 {
-    // get the rotation and scaling of the ellipsoid from the covariance matrix
-    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> ev( cov );
-    Eigen::Matrix3d e_vec = ev.eigenvectors();
-    Eigen::Vector3d e_val = ev.eigenvalues();
-
-    // the eigenvectors might not be right handed
-    if( !e_vec.col(0).cross(e_vec.col(1)).isApprox( e_vec.col(2) ) )
+    if( last_cov_dim == 3 && last_cov == cov )
     {
-	e_vec.col(1).swap( e_vec.col(2) );
-	e_val.row(1).swap( e_val.row(2) );
+	redraw(3);
+	return;
     }
+    last_cov = cov;
+    last_cov_dim = 3;
 
-    Eigen::Quaterniond q( e_vec );
-    setAttitude( eigen2osg( q ) );
-    
-    /*
-    std::cout << ev.eigenvectors() << std::endl;
-    std::cout << q.toRotationMatrix() << std::endl;
-    std::cout << "scale: " << ev.eigenvalues().cwise().sqrt().transpose() << std::endl;
-    std::cout << "q scale: " << (q * ev.eigenvalues().cwise().sqrt()).transpose() << std::endl;
-    */
-
-    Eigen::Vector3d scale( Eigen::Vector3d( e_val.array().sqrt() ) );
-    for( size_t i=0; i<3; ++i )
-    {
-	if( scale[i] != scale[i] ) 
-	{
-	    scale[i] = 0;
-	}
-    }
+    // get the rotation and scaling of the ellipsoid from the covariance matrix
+    Eigen::Matrix3d axes;
+    Eigen::Vector3d scale;
+    decomposeCovariance( cov, axes, scale );
 
-    setScale( eigen2osg(scale) );
+    setAttitude( eigen2osg( Eigen::Quaterniond( axes ) ) );
+    setScale( eigen2osg( scale ) );
 
     redraw(3);
 }
@@ -118,11 +130,9 @@ void Uncertainty::redraw( int dim )
 	    addEllipse( 2 );
 	}
 
-	if( m_showSamples )
-	    addSamples();
-
 	this->dim = dim;
     }
+    updateSamples();
 }
 
 void Uncertainty::addEllipse( int axis )
@@ -157,29 +167,40 @@ void Uncertainty::addEllipse( int axis )
     geode->addDrawable(geom.get());    
 }
 
-void Uncertainty::addSamples()
+void Uncertainty::updateSamples()
 {
-    const size_t max_samples = num_samples;
-    // create a new geometry object with the distribution give in the covariance
-    osg::ref_ptr<osg::Geometry> geom = new osg::Geometry;
-    osg::ref_ptr<osg::Vec4Array> color = new osg::Vec4Array;
-    color->push_back(osg::Vec4(1,1,1,1));
-    geom->setColorArray(color.get());
-    geom->setColorBinding( osg::Geometry::BIND_OVERALL );
-
-    osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
-    for(size_t i=0; i<max_samples; i++) 
+    if( samples && geode->containsDrawable( samples.get() ) )
     {
-	Eigen::Vector3d n;
-	for(int i=0;i<3;i++)
-	    n[i] = rand_norm();
-
-	vertices->push_back( eigen2osg(n) );
+	if( m_showSamples && samples_count == num_samples && samples_dim == dim )
+	    return;
+	geode->removeDrawable( samples.get() );
     }
-    geom->setVertexArray(vertices);
+    if( !m_showSamples || dim == 0 )
+	return;
 
-    osg::ref_ptr<osg::DrawArrays> drawArrays = new osg::DrawArrays( osg::PrimitiveSet::POINTS, 0, vertices->size() );
-    geom->addPrimitiveSet(drawArrays.get());
+    if( !samples || samples_count != num_samples || samples_dim != dim )
+    {
+	// samples of the standard normal distribution, the covariance is
+	// applied by the transform
+	samples = new osg::Geometry;
+	osg::ref_ptr<osg::Vec4Array> color = new osg::Vec4Array;
+	color->push_back(osg::Vec4(1,1,1,1));
+	samples->setColorArray(color.get());
+	samples->setColorBinding( osg::Geometry::BIND_OVERALL );
+
+	osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array( num_samples );
+	if( num_samples )
+	{
+	    Eigen::Map<Eigen::Matrix3Xf> points( &(*vertices)[0][0], 3, num_samples );
+	    points = standardNormalSamples( num_samples );
+	    if( dim == 2 )
+		points.row(2).setZero();
+	}
+	samples->setVertexArray(vertices);
+	samples->addPrimitiveSet( new osg::DrawArrays( osg::PrimitiveSet::POINTS, 0, vertices->size() ) );
 
-    geode->addDrawable(geom.get());    
+	samples_count = num_samples;
+	samples_dim = dim;
+    }
+    geode->addDrawable( samples.get() );
 }
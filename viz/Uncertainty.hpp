@@ -1,17 +1,23 @@
 #ifndef __ENVIRE_VIZ_UNCERTAINTY__
 #define __ENVIRE_VIZ_UNCERTAINTY__
 
-#include <boost/random/linear_congruential.hpp>
-#include <boost/random/uniform_real.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <boost/random/normal_distribution.hpp>
-
 #include <osg/PositionAttitudeTransform>
+#include <osg/Geometry>
 #include <Eigen/Core>
 
 namespace vizkit3d
 {
 
+/**
+ * Displays a 2D or 3D normal distribution as its principal ellipses at one
+ * standard deviation, and optionally with samples
+ *
+ * The ellipses and the samples are drawn for the standard normal
+ * distribution, and the covariance is applied by the transform. The
+ * geometries are therefore only created once, and updating the mean or the
+ * covariance only changes the transform. Use UncertaintyBatch to draw many
+ * distributions in a single geometry.
+ */
 class Uncertainty : public osg::PositionAttitudeTransform
 {
 public:
@@ -22,25 +28,30 @@ public:
     void setCovariance( const Eigen::Matrix2d& cov );
     void setCovariance( const Eigen::Matrix3d& cov );
 
-    void showSamples() { m_showSamples = true; }
-    void hideSamples() { m_showSamples = false; }
+    void showSamples();
+    void hideSamples();
 
-    void setNumSamples(size_t samples) { num_samples = samples; }
+    void setNumSamples(size_t samples);
 
 private:
     void redraw( int dim );
     void addEllipse( int axis );
-    void addSamples();
-
-    /** random number generator */
-    boost::minstd_rand rand_gen;
-    boost::variate_generator<boost::minstd_rand&, boost::normal_distribution<> > rand_norm;
+    void updateSamples();
 
     bool m_showSamples;
     osg::ref_ptr<osg::Geode> geode;
 
     size_t num_samples;
     int dim;
+
+    /** the samples geometry, and the count and dimension it was created for */
+    osg::ref_ptr<osg::Geometry> samples;
+    size_t samples_count;
+    int samples_dim;
+
+    /** the last covariance, whose decomposition is the current transform */
+    Eigen::Matrix3d last_cov;
+    int last_cov_dim;
 };
 
 }
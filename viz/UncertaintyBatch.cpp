@@ -0,0 +1,189 @@
+#include "UncertaintyBatch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <Eigen/Cholesky>
+#include <Eigen/Eigenvalues>
+#include <Eigen/Geometry>
+#include <boost/random/linear_congruential.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+
+namespace vizkit3d
+{
+
+void decomposeCovariance(Eigen::Matrix3d const& cov, Eigen::Matrix3d& axes, Eigen::Vector3d& scale)
+{
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> ev(cov);
+    axes = ev.eigenvectors();
+    Eigen::Vector3d values = ev.eigenvalues();
+
+    // the eigenvectors might not be right handed
+    if (!axes.col(0).cross(axes.col(1)).isApprox(axes.col(2)))
+    {
+        axes.col(1).swap(axes.col(2));
+        std::swap(values[1], values[2]);
+    }
+
+    for (int i = 0; i < 3; ++i)
+        scale[i] = values[i] > 0 ? std::sqrt(values[i]) : 0;
+}
+
+Eigen::Matrix3d covarianceFactor(Eigen::Matrix3d const& cov)
+{
+    Eigen::LLT<Eigen::Matrix3d> llt(cov);
+    if (llt.info() == Eigen::Success)
+        return llt.matrixL();
+
+    Eigen::Matrix3d axes;
+    Eigen::Vector3d scale;
+    decomposeCovariance(cov, axes, scale);
+    return axes * scale.asDiagonal();
+}
+
+Eigen::Matrix3Xf standardNormalSamples(size_t count, unsigned int seed)
+{
+    boost::minstd_rand rand_gen(seed);
+    boost::variate_generator<boost::minstd_rand&, boost::normal_distribution<> >
+        rand_norm(rand_gen, boost::normal_distribution<>(0, 1.0));
+
+    Eigen::Matrix3Xf samples(3, count);
+    float* data = samples.data();
+    for (size_t i = 0; i < 3 * count; ++i)
+        data[i] = rand_norm();
+    return samples;
+}
+
+UncertaintyBatch::UncertaintyBatch(int segments)
+    : count(0)
+    , origin(base::Vector3d::Zero())
+    , dirty_begin(0)
+    , dirty_end(0)
+{
+    if (segments < 3)
+        throw std::invalid_argument("UncertaintyBatch: ellipses need at least 3 segments");
+
+    circles.resize(3, 3 * 2 * segments);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        // the two other axes, in the same order as Uncertainty::addEllipse
+        const int u = (axis == 0) ? 1 : 0;
+        const int v = (axis == 2) ? 1 : 2;
+        for (int i = 0; i < segments; ++i)
+        {
+            for (int end = 0; end < 2; ++end)
+            {
+                const double theta = static_cast<double>(i + end) / segments * 2.0 * M_PI;
+                Eigen::Vector3f p(Eigen::Vector3f::Zero());
+                p[u] = std::cos(theta);
+                p[v] = std::sin(theta);
+                circles.col(2 * (axis * segments + i) + end) = p;
+            }
+        }
+    }
+}
+
+void UncertaintyBatch::setSampleCount(size_t count)
+{
+    if (count == static_cast<size_t>(samples.cols()))
+        return;
+    if (!empty())
+        throw std::logic_error("UncertaintyBatch: the sample count can only change when the batch is empty");
+    samples = standardNormalSamples(count);
+}
+
+void UncertaintyBatch::clear()
+{
+    count = 0;
+    origin.setZero();
+    ellipse_vertices.clear();
+    sample_vertices.clear();
+    clearDirty();
+}
+
+void UncertaintyBatch::reserve(size_t count)
+{
+    ellipse_vertices.reserve(3 * circles.cols() * count);
+    sample_vertices.reserve(3 * samples.cols() * count);
+}
+
+void UncertaintyBatch::push(Eigen::Vector3d const& mean, Eigen::Matrix3d const& cov)
+{
+    if (empty())
+        origin = mean;
+
+    ellipse_vertices.resize(ellipse_vertices.size() + 3 * circles.cols());
+    sample_vertices.resize(sample_vertices.size() + 3 * samples.cols());
+    write(count++, mean, cov);
+}
+
+void UncertaintyBatch::set(size_t index, Eigen::Vector3d const& mean, Eigen::Matrix3d const& cov)
+{
+    write(index, mean, cov);
+}
+
+void UncertaintyBatch::remove(size_t index)
+{
+    const size_t last = count - 1;
+    const size_t ellipse_size = 3 * circles.cols();
+    const size_t sample_size = 3 * samples.cols();
+    if (index != last)
+    {
+        std::copy(ellipse_vertices.begin() + last * ellipse_size, ellipse_vertices.end(),
+                ellipse_vertices.begin() + index * ellipse_size);
+        std::copy(sample_vertices.begin() + last * sample_size, sample_vertices.end(),
+                sample_vertices.begin() + index * sample_size);
+        markDirty(index);
+    }
+    ellipse_vertices.resize(last * ellipse_size);
+    sample_vertices.resize(last * sample_size);
+    count = last;
+    dirty_end = std::min(dirty_end, last);
+    dirty_begin = std::min(dirty_begin, dirty_end);
+}
+
+void UncertaintyBatch::write(size_t index, Eigen::Vector3d const& mean, Eigen::Matrix3d const& cov)
+{
+    const Eigen::Vector3f relative = (mean - origin).cast<float>();
+
+    Eigen::Matrix3d axes;
+    Eigen::Vector3d scale;
+    decomposeCovariance(cov, axes, scale);
+    const Eigen::Matrix3f ellipsoid = (axes * scale.asDiagonal()).cast<float>();
+
+    Eigen::Map<Eigen::Matrix3Xf> ellipses(&ellipse_vertices[3 * circles.cols() * index], 3, circles.cols());
+    ellipses.noalias() = ellipsoid * circles;
+    ellipses.colwise() += relative;
+
+    if (samples.cols() > 0)
+    {
+        const Eigen::Matrix3f factor = covarianceFactor(cov).cast<float>();
+        Eigen::Map<Eigen::Matrix3Xf> points(&sample_vertices[3 * samples.cols() * index], 3, samples.cols());
+        points.noalias() = factor * samples;
+        points.colwise() += relative;
+    }
+    markDirty(index);
+}
+
+void UncertaintyBatch::markDirty(size_t index)
+{
+    if (dirty_begin == dirty_end)
+    {
+        dirty_begin = index;
+        dirty_end = index + 1;
+    }
+    else
+    {
+        dirty_begin = std::min(dirty_begin, index);
+        dirty_end = std::max(dirty_end, index + 1);
+    }
+}
+
+void UncertaintyBatch::clearDirty()
+{
+    dirty_begin = 0;
+    dirty_end = 0;
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef UNCERTAINTY_BATCH_HPP
+#define UNCERTAINTY_BATCH_HPP
+
+#include <vector>
+#include <Eigen/Core>
+#include <base/Eigen.hpp>
+
+namespace vizkit3d
+{
+
+/** Principal axes of a 3D covariance
+ *
+ * @param axes rotation whose columns are the (right handed) eigenvectors
+ * @param scale standard deviation along each axis, i.e. the square root of
+ *   the eigenvalues. Negative eigenvalues, which are numerical noise of
+ *   semi-definite matrices, give a zero scale
+ */
+void decomposeCovariance(Eigen::Matrix3d const& cov, Eigen::Matrix3d& axes, Eigen::Vector3d& scale);
+
+/** A matrix L with L * L^T = cov, which maps standard normal samples to
+ * samples of the covariance
+ *
+ * This is the Cholesky factor for positive definite matrices, and falls
+ * back to the principal axes scaled by the standard deviations for
+ * semi-definite ones
+ */
+Eigen::Matrix3d covarianceFactor(Eigen::Matrix3d const& cov);
+
+/** Draws samples of the standard normal distribution, one per column
+ *
+ * The generator is seeded with @a seed, so that the same count and seed
+ * always give the same samples
+ */
+Eigen::Matrix3Xf standardNormalSamples(size_t count, unsigned int seed = 42);
+
+/**
+ * Geometry of many uncertainty ellipsoids, independent of OSG
+ *
+ * Each ellipsoid is drawn as its three principal ellipses at one standard
+ * deviation, and optionally with samples of the distribution. All
+ * ellipsoids are written in the same vertex arrays (3 floats per vertex, as
+ * osg::Vec3Array), so that thousands of them can be drawn by a single
+ * geometry:
+ *
+ * - the ellipses as line segments (GL_LINES), getVerticesPerEllipsoid()
+ *   vertices per ellipsoid
+ * - the samples as points, getSampleCount() per ellipsoid
+ *
+ * The unit circles and the standard normal samples are computed once, and
+ * transformed per ellipsoid by a single matrix product. The same samples
+ * are used for all ellipsoids.
+ *
+ * As in InstanceBuffer, the vertices are relative to an origin, which is
+ * the mean of the first ellipsoid added after clear(), ellipsoids can be
+ * overwritten or removed, and the ones changed since the last clearDirty()
+ * are given by getDirtyRange().
+ */
+class UncertaintyBatch
+{
+public:
+    /** Range of ellipsoids */
+    struct Range
+    {
+        size_t first;
+        size_t count;
+
+        Range() : first(0), count(0) {}
+        Range(size_t first, size_t count) : first(first), count(count) {}
+    };
+
+    /** @param segments number of line segments per ellipse */
+    explicit UncertaintyBatch(int segments = 32);
+
+    /** Number of samples drawn per ellipsoid, zero to disable the samples.
+     * The samples are generated again only if the count changes, which is
+     * only allowed on an empty batch
+     *
+     * @throw std::logic_error if the count changes while the batch is not
+     *   empty
+     */
+    void setSampleCount(size_t count);
+    size_t getSampleCount() const { return samples.cols(); }
+
+    /** Removes all ellipsoids, and resets the origin */
+    void clear();
+    void reserve(size_t count);
+
+    /** Adds the ellipsoid of a covariance around a mean */
+    void push(Eigen::Vector3d const& mean, Eigen::Matrix3d const& cov);
+
+    /** Overwrites an ellipsoid */
+    void set(size_t index, Eigen::Vector3d const& mean, Eigen::Matrix3d const& cov);
+
+    /** Removes an ellipsoid by moving the last one in its place */
+    void remove(size_t index);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    base::Vector3d const& getOrigin() const { return origin; }
+    size_t getVerticesPerEllipsoid() const { return circles.cols(); }
+    std::vector<float> const& getEllipseVertices() const { return ellipse_vertices; }
+    std::vector<float> const& getSampleVertices() const { return sample_vertices; }
+
+    /** Ellipsoids written or moved since the last clearDirty() */
+    Range getDirtyRange() const { return Range(dirty_begin, dirty_end - dirty_begin); }
+    void clearDirty();
+
+private:
+    void write(size_t index, Eigen::Vector3d const& mean, Eigen::Matrix3d const& cov);
+    void markDirty(size_t index);
+
+    /** Line segments of the unit circles in the YZ, XZ and XY planes */
+    Eigen::Matrix3Xf circles;
+    Eigen::Matrix3Xf samples;
+
+    size_t count;
+    base::Vector3d origin;
+    std::vector<float> ellipse_vertices;
+    std::vector<float> sample_vertices;
+
+    size_t dirty_begin;
+    size_t dirty_end;
+};
+
+}
+#endif
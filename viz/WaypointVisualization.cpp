@@ -4,8 +4,10 @@
 #include <osg/Geometry>
 #include <osg/Group>
 #include <osg/ShapeDrawable>
+#include <boost/scoped_ptr.hpp>
 
 #include <vizkit3d/Vizkit3DHelper.hpp>
+#include "InstancedMesh.hpp"
 
 using namespace vizkit3d;
 
@@ -13,11 +15,65 @@ struct WaypointVisualization::Data {
     // Copy of the value given to updateDataIntern.
     // Making a copy is required because of how OSG works
     std::vector<base::Waypoint> data;
+
+    InstanceBuffer instances;
+    boost::scoped_ptr<InstancedMesh> instanced_mesh;
 };
 
+/** Sphere and heading triangle of a waypoint, in the frame of the waypoint
+ * rotated by -M_PI/2 */
+static osg::ref_ptr<osg::Geometry> createWaypointMesh()
+{
+    const double radius = 0.1;
+    const int rings = 6;
+    const int segments = 10;
+
+    osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+    osg::ref_ptr<osg::DrawElementsUInt> faces =
+            new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, 0);
+    for(int r = 0; r <= rings; ++r) {
+        const double polar = M_PI * r / rings;
+        for(int s = 0; s < segments; ++s) {
+            const double azimuth = 2 * M_PI * s / segments;
+            vertices->push_back(osg::Vec3(radius * sin(polar) * cos(azimuth),
+                    radius * sin(polar) * sin(azimuth), radius * cos(polar)));
+        }
+    }
+    for(int r = 0; r < rings; ++r) {
+        for(int s = 0; s < segments; ++s) {
+            const unsigned int a = r * segments + s;
+            const unsigned int b = r * segments + (s + 1) % segments;
+            faces->push_back(a);
+            faces->push_back(a + segments);
+            faces->push_back(b);
+            faces->push_back(b);
+            faces->push_back(a + segments);
+            faces->push_back(b + segments);
+        }
+    }
+
+    const unsigned int triangle = vertices->size();
+    vertices->push_back(osg::Vec3(0.2,0,0));
+    vertices->push_back(osg::Vec3(0,0.6,0));
+    vertices->push_back(osg::Vec3(-0.2,0,0));
+    faces->push_back(triangle);
+    faces->push_back(triangle + 1);
+    faces->push_back(triangle + 2);
+
+    // the color is given per instance
+    osg::ref_ptr<osg::Geometry> mesh = new osg::Geometry;
+    mesh->setVertexArray(vertices);
+    mesh->addPrimitiveSet(faces);
+    osg::ref_ptr<osg::Vec4Array> colors = new osg::Vec4Array;
+    colors->push_back(osg::Vec4(1, 1, 1, 1));
+    mesh->setColorArray(colors);
+    mesh->setColorBinding(osg::Geometry::BIND_OVERALL);
+    return mesh;
+}
+
 
 WaypointVisualization::WaypointVisualization()
-    : p(new Data), color(1.0f, 0.0f, 0.0f, 1.0f)
+    : p(new Data), color(1.0f, 0.0f, 0.0f, 1.0f), instanced(true)
 {
 }
 
@@ -41,11 +97,26 @@ QColor WaypointVisualization::getColor() const
     return q_color;
 } 
 
+void WaypointVisualization::setInstanced(bool enabled)
+{
+    instanced = enabled;
+    setDirty();
+    emit propertyChanged("Instanced");
+}
+
+bool WaypointVisualization::isInstanced() const
+{
+    return instanced;
+}
+
 osg::ref_ptr<osg::Node> WaypointVisualization::createMainNode()
 {
     osg::ref_ptr<osg::Group> waypoints = new osg::Group();
     
-    addWaypoints(waypoints);
+    if(instanced)
+        addInstancedWaypoints(waypoints);
+    else
+        addWaypoints(waypoints);
 
     return waypoints;
 }
@@ -53,7 +124,30 @@ osg::ref_ptr<osg::Node> WaypointVisualization::createMainNode()
 void WaypointVisualization::updateMainNode ( osg::Node* node )
 {
     node->asGroup()->removeChildren(0, node->asGroup()->getNumChildren());
-    addWaypoints(node->asGroup());
+    if(instanced)
+        addInstancedWaypoints(node->asGroup());
+    else
+        addWaypoints(node->asGroup());
+}
+
+void WaypointVisualization::addInstancedWaypoints(osg::Group* group) {
+    if(!p->instanced_mesh)
+        p->instanced_mesh.reset(new InstancedMesh(createWaypointMesh(), 0.6));
+
+    const Eigen::Vector4f instance_color(color.r(), color.g(), color.b(), color.a());
+    p->instances.clear();
+    p->instances.reserve(p->data.size());
+    for(std::vector<base::Waypoint>::const_iterator it = p->data.begin(); it != p->data.end(); ++it) {
+        // same placement as in addWaypoints
+        Eigen::Vector3d position = it->position;
+        position.z() += 0.01;
+        p->instances.push(position,
+                Eigen::Quaterniond(Eigen::AngleAxisd(it->heading - M_PI/2.0, Eigen::Vector3d::UnitZ())),
+                1.0, instance_color);
+    }
+    p->instanced_mesh->update(p->instances);
+    p->instances.clearDirty();
+    group->addChild(p->instanced_mesh->getNode());
 }
 
 void WaypointVisualization::updateDataIntern(std::vector<base::Waypoint> const& data)
@@ -18,6 +18,7 @@ namespace vizkit3d
     {
     Q_OBJECT
     Q_PROPERTY(QColor Color READ getColor WRITE setColor)
+    Q_PROPERTY(bool Instanced READ isInstanced WRITE setInstanced)
     
     public:
         WaypointVisualization();
@@ -48,11 +49,21 @@ namespace vizkit3d
          * Returns the current color of the waypoints.
          */
         QColor getColor() const;
+
+        /**
+         * If true (the default), all waypoints are drawn by a single
+         * instanced geometry, which requires GLSL 1.20 and instanced
+         * arrays. Otherwise each waypoint gets its own transform and geode.
+         */
+        void setInstanced(bool enabled);
+        bool isInstanced() const;
         
     protected:
         /**
          * OSG tree: Group <- Transformation <- Geode <- Sphere 
          *                                            <- Triangle
+         *
+         * or, when instanced: Group <- InstancedMesh
          */
         osg::ref_ptr<osg::Node> createMainNode();
         
@@ -76,12 +87,18 @@ namespace vizkit3d
         struct Data;
         Data* p;
         osg::Vec4 color;
+        bool instanced;
         
         /**
          * Inserts all waypoints into the tree using the tree structure shown 
          * in \a createMainNode() and the currently set color.
          */
         void addWaypoints(osg::Group* group);
+
+        /**
+         * Updates the instanced geometry, and adds it to the group
+         */
+        void addInstancedWaypoints(osg::Group* group);
     };
 }
 #endif
@@ -0,0 +1,66 @@
+#include <base/TimeMark.hpp>
+#include <base/samples/DepthMap.hpp>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "../DepthMapGeometry.hpp"
+
+int main()
+{
+    {
+	// node construction of the depth map visualization, without OSG
+	base::samples::DepthMap depth_map;
+	depth_map.vertical_interval.push_back(-0.4);
+	depth_map.vertical_interval.push_back(0.4);
+	depth_map.horizontal_interval.push_back(M_PI);
+	depth_map.horizontal_interval.push_back(-M_PI);
+	depth_map.vertical_size = 128;
+	depth_map.horizontal_size = 2048;
+	depth_map.distances.resize(128 * 2048);
+	for( size_t i=0; i<depth_map.distances.size(); i++ )
+	    depth_map.distances[i] = (i % 97) ? 5.0 + (i % 13) * 0.1 : base::unknown<float>();
+
+	const int repeat = 100;
+	{
+	    // conversion and slope pass of the full resolution depth map, as
+	    // previously done by the visualization
+	    base::TimeMark t("DepthMap 128x2048 convertDepthMapToPointCloud with slopes");
+	    std::vector<Eigen::Vector3d> points;
+	    std::vector<Eigen::Vector3f> slope_vertices;
+	    std::vector<float> slope_angles;
+	    for( int r=0; r<repeat; r++ )
+	    {
+		depth_map.convertDepthMapToPointCloud(points, true, false);
+		slope_vertices.clear();
+		slope_angles.clear();
+		base::samples::DepthMap::DepthMatrixMapConst distances = depth_map.getDistanceMatrixMapConst();
+		for( unsigned row=0; row<distances.rows()-1; row++ )
+		    for( unsigned col=0; col<distances.cols(); col++ )
+		    {
+			if( depth_map.isMeasurementValid(row, col) && depth_map.isMeasurementValid(row+1, col) &&
+			    std::min(distances(row, col), distances(row+1, col)) * 1.3 >= std::max(distances(row, col), distances(row+1, col)) )
+			{
+			    const Eigen::Vector3d& p1 = points[depth_map.getIndex(row, col)];
+			    const Eigen::Vector3d& p2 = points[depth_map.getIndex(row+1, col)];
+			    slope_vertices.push_back(p1.cast<float>());
+			    slope_vertices.push_back(p2.cast<float>());
+			    Eigen::Vector3d diff = p2 - p1;
+			    slope_angles.push_back(std::abs(std::atan2(diff.head<2>().norm(), diff.z())));
+			}
+		    }
+	    }
+	    std::cerr << t << std::endl;
+	}
+	for( unsigned stride=1; stride<=4; stride*=2 )
+	{
+	    vizkit3d::DepthMapGeometry geometry(stride, stride);
+	    std::stringstream name;
+	    name << "DepthMap 128x2048 DepthMapGeometry with slopes, stride " << stride;
+	    base::TimeMark t(name.str());
+	    for( int r=0; r<repeat; r++ )
+		geometry.update(depth_map, true);
+	    std::cerr << t << std::endl;
+	}
+    }
+}
@@ -0,0 +1,828 @@
+#define BOOST_TEST_MODULE BaseViz
+#include <boost/test/unit_test.hpp>
+#include "../PointcloudBuffer.hpp"
+#include "../DepthMapGeometry.hpp"
+#include "../TrajectoryPointBuffer.hpp"
+#include "../InstanceBuffer.hpp"
+#include "../LaserScanConverter.hpp"
+#include "../FrameConverter.hpp"
+#include "../SonarFanGeometry.hpp"
+#include "../UncertaintyBatch.hpp"
+#include "../PoseTrail.hpp"
+#include "../CoalescingWorker.hpp"
+#include <atomic>
+
+using namespace vizkit3d;
+
+BOOST_AUTO_TEST_SUITE(viz_helpers)
+
+static base::samples::Pointcloud makeCloud(size_t count, double value, bool with_colors = false)
+{
+    base::samples::Pointcloud cloud;
+    for (size_t i = 0; i < count; ++i)
+    {
+        cloud.points.push_back(base::Point(value, i, -value));
+        if (with_colors)
+            cloud.colors.push_back(base::Vector4d(0.5, 0, 0, 1));
+    }
+    return cloud;
+}
+
+BOOST_AUTO_TEST_CASE(pointcloud_buffer_converts_the_points)
+{
+    PointcloudBuffer buffer;
+    buffer.setDefaultColor(Eigen::Vector4f(0, 1, 0, 1));
+    buffer.push(makeCloud(3, 2));
+    BOOST_REQUIRE_EQUAL(1u, buffer.getClouds().size());
+    BOOST_REQUIRE_EQUAL(3u, buffer.getPointCount());
+    BOOST_CHECK(buffer.isReallocated());
+
+    const float* v = buffer.getVertices();
+    BOOST_CHECK_EQUAL(2.0f, v[6]);
+    BOOST_CHECK_EQUAL(2.0f, v[7]);
+    BOOST_CHECK_EQUAL(-2.0f, v[8]);
+    BOOST_CHECK_EQUAL(1.0f, buffer.getColors()[4 * 2 + 1]);
+
+    // the history of one cloud reuses the arrays
+    buffer.clearDirty();
+    buffer.push(makeCloud(2, 3, true));
+    BOOST_CHECK(!buffer.isReallocated());
+    BOOST_REQUIRE_EQUAL(1u, buffer.getClouds().size());
+    BOOST_CHECK_EQUAL(0u, buffer.getClouds().front().first);
+    BOOST_CHECK_EQUAL(2u, buffer.getDirtyRange().count);
+    BOOST_CHECK_EQUAL(0.5f, buffer.getColors()[4]);
+}
+
+BOOST_AUTO_TEST_CASE(pointcloud_buffer_keeps_a_history)
+{
+    PointcloudBuffer buffer(3);
+    for (int i = 0; i < 3; ++i)
+        buffer.push(makeCloud(4, i));
+    BOOST_CHECK_EQUAL(12u, buffer.getPointCount());
+    buffer.clearDirty();
+
+    // the oldest cloud is dropped, the new ones are written at the end of
+    // the arrays, and then at their beginning
+    BOOST_REQUIRE_EQUAL(16u, buffer.getCapacity());
+    buffer.push(makeCloud(4, 3));
+    BOOST_CHECK_EQUAL(12u, buffer.getClouds().back().first);
+    buffer.clearDirty();
+    buffer.push(makeCloud(4, 4));
+    BOOST_CHECK(!buffer.isReallocated());
+    BOOST_REQUIRE_EQUAL(3u, buffer.getClouds().size());
+    BOOST_CHECK_EQUAL(0u, buffer.getClouds().back().first);
+    BOOST_CHECK_EQUAL(0u, buffer.getDirtyRange().first);
+    BOOST_CHECK_EQUAL(4u, buffer.getDirtyRange().count);
+    BOOST_CHECK_EQUAL(4.0f, buffer.getVertices()[0]);
+    BOOST_CHECK_EQUAL(2.0f, buffer.getVertices()[3 * buffer.getClouds().front().first]);
+
+    // a larger cloud does not fit, the live clouds are compacted
+    buffer.clearDirty();
+    buffer.push(makeCloud(10, 5));
+    BOOST_CHECK(buffer.isReallocated());
+    BOOST_CHECK_EQUAL(18u, buffer.getPointCount());
+    const std::deque<PointcloudBuffer::Range>& clouds = buffer.getClouds();
+    BOOST_REQUIRE_EQUAL(3u, clouds.size());
+    for (size_t i = 0; i < clouds.size(); ++i)
+        BOOST_CHECK_EQUAL(3.0f + i, buffer.getVertices()[3 * clouds[i].first]);
+    BOOST_CHECK_EQUAL(clouds[1].first + clouds[1].count, clouds[2].first);
+
+    buffer.setHistorySize(1);
+    BOOST_CHECK_EQUAL(10u, buffer.getPointCount());
+    buffer.push(base::samples::Pointcloud());
+    BOOST_CHECK_EQUAL(0u, buffer.getPointCount());
+}
+
+static base::samples::DepthMap makeDepthMap(unsigned rows, unsigned cols)
+{
+    base::samples::DepthMap depth_map;
+    depth_map.vertical_projection = base::samples::DepthMap::POLAR;
+    depth_map.horizontal_projection = base::samples::DepthMap::POLAR;
+    depth_map.vertical_interval.push_back(-0.3);
+    depth_map.vertical_interval.push_back(0.3);
+    depth_map.horizontal_interval.push_back(M_PI);
+    depth_map.horizontal_interval.push_back(-M_PI);
+    depth_map.vertical_size = rows;
+    depth_map.horizontal_size = cols;
+    for (unsigned r = 0; r < rows; ++r)
+        for (unsigned c = 0; c < cols; ++c)
+            depth_map.distances.push_back(1.0 + 0.01 * r + 0.1 * c);
+    return depth_map;
+}
+
+BOOST_AUTO_TEST_CASE(depth_map_geometry_matches_the_point_cloud_conversion)
+{
+    base::samples::DepthMap depth_map = makeDepthMap(5, 7);
+    depth_map.distances[3] = base::unknown<float>();
+    depth_map.distances[9] = -1;
+    depth_map.distances[12] = base::infinity<float>();
+
+    std::vector<Eigen::Vector3d> points;
+    depth_map.convertDepthMapToPointCloud(points, false, false);
+
+    DepthMapGeometry geometry;
+    geometry.update(depth_map);
+    BOOST_CHECK_EQUAL(5u, geometry.getRows());
+    BOOST_CHECK_EQUAL(7u, geometry.getCols());
+    BOOST_REQUIRE_EQUAL(32u, geometry.getVertexCount());
+    BOOST_CHECK_EQUAL(-1, geometry.getVertexIndices()[3]);
+    BOOST_CHECK_EQUAL(-1, geometry.getVertexIndices()[9]);
+    BOOST_CHECK_EQUAL(-1, geometry.getVertexIndices()[12]);
+    for (size_t i = 0; i < geometry.getVertexCount(); ++i)
+    {
+        const size_t index = geometry.getSourceIndices()[i];
+        BOOST_REQUIRE(depth_map.isIndexValid(index));
+        BOOST_CHECK_EQUAL(static_cast<int>(i), geometry.getVertexIndices()[index]);
+        const Eigen::Map<const Eigen::Vector3f> vertex(&geometry.getVertices()[3 * i]);
+        BOOST_CHECK_SMALL((vertex.cast<double>() - points[index]).norm(), 1e-5);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(depth_map_geometry_decimates_and_caches_the_projection)
+{
+    base::samples::DepthMap depth_map = makeDepthMap(5, 7);
+    std::vector<Eigen::Vector3d> points;
+    depth_map.convertDepthMapToPointCloud(points, false, false);
+
+    DepthMapGeometry geometry(2, 3);
+    geometry.update(depth_map);
+    BOOST_CHECK_EQUAL(1u, geometry.getProjectionUpdates());
+    BOOST_CHECK_EQUAL(3u, geometry.getRows());
+    BOOST_CHECK_EQUAL(3u, geometry.getCols());
+    BOOST_REQUIRE_EQUAL(9u, geometry.getVertexCount());
+    for (size_t i = 0; i < geometry.getVertexCount(); ++i)
+    {
+        const size_t index = geometry.getSourceIndices()[i];
+        BOOST_CHECK_EQUAL(0u, (index / 7) % 2);
+        BOOST_CHECK_EQUAL(0u, (index % 7) % 3);
+        const Eigen::Map<const Eigen::Vector3f> vertex(&geometry.getVertices()[3 * i]);
+        BOOST_CHECK_SMALL((vertex.cast<double>() - points[index]).norm(), 1e-5);
+    }
+
+    // new distances reuse the tables, a new projection or stride does not
+    depth_map.distances[0] = 5;
+    geometry.update(depth_map);
+    BOOST_CHECK_EQUAL(1u, geometry.getProjectionUpdates());
+    BOOST_CHECK_CLOSE(5.0f, Eigen::Map<const Eigen::Vector3f>(&geometry.getVertices()[0]).norm(), 1e-4);
+    depth_map.vertical_interval[1] = 0.4;
+    geometry.update(depth_map);
+    BOOST_CHECK_EQUAL(2u, geometry.getProjectionUpdates());
+    geometry.setStride(1, 1);
+    geometry.update(depth_map);
+    BOOST_CHECK_EQUAL(3u, geometry.getProjectionUpdates());
+    BOOST_CHECK_EQUAL(35u, geometry.getVertexCount());
+
+    BOOST_CHECK_THROW(geometry.setStride(0, 1), std::invalid_argument);
+    depth_map.distances.pop_back();
+    BOOST_CHECK_THROW(geometry.update(depth_map), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(depth_map_geometry_computes_the_slopes)
+{
+    base::samples::DepthMap depth_map = makeDepthMap(3, 2);
+    // the first column has a jump between the last rows, the second column
+    // an invalid measurement
+    depth_map.distances[4] = 2;
+    depth_map.distances[3] = base::unknown<float>();
+
+    DepthMapGeometry geometry;
+    geometry.update(depth_map);
+    BOOST_CHECK(geometry.getSlopeVertices().empty());
+    geometry.update(depth_map, true);
+    BOOST_REQUIRE_EQUAL(1u, geometry.getSlopeAngles().size());
+    BOOST_REQUIRE_EQUAL(6u, geometry.getSlopeVertices().size());
+    for (int i = 0; i < 6; ++i)
+        BOOST_CHECK_EQUAL(geometry.getVertices()[i < 3 ? i : 3 * 2 + i - 3], geometry.getSlopeVertices()[i]);
+    // the second row is below the first one
+    BOOST_CHECK_SMALL(geometry.getSlopeAngles()[0] - static_cast<float>(M_PI), 0.5f);
+}
+
+BOOST_AUTO_TEST_CASE(trajectory_point_buffer_keeps_the_live_points_contiguous)
+{
+    TrajectoryPointBuffer buffer(4);
+    BOOST_CHECK(buffer.empty());
+    const Eigen::Vector4f red(1, 0, 0, 1);
+    for (int i = 0; i < 3; ++i)
+        buffer.push(Eigen::Vector3f(i, 0, 0), red);
+    BOOST_REQUIRE_EQUAL(3u, buffer.size());
+    for (int i = 0; i < 3; ++i)
+        BOOST_CHECK_EQUAL(i, buffer.getVertices()[3 * i]);
+
+    // wraps around, the oldest points are dropped
+    const Eigen::Vector4f green(0, 1, 0, 1);
+    const float more[] = { 3, 0, 0, 4, 0, 0, 5, 0, 0 };
+    buffer.push(more, 3, green);
+    BOOST_REQUIRE_EQUAL(4u, buffer.size());
+    for (int i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(2 + i, buffer.getVertices()[3 * i]);
+    BOOST_CHECK_EQUAL(1, buffer.getColors()[0]);
+    BOOST_CHECK_EQUAL(1, buffer.getColors()[4 + 1]);
+    BOOST_CHECK_EQUAL(1, buffer.getColors()[12 + 1]);
+
+    // more points than the buffer can hold
+    std::vector<float> many;
+    for (int i = 0; i < 10; ++i)
+    {
+        many.push_back(10 + i);
+        many.push_back(0);
+        many.push_back(0);
+    }
+    buffer.push(&many[0], 10, green);
+    BOOST_REQUIRE_EQUAL(4u, buffer.size());
+    for (int i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(16 + i, buffer.getVertices()[3 * i]);
+
+    buffer.setMaxPoints(2);
+    BOOST_REQUIRE_EQUAL(2u, buffer.size());
+    BOOST_CHECK_EQUAL(18, buffer.getVertices()[0]);
+    BOOST_CHECK_EQUAL(19, buffer.getVertices()[3]);
+    buffer.clear();
+    BOOST_CHECK(buffer.empty());
+}
+
+BOOST_AUTO_TEST_CASE(resample_by_arc_length)
+{
+    // a slow start, the points of a uniform parameter sampling are denser
+    // there
+    const float polyline[] = { 0, 0, 0, 0.01, 0, 0, 0.02, 0, 0, 0.5, 0, 0, 0.5, 0.73, 0 };
+    std::vector<float> result;
+    resampleByArcLength(polyline, 5, 0.1, result);
+    BOOST_REQUIRE_EQUAL(3u * 13, result.size());
+    for (size_t i = 0; i < 5; ++i)
+        BOOST_CHECK_CLOSE(0.1 * (i + 1), result[3 * (i + 1)], 1e-3);
+    BOOST_CHECK_CLOSE(0.5f, result[3 * 6], 1e-3);
+    BOOST_CHECK_CLOSE(0.1f, result[3 * 6 + 1], 1e-3);
+    // the last sample would be 3 cm before the end, and is replaced by it
+    BOOST_CHECK_EQUAL(0.73f, result[3 * 12 + 1]);
+    BOOST_CHECK_CLOSE(0.6f, result[3 * 11 + 1], 1e-3);
+
+    resampleByArcLength(polyline, 1, 0.1, result);
+    BOOST_CHECK_EQUAL(3u, result.size());
+    BOOST_CHECK_THROW(resampleByArcLength(polyline, 5, 0, result), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(instance_buffer_layout)
+{
+    InstanceBuffer instances;
+    BOOST_CHECK(instances.empty());
+    BOOST_CHECK(instances.getPositions() == 0);
+
+    const Eigen::Vector3d origin(500000, 5000000, 10);
+    const Eigen::Quaterniond rotation(Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitZ()));
+    instances.push(origin, Eigen::Quaterniond::Identity(), 1, Eigen::Vector4f(1, 0, 0, 1));
+    instances.push(origin + Eigen::Vector3d(1.25, -2, 0.5), rotation, 2, Eigen::Vector4f(0, 1, 0, 0.5));
+    BOOST_REQUIRE_EQUAL(2u, instances.size());
+
+    // the positions are relative to the first instance, which keeps their
+    // precision as floats
+    BOOST_CHECK(instances.getOrigin() == origin);
+    const float* positions = instances.getPositions();
+    const float expected_positions[] = { 0, 0, 0, 1, 1.25, -2, 0.5, 2 };
+    for (int i = 0; i < 8; ++i)
+        BOOST_CHECK_EQUAL(expected_positions[i], positions[i]);
+
+    // quaternions in x, y, z, w order
+    const float* orientations = instances.getOrientations();
+    BOOST_CHECK_EQUAL(1.0f, orientations[3]);
+    BOOST_CHECK_CLOSE(rotation.z(), orientations[4 + 2], 1e-4);
+    BOOST_CHECK_CLOSE(rotation.w(), orientations[4 + 3], 1e-4);
+
+    const float* colors = instances.getColors();
+    BOOST_CHECK_EQUAL(1.0f, colors[0]);
+    BOOST_CHECK_EQUAL(1.0f, colors[4 + 1]);
+    BOOST_CHECK_EQUAL(0.5f, colors[4 + 3]);
+
+    // a vertex of the mesh is scaled, rotated then translated
+    const Eigen::Vector3f vertex = instances.transform(1, Eigen::Vector3f(1, 0, 0));
+    BOOST_CHECK_SMALL((vertex - Eigen::Vector3f(1.25, 0, 0.5)).norm(), 1e-5f);
+
+    // the box of the positions, extended by the largest scaled mesh
+    const Eigen::AlignedBox3f bounds = instances.getBounds(0.5);
+    BOOST_CHECK_SMALL((bounds.min() - Eigen::Vector3f(-1, -3, -1)).norm(), 1e-6f);
+    BOOST_CHECK_SMALL((bounds.max() - Eigen::Vector3f(2.25, 1, 1.5)).norm(), 1e-6f);
+
+    instances.clear();
+    BOOST_CHECK(instances.empty());
+    instances.push(Eigen::Vector3d(1, 2, 3), Eigen::Quaterniond::Identity(), 1, Eigen::Vector4f::Ones());
+    BOOST_CHECK(instances.getOrigin() == Eigen::Vector3d(1, 2, 3));
+}
+
+BOOST_AUTO_TEST_CASE(instance_buffer_tracks_the_changed_instances)
+{
+    InstanceBuffer instances;
+    const Eigen::Vector4f white(1, 1, 1, 1);
+    for (int i = 0; i < 4; ++i)
+        instances.push(Eigen::Vector3d(i, 0, 0), Eigen::Quaterniond::Identity(), 1, white);
+    InstanceBuffer::Range dirty = instances.getDirtyRange();
+    BOOST_CHECK_EQUAL(0u, dirty.first);
+    BOOST_CHECK_EQUAL(4u, dirty.count);
+
+    instances.clearDirty();
+    instances.set(1, Eigen::Vector3d(10, 0, 0), Eigen::Quaterniond::Identity(), 1, white);
+    dirty = instances.getDirtyRange();
+    BOOST_CHECK_EQUAL(1u, dirty.first);
+    BOOST_CHECK_EQUAL(1u, dirty.count);
+    BOOST_CHECK_EQUAL(10, instances.getPositions()[4]);
+
+    // the last instance takes the place of the removed one
+    instances.clearDirty();
+    instances.remove(0);
+    BOOST_REQUIRE_EQUAL(3u, instances.size());
+    BOOST_CHECK_EQUAL(3, instances.getPositions()[0]);
+    dirty = instances.getDirtyRange();
+    BOOST_CHECK_EQUAL(0u, dirty.first);
+    BOOST_CHECK_EQUAL(1u, dirty.count);
+    instances.clearDirty();
+    instances.remove(2);
+    BOOST_CHECK_EQUAL(0u, instances.getDirtyRange().count);
+
+    // the bounds only grow until there were more changes than instances
+    BOOST_CHECK_EQUAL(10.5, instances.getBounds(0.5).max().x());
+    instances.set(1, Eigen::Vector3d(2, 0, 0), Eigen::Quaterniond::Identity(), 1, white);
+    BOOST_CHECK_EQUAL(1.5, instances.getBounds(0.5).min().x());
+    BOOST_CHECK_EQUAL(10.5, instances.getBounds(0.5).max().x());
+    instances.set(0, Eigen::Vector3d(3, 0, 0), Eigen::Quaterniond::Identity(), 1, white);
+    instances.set(0, Eigen::Vector3d(3, 0, 0), Eigen::Quaterniond::Identity(), 1, white);
+    BOOST_CHECK_EQUAL(1.5, instances.getBounds(0.5).min().x());
+    BOOST_CHECK_EQUAL(3.5, instances.getBounds(0.5).max().x());
+}
+
+static base::samples::LaserScan makeScan()
+{
+    base::samples::LaserScan scan;
+    scan.start_angle = -M_PI / 2;
+    scan.angular_resolution = M_PI / 4;
+    scan.minRange = 100;
+    scan.maxRange = 10000;
+    const boost::uint32_t ranges[] = { 1000, base::samples::TOO_FAR, 2500, 1250, 50 };
+    scan.ranges.assign(ranges, ranges + 5);
+    return scan;
+}
+
+BOOST_AUTO_TEST_CASE(laser_scan_converter_matches_the_point_cloud_conversion)
+{
+    base::samples::LaserScan scan = makeScan();
+    std::vector<Eigen::Vector3d> points;
+    scan.convertScanToPointCloud(points);
+    BOOST_REQUIRE_EQUAL(3u, points.size());
+
+    LaserScanConverter converter;
+    std::vector<float> vertices(3 * scan.ranges.size());
+    BOOST_REQUIRE_EQUAL(3u, converter.convert(scan, &vertices[0]));
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const Eigen::Map<const Eigen::Vector3f> vertex(&vertices[3 * i]);
+        BOOST_CHECK_SMALL((vertex.cast<double>() - points[i]).norm(), 1e-5);
+    }
+
+    // the Y-forward rotation is folded into the beam directions
+    converter.setYForward(true);
+    BOOST_REQUIRE_EQUAL(3u, converter.convert(scan, &vertices[0]));
+    BOOST_CHECK_EQUAL(2u, converter.getTableUpdates());
+    const Eigen::Quaterniond rotation(Eigen::AngleAxisd(M_PI / 2, Eigen::Vector3d::UnitZ()));
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const Eigen::Map<const Eigen::Vector3f> vertex(&vertices[3 * i]);
+        BOOST_CHECK_SMALL((vertex.cast<double>() - rotation * points[i]).norm(), 1e-5);
+    }
+
+    // new ranges reuse the table
+    scan.ranges[0] = 2000;
+    converter.convert(scan, &vertices[0]);
+    BOOST_CHECK_EQUAL(2u, converter.getTableUpdates());
+    BOOST_CHECK_CLOSE(2.0f, vertices[0], 1e-4);
+    scan.angular_resolution = M_PI / 8;
+    converter.convert(scan, &vertices[0]);
+    BOOST_CHECK_EQUAL(3u, converter.getTableUpdates());
+}
+
+BOOST_AUTO_TEST_CASE(laser_scan_converter_colorizes_with_the_palette)
+{
+    base::samples::LaserScan scan = makeScan();
+    LaserScanConverter converter;
+    std::vector<float> vertices(3 * scan.ranges.size());
+    std::vector<float> colors(4 * scan.ranges.size());
+    BOOST_CHECK_THROW(converter.convert(scan, &vertices[0], &colors[0]), std::logic_error);
+
+    base::aligned::vector<Eigen::Vector4f> palette;
+    for (int i = 0; i < 4; ++i)
+        palette.push_back(Eigen::Vector4f(i, 0, 0, 1));
+    converter.setPalette(palette);
+    converter.setColorizeInterval(1.0);
+    BOOST_REQUIRE_EQUAL(3u, converter.convert(scan, &vertices[0], &colors[0]));
+
+    // forward distances: 0 (beam at -90 degrees), 2500 mm, 1250 / sqrt(2) mm
+    BOOST_CHECK_EQUAL(0, colors[0]);
+    BOOST_CHECK_EQUAL(2, colors[4]);
+    BOOST_CHECK_EQUAL(3, colors[8]);
+    BOOST_CHECK_EQUAL(1, colors[8 + 3]);
+}
+
+using base::samples::frame::Frame;
+
+static void checkPixel(RGBImage const& image, int x, int y, int r, int g, int b)
+{
+    uint8_t const* pixel = &image.data[3 * (y * image.width + x)];
+    BOOST_CHECK_EQUAL(r, pixel[0]);
+    BOOST_CHECK_EQUAL(g, pixel[1]);
+    BOOST_CHECK_EQUAL(b, pixel[2]);
+}
+
+BOOST_AUTO_TEST_CASE(frame_converter_handles_the_channel_modes)
+{
+    RGBImage image;
+    Frame gray(2, 1, 8, base::samples::frame::MODE_GRAYSCALE);
+    gray.image[0] = 10;
+    gray.image[1] = 20;
+    convertFrameToRGB(gray, image);
+    BOOST_REQUIRE_EQUAL(2, image.width);
+    BOOST_REQUIRE_EQUAL(1, image.height);
+    checkPixel(image, 1, 0, 20, 20, 20);
+
+    Frame bgr(1, 1, 8, base::samples::frame::MODE_BGR);
+    bgr.image[0] = 1; bgr.image[1] = 2; bgr.image[2] = 3;
+    convertFrameToRGB(bgr, image);
+    checkPixel(image, 0, 0, 3, 2, 1);
+
+    Frame rgb32(1, 1, 8, base::samples::frame::MODE_RGB32);
+    rgb32.image[0] = 1; rgb32.image[1] = 2; rgb32.image[2] = 3; rgb32.image[3] = 4;
+    convertFrameToRGB(rgb32, image);
+    checkPixel(image, 0, 0, 1, 2, 3);
+
+    // 12 bit values in 16 bit little-endian channels
+    Frame deep(1, 1, 12, base::samples::frame::MODE_GRAYSCALE);
+    deep.image[0] = 0xf0; deep.image[1] = 0x0f;
+    convertFrameToRGB(deep, image);
+    checkPixel(image, 0, 0, 255, 255, 255);
+
+    Frame jpeg(2, 2, 8, base::samples::frame::MODE_JPEG, 0, 10);
+    BOOST_CHECK_THROW(convertFrameToRGB(jpeg, image), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(frame_converter_handles_uyvy_and_bayer)
+{
+    RGBImage image;
+    Frame uyvy(2, 1, 16, base::samples::frame::MODE_UYVY);
+    uyvy.image[0] = 128; uyvy.image[1] = 16; uyvy.image[2] = 128; uyvy.image[3] = 235;
+    convertFrameToRGB(uyvy, image);
+    checkPixel(image, 0, 0, 0, 0, 0);
+    checkPixel(image, 1, 0, 255, 255, 255);
+    Frame odd_uyvy(3, 1, 16, base::samples::frame::MODE_UYVY);
+    BOOST_CHECK_THROW(convertFrameToRGB(odd_uyvy, image), std::runtime_error);
+
+    // the same 2x2 block in two patterns, extended to 3x3 to check that the
+    // last row and column reuse it
+    const uint8_t rggb[] = { 200, 100, 0, 50, 10, 0, 0, 0, 0 };
+    const uint8_t bggr[] = { 10, 100, 0, 50, 200, 0, 0, 0, 0 };
+    Frame bayer(3, 3, 8, base::samples::frame::MODE_BAYER_RGGB);
+    bayer.image.assign(rggb, rggb + 9);
+    convertFrameToRGB(bayer, image);
+    checkPixel(image, 0, 0, 200, 75, 10);
+    checkPixel(image, 2, 2, 200, 75, 10);
+
+    bayer.init(3, 3, 8, base::samples::frame::MODE_BAYER_BGGR);
+    bayer.image.assign(bggr, bggr + 9);
+    convertFrameToRGB(bayer, image);
+    checkPixel(image, 1, 1, 200, 75, 10);
+
+    Frame tiny(1, 1, 8, base::samples::frame::MODE_BAYER_GRBG);
+    BOOST_CHECK_THROW(convertFrameToRGB(tiny, image), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(coalescing_worker_keeps_only_the_latest_sample)
+{
+    std::mutex gate;
+    std::atomic<int> started(0);
+    CoalescingWorker<int, int> worker([&](int const& in, int& out)
+    {
+        ++started;
+        std::lock_guard<std::mutex> lock(gate);
+        if (in < 0)
+            throw std::runtime_error("negative");
+        out = 10 * in;
+    });
+
+    int result = 0;
+    BOOST_CHECK(!worker.fetch(result));
+
+    std::unique_lock<std::mutex> hold(gate);
+    worker.push(1);
+    while (started == 0)
+        std::this_thread::yield();
+    // 1 is being processed, so 2 is replaced by 3
+    worker.push(2);
+    worker.push(3);
+    hold.unlock();
+    worker.wait();
+
+    BOOST_CHECK_EQUAL(1u, worker.getDroppedCount());
+    BOOST_CHECK_EQUAL(2u, worker.getProcessedCount());
+    BOOST_REQUIRE(worker.fetch(result));
+    BOOST_CHECK_EQUAL(30, result);
+    BOOST_CHECK(!worker.fetch(result));
+
+    worker.push(-1);
+    worker.wait();
+    BOOST_CHECK_THROW(worker.fetch(result), std::runtime_error);
+    BOOST_CHECK(!worker.fetch(result));
+    BOOST_CHECK_EQUAL(30, result);
+}
+
+BOOST_AUTO_TEST_CASE(coalescing_worker_repeats_the_last_sample)
+{
+    std::atomic<int> factor(10);
+    CoalescingWorker<int, int> worker([&](int const& in, int& out) { out = factor * in; });
+
+    int result = 0;
+    worker.repeat();
+    worker.wait();
+    BOOST_CHECK(!worker.fetch(result));
+
+    worker.push(2);
+    worker.wait();
+    BOOST_REQUIRE(worker.fetch(result));
+    BOOST_CHECK_EQUAL(20, result);
+
+    // e.g. a property of the plugin changed
+    factor = 100;
+    worker.repeat();
+    worker.wait();
+    BOOST_REQUIRE(worker.fetch(result));
+    BOOST_CHECK_EQUAL(200, result);
+    BOOST_CHECK_EQUAL(2u, worker.getProcessedCount());
+    BOOST_CHECK_EQUAL(0u, worker.getDroppedCount());
+}
+
+static base::samples::Sonar makeSonar(int beam_count)
+{
+    base::samples::Sonar sonar(base::Time::now(), base::Time::fromMilliseconds(1), 4,
+            base::Angle::fromDeg(10), base::Angle::fromDeg(20), beam_count, false);
+    sonar.speed_of_sound = 1000;
+    sonar.setRegularBeamBearings(base::Angle::fromDeg(-10), base::Angle::fromDeg(10));
+    return sonar;
+}
+
+BOOST_AUTO_TEST_CASE(sonar_fan_geometry_maps_the_bins_to_the_fan)
+{
+    base::samples::Sonar sonar = makeSonar(3);
+    SonarFanGeometry fan;
+    BOOST_REQUIRE(fan.update(sonar));
+    BOOST_CHECK_CLOSE(4.0f, fan.getRange(), 1e-4);
+    BOOST_REQUIRE_EQUAL(9u, fan.getVertexCount());
+
+    // the first edge is 15 degrees right of X, the last 15 degrees left
+    std::vector<float> const& vertices = fan.getVertices();
+    BOOST_CHECK_SMALL(vertices[0], 1e-6f);
+    BOOST_CHECK_CLOSE(4 * std::cos(M_PI / 12), vertices[3], 1e-4);
+    BOOST_CHECK_CLOSE(-4 * std::sin(M_PI / 12), vertices[4], 1e-4);
+    BOOST_CHECK_CLOSE(4 * std::sin(M_PI / 12), vertices[8 * 3 + 1], 1e-4);
+    // neighbouring beams have their own vertices on their common edge
+    BOOST_CHECK_EQUAL(vertices[2 * 3], vertices[4 * 3]);
+    BOOST_CHECK_EQUAL(vertices[2 * 3 + 1], vertices[4 * 3 + 1]);
+
+    // each beam samples the center of its row, along s
+    std::vector<float> const& texcoords = fan.getTexCoords();
+    for (int beam = 0; beam < 3; ++beam)
+    {
+        BOOST_CHECK_EQUAL(0, texcoords[6 * beam]);
+        BOOST_CHECK_EQUAL(1, texcoords[6 * beam + 2]);
+        BOOST_CHECK_EQUAL(1, texcoords[6 * beam + 4]);
+        for (int vertex = 0; vertex < 3; ++vertex)
+            BOOST_CHECK_CLOSE((beam + 0.5f) / 3, texcoords[6 * beam + 2 * vertex + 1], 1e-4);
+    }
+
+    // a new ping with the same geometry does not rebuild the mesh
+    sonar.bins.assign(sonar.bins.size(), 0.5);
+    BOOST_CHECK(!fan.update(sonar));
+    sonar.bin_duration = base::Time::fromMilliseconds(2);
+    BOOST_CHECK(fan.update(sonar));
+    BOOST_CHECK_CLOSE(8.0f, fan.getRange(), 1e-4);
+    BOOST_CHECK_EQUAL(2u, fan.getMeshUpdates());
+
+    sonar.bins.pop_back();
+    BOOST_CHECK_THROW(fan.update(sonar), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(sonar_fan_geometry_uses_the_beam_width_of_single_beams)
+{
+    base::samples::Sonar sonar = makeSonar(1);
+    SonarFanGeometry fan;
+    fan.update(sonar);
+    BOOST_REQUIRE_EQUAL(3u, fan.getVertexCount());
+    const double left = std::atan2(fan.getVertices()[4], fan.getVertices()[3]);
+    const double right = std::atan2(fan.getVertices()[7], fan.getVertices()[6]);
+    BOOST_CHECK_CLOSE(-15.0, left * 180 / M_PI, 1e-3);
+    BOOST_CHECK_CLOSE(-5.0, right * 180 / M_PI, 1e-3);
+    BOOST_CHECK_CLOSE(0.5f, fan.getTexCoords()[1], 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(sonar_bins_are_scaled_to_the_texture_range)
+{
+    std::vector<float> bins;
+    bins.push_back(0);
+    bins.push_back(50);
+    bins.push_back(200);
+    bins.push_back(-1);
+    std::vector<float> scaled;
+
+    // normalized by the largest bin
+    scaleSonarBins(bins, 0, scaled);
+    BOOST_REQUIRE_EQUAL(4u, scaled.size());
+    BOOST_CHECK_EQUAL(0, scaled[0]);
+    BOOST_CHECK_CLOSE(0.25f, scaled[1], 1e-4);
+    BOOST_CHECK_EQUAL(1, scaled[2]);
+    BOOST_CHECK_EQUAL(0, scaled[3]);
+
+    // fixed range, with saturation
+    scaleSonarBins(bins, 100, scaled);
+    BOOST_CHECK_CLOSE(0.5f, scaled[1], 1e-4);
+    BOOST_CHECK_EQUAL(1, scaled[2]);
+
+    std::vector<float> dark(3, 0);
+    scaleSonarBins(dark, 0, scaled);
+    BOOST_CHECK_EQUAL(0, scaled[2]);
+}
+
+BOOST_AUTO_TEST_CASE(uncertainty_batch_draws_the_principal_ellipses)
+{
+    // standard deviations of 1, 2 and 3 along Y, X and Z
+    const Eigen::Matrix3d cov = Eigen::Vector3d(4, 1, 9).asDiagonal();
+    UncertaintyBatch batch(4);
+    BOOST_REQUIRE_EQUAL(24u, batch.getVerticesPerEllipsoid());
+    batch.push(Eigen::Vector3d(100, 0, 0), cov);
+    batch.push(Eigen::Vector3d(110, 0, 0), cov);
+    BOOST_REQUIRE_EQUAL(2u, batch.size());
+    BOOST_CHECK_EQUAL(100, batch.getOrigin().x());
+
+    std::vector<float> const& vertices = batch.getEllipseVertices();
+    BOOST_REQUIRE_EQUAL(2 * 24 * 3u, vertices.size());
+    Eigen::Map<const Eigen::Matrix3Xf> points(&vertices[0], 3, 48);
+    // every vertex is on the ellipsoid, relative to the origin
+    for (int i = 0; i < 48; ++i)
+    {
+        Eigen::Vector3f p = points.col(i);
+        p.x() -= (i < 24) ? 0 : 10;
+        const float r = (p.cwiseQuotient(Eigen::Vector3f(2, 1, 3))).norm();
+        BOOST_CHECK_CLOSE(1.0f, r, 1e-3);
+    }
+    BOOST_CHECK(batch.getSampleVertices().empty());
+}
+
+BOOST_AUTO_TEST_CASE(uncertainty_batch_overwrites_and_removes_ellipsoids)
+{
+    UncertaintyBatch batch(4);
+    batch.setSampleCount(2);
+    for (int i = 0; i < 3; ++i)
+        batch.push(Eigen::Vector3d(i, 0, 0), Eigen::Matrix3d::Zero());
+    BOOST_CHECK_EQUAL(3u, batch.getDirtyRange().count);
+    BOOST_CHECK_THROW(batch.setSampleCount(3), std::logic_error);
+
+    // zero covariances collapse every vertex on the mean
+    batch.clearDirty();
+    batch.set(1, Eigen::Vector3d(5, 0, 0), Eigen::Matrix3d::Zero());
+    BOOST_CHECK_EQUAL(1u, batch.getDirtyRange().first);
+    BOOST_CHECK_EQUAL(1u, batch.getDirtyRange().count);
+    BOOST_CHECK_EQUAL(5, batch.getEllipseVertices()[3 * 24]);
+    BOOST_CHECK_EQUAL(5, batch.getSampleVertices()[3 * 2]);
+
+    batch.clearDirty();
+    batch.remove(0);
+    BOOST_REQUIRE_EQUAL(2u, batch.size());
+    BOOST_CHECK_EQUAL(2 * 24 * 3u, batch.getEllipseVertices().size());
+    BOOST_CHECK_EQUAL(2 * 2 * 3u, batch.getSampleVertices().size());
+    BOOST_CHECK_EQUAL(2, batch.getEllipseVertices()[0]);
+    BOOST_CHECK_EQUAL(2, batch.getSampleVertices()[3]);
+    BOOST_CHECK_EQUAL(0u, batch.getDirtyRange().first);
+    BOOST_CHECK_EQUAL(1u, batch.getDirtyRange().count);
+}
+
+BOOST_AUTO_TEST_CASE(uncertainty_batch_samples_follow_the_covariance)
+{
+    Eigen::Matrix3d cov;
+    cov << 4, 1, 0,
+           1, 2, 0.5,
+           0, 0.5, 1;
+    const Eigen::Matrix3d factor = covarianceFactor(cov);
+    BOOST_CHECK((factor * factor.transpose()).isApprox(cov, 1e-9));
+
+    // semi-definite covariances fall back to the principal axes
+    const Eigen::Matrix3d flat = Eigen::Vector3d(1, 0, 4).asDiagonal();
+    const Eigen::Matrix3d flat_factor = covarianceFactor(flat);
+    BOOST_CHECK((flat_factor * flat_factor.transpose()).isApprox(flat, 1e-9));
+
+    UncertaintyBatch batch;
+    batch.setSampleCount(20000);
+    batch.push(Eigen::Vector3d(1, 2, 3), cov);
+    std::vector<float> const& vertices = batch.getSampleVertices();
+    BOOST_REQUIRE_EQUAL(3 * 20000u, vertices.size());
+
+    Eigen::Map<const Eigen::Matrix3Xf> samples(&vertices[0], 3, 20000);
+    const Eigen::Vector3d mean = samples.rowwise().mean().cast<double>();
+    const Eigen::Matrix3Xd centered = samples.cast<double>().colwise() - mean;
+    const Eigen::Matrix3d sample_cov = centered * centered.transpose() / 20000;
+    BOOST_CHECK_SMALL(mean.norm(), 0.05);
+    BOOST_CHECK_SMALL((sample_cov - cov).cwiseAbs().maxCoeff(), 0.15);
+}
+
+
+BOOST_AUTO_TEST_CASE(trajectory_point_buffer_without_colors)
+{
+    TrajectoryPointBuffer buffer(2, false);
+    BOOST_CHECK(!buffer.hasColors());
+    BOOST_CHECK(buffer.getBufferColors() == 0);
+    const float points[] = { 0, 0, 0, 1, 0, 0, 2, 0, 0 };
+    buffer.push(points, 3);
+    buffer.push(Eigen::Vector3f(3, 0, 0));
+    BOOST_REQUIRE_EQUAL(2u, buffer.size());
+    BOOST_CHECK(buffer.getColors() == 0);
+    BOOST_CHECK_EQUAL(2, buffer.getVertices()[0]);
+    BOOST_CHECK_EQUAL(3, buffer.getVertices()[3]);
+
+    buffer.setMaxPoints(3);
+    BOOST_REQUIRE_EQUAL(2u, buffer.size());
+    BOOST_CHECK_EQUAL(3, buffer.getVertices()[3]);
+}
+
+BOOST_AUTO_TEST_CASE(trajectory_point_buffer_tracks_the_written_points)
+{
+    TrajectoryPointBuffer buffer(4);
+    BOOST_CHECK(buffer.isReallocated());
+    BOOST_CHECK_EQUAL(8u, buffer.getCapacity());
+    buffer.clearDirty();
+    BOOST_CHECK_EQUAL(0u, buffer.getDirtyRange().count);
+
+    const Eigen::Vector4f red(1, 0, 0, 1);
+    for (int i = 0; i < 3; ++i)
+        buffer.push(Eigen::Vector3f(i, 0, 0), red);
+    buffer.clearDirty();
+    buffer.push(Eigen::Vector3f(3, 0, 0), red);
+    TrajectoryPointBuffer::Range dirty = buffer.getDirtyRange();
+    BOOST_CHECK_EQUAL(3u, dirty.first);
+    BOOST_CHECK_EQUAL(1u, dirty.count);
+
+    // the storage arrays can be drawn from getFirst()
+    buffer.clearDirty();
+    buffer.push(Eigen::Vector3f(4, 0, 0), red);
+    dirty = buffer.getDirtyRange();
+    BOOST_CHECK_EQUAL(0u, dirty.first);
+    BOOST_CHECK_EQUAL(1u, dirty.count);
+    BOOST_CHECK_EQUAL(1u, buffer.getFirst());
+    for (int i = 0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(1 + i, buffer.getBufferVertices()[3 * (buffer.getFirst() + i)]);
+    BOOST_CHECK_EQUAL(4, buffer.getBufferVertices()[3 * 4]);
+
+    buffer.clearDirty();
+    buffer.setMaxPoints(8);
+    BOOST_CHECK(buffer.isReallocated());
+    dirty = buffer.getDirtyRange();
+    BOOST_CHECK_EQUAL(0u, dirty.first);
+    BOOST_CHECK_EQUAL(8u, dirty.count);
+}
+
+BOOST_AUTO_TEST_CASE(pose_trail_decimates_the_poses)
+{
+    PoseTrail trail(3);
+    trail.setThreshold(base::PoseUpdateThreshold(0.5, 0.1));
+
+    Eigen::Affine3d pose(Eigen::Translation3d(100, 0, 0));
+    BOOST_CHECK(trail.update(pose));
+    BOOST_CHECK_EQUAL(base::Vector3d(100, 0, 0), trail.getOrigin());
+    // neither moved nor turned enough
+    pose.translation().x() += 0.2;
+    BOOST_CHECK(!trail.update(pose));
+    pose.translation().x() += 0.4;
+    BOOST_CHECK(trail.update(pose));
+    pose.rotate(Eigen::AngleAxisd(0.2, Eigen::Vector3d::UnitZ()));
+    BOOST_CHECK(trail.update(pose));
+    BOOST_CHECK_EQUAL(3u, trail.size());
+    BOOST_CHECK(!trail.update(Eigen::Vector3d(100.8, 0, 0)));
+    BOOST_CHECK(trail.update(Eigen::Vector3d(101.2, 0, 0)));
+
+    // the positions are relative to the origin, and the oldest are dropped
+    BOOST_REQUIRE_EQUAL(3u, trail.size());
+    float const* points = trail.getPoints().getVertices();
+    BOOST_CHECK_CLOSE(0.6f, points[0], 1e-3);
+    BOOST_CHECK_CLOSE(0.6f, points[3], 1e-3);
+    BOOST_CHECK_CLOSE(1.2f, points[6], 1e-3);
+    BOOST_CHECK(trail.getPoints().getColors() == 0);
+
+    // the bounds still contain the dropped origin, until as many positions
+    // were dropped as there are live ones
+    BOOST_CHECK_CLOSE(1.2f, trail.getBounds().max().x(), 1e-3);
+    BOOST_CHECK_EQUAL(0, trail.getBounds().min().x());
+    BOOST_CHECK(trail.update(Eigen::Vector3d(101.8, 0, 0)));
+    BOOST_CHECK_EQUAL(0, trail.getBounds().min().x());
+    BOOST_CHECK(trail.update(Eigen::Vector3d(102.4, 0, 0)));
+    BOOST_CHECK_CLOSE(1.2f, trail.getBounds().min().x(), 1e-3);
+    BOOST_CHECK_CLOSE(2.4f, trail.getBounds().max().x(), 1e-3);
+    trail.setMaxPoints(1);
+    BOOST_CHECK_CLOSE(2.4f, trail.getBounds().min().x(), 1e-3);
+
+    trail.clear();
+    BOOST_CHECK(trail.empty());
+    BOOST_CHECK(trail.getBounds().isEmpty());
+    BOOST_CHECK(trail.update(Eigen::Vector3d(5, 0, 0)));
+    BOOST_CHECK_EQUAL(base::Vector3d(5, 0, 0), trail.getOrigin());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
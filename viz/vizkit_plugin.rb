@@ -9,6 +9,8 @@ Vizkit::UiLoader.register_3d_plugin_for('TrajectoryVisualization', "/wrappers/ge
 Vizkit::UiLoader.register_3d_plugin_for('TrajectoryVisualization', "/std/vector</base/Trajectory>", :updateTr)
 Vizkit::UiLoader.register_3d_plugin('RigidBodyStateVisualization',"base", 'RigidBodyStateVisualization')
 Vizkit::UiLoader.register_3d_plugin_for('RigidBodyStateVisualization', "/base/samples/RigidBodyState", :updateRigidBodyState)
+Vizkit::UiLoader.register_3d_plugin('RigidBodyStateCollectionVisualization',"base", 'RigidBodyStateCollectionVisualization')
+Vizkit::UiLoader.register_3d_plugin_for('RigidBodyStateCollectionVisualization', "/std/vector</base/samples/RigidBodyState>", :updatePoses)
 Vizkit::UiLoader.register_3d_plugin('BodyStateVisualization',"base", 'BodyStateVisualization')
 Vizkit::UiLoader.register_3d_plugin_for('BodyStateVisualization', "/base/samples/BodyState", :updateBodyState)
 Vizkit::UiLoader.register_3d_plugin('LaserScanVisualization',"base", 'LaserScanVisualization')
@@ -25,4 +27,8 @@ Vizkit::UiLoader.register_3d_plugin_for('SonarBeamVisualization', "/base/samples
 Vizkit::UiLoader.register_3d_plugin('DepthMapVisualization', "base", 'DepthMapVisualization')
 Vizkit::UiLoader.register_3d_plugin_for('DepthMapVisualization', "/base/samples/DepthMap", :updateDepthMap)
 Vizkit::UiLoader.register_3d_plugin('DistanceImageVisualization', "base", 'DistanceImageVisualization')
-Vizkit::UiLoader.register_3d_plugin_for('DistanceImageVisualization', "/base/samples/DistanceImage", :updateDistanceImage)
\ No newline at end of file
+Vizkit::UiLoader.register_3d_plugin_for('DistanceImageVisualization', "/base/samples/DistanceImage", :updateDistanceImage)
+Vizkit::UiLoader.register_3d_plugin('FrameVisualization', "base", 'FrameVisualization')
+Vizkit::UiLoader.register_3d_plugin_for('FrameVisualization', "/base/samples/frame/Frame", :updateFrame)
+Vizkit::UiLoader.register_3d_plugin('SonarVisualization', "base", 'SonarVisualization')
+Vizkit::UiLoader.register_3d_plugin_for('SonarVisualization', "/base/samples/Sonar", :updateSonar)